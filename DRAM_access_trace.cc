@@ -6,6 +6,8 @@
 #include <stdio.h>
 #include <stddef.h>
 #include "addr_util.h"
+#include "trace_shard.h"
+#include "query_plan.h"
 
 // Generates DRAM query trace in row addressing, begin with a base address.
 // The acces pattern of the following SQL query:
@@ -26,67 +28,15 @@
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenDRAMTrace_1(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
+int GenDRAMTrace_1(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenDRAMTrace_1 is running, Select f3,f4 from table-a where f10 > x .\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_R = "R";
-
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f10_addr = {};
-  Address f3_addr = {};
-
-  // row read f10 first
-  for(int i = 0; i < num_tuples; i++) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of the f3 and f10 elements
-    f3_addr = addr;
-    f10_addr = addr;
-    f3_addr.column += offsetof(IMDBRow, f3) / kCellSize;
-    f10_addr.column += offsetof(IMDBRow, f10) / kCellSize;
-    uint32_t curr_row_addr = ColAddr2RowAddr(GenColAddr(f10_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-    num_traces++;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-    // if f10 match row read f3, f4
-    if(i % 10 < THRESHOLD)
-    {
-      continue;
-    }
-    curr_row_addr = ColAddr2RowAddr(GenColAddr(f3_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-    num_traces++;
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 1);
+  return GenPlanTrace(trace_file_name, plan, kDRAM);
 }
 
 // Generates DRAM query trace in row addressing, begin with a base address.
@@ -108,67 +58,15 @@ int GenDRAMTrace_1(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenDRAMTrace_2(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
+int GenDRAMTrace_2(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenDRAMTrace_2 is running, Select * from table-a where f10 > x .\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
 
-  const char *op_R = "R";
-
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
-
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f10_addr = {};
-  Address f3_addr = {};
-
-  // row read f10 first
-  for(int i = 0; i < num_tuples; i++) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of the f3 and f10 elements
-    f3_addr = addr;
-    f10_addr = addr;
-    f3_addr.column += offsetof(IMDBRow, f3) / kCellSize;
-    f10_addr.column += offsetof(IMDBRow, f10) / kCellSize;
-    uint32_t curr_row_addr = ColAddr2RowAddr(GenColAddr(f10_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-    num_traces++;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-    // if f10 match row read f1, f2, f3, f4
-    if(i % 10 < THRESHOLD)
-    {
-      continue;
-    }
-    curr_row_addr = ColAddr2RowAddr(GenColAddr(f3_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-    num_traces++;
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 2);
+  return GenPlanTrace(trace_file_name, plan, kDRAM);
 }
 
 // Generates DRAM query trace in row addressing, begin with a base address.
@@ -190,77 +88,15 @@ int GenDRAMTrace_2(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenDRAMTrace_3(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
+int GenDRAMTrace_3(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenDRAMTrace_3 is running, update table-a set f3 = xx, f4 = xx where f10 = xx.\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
 
-  const char *op_R = "R";
-  const char *op_W = "W";
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
-
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f10_addr = {};
-  Address f3_addr = {};
-
-  // row read f10 first
-  for(int i = 0; i < num_tuples; i++) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of the f3 and f10 elements
-    f3_addr = addr;
-    f10_addr = addr;
-    f3_addr.column += offsetof(IMDBRow, f3) / kCellSize;
-    f10_addr.column += offsetof(IMDBRow, f10) / kCellSize;
-    uint32_t curr_row_addr = ColAddr2RowAddr(GenColAddr(f10_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-    num_traces++;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-    // if f10 match row read f1, f2, f3, f4
-    if(i % 10 < THRESHOLD)
-    {
-      continue;
-    }
-    curr_row_addr = ColAddr2RowAddr(GenColAddr(f3_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-    num_traces++;
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_W,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_W,
-              curr_row_addr);
-#endif
-    num_traces++;
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 12);
+  return GenPlanTrace(trace_file_name, plan, kDRAM);
 }
 
 
@@ -285,68 +121,15 @@ int GenDRAMTrace_3(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenDRAMTrace_4(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
-
+int GenDRAMTrace_4(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenDRAMTrace_4 is running, Select * from table-a where f10 > x | most of f10 is > x .\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_R = "R";
-
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f10_addr = {};
-  Address f3_addr = {};
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-  // row read f10 first
-  for(int i = 0; i < num_tuples; i++) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of the f3 and f10 elements
-    f3_addr = addr;
-    f10_addr = addr;
-    f3_addr.column += offsetof(IMDBRow, f3) / kCellSize;
-    f10_addr.column += offsetof(IMDBRow, f10) / kCellSize;
-    uint32_t curr_row_addr = ColAddr2RowAddr(GenColAddr(f10_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-    num_traces++;
-
-    // if f10 match row read f1, f2, f3, f4
-    if(i % 10 < THRESHOLD_LOW)
-    {
-      continue;
-    }
-    curr_row_addr = ColAddr2RowAddr(GenColAddr(f3_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-    num_traces++;
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 3);
+  return GenPlanTrace(trace_file_name, plan, kDRAM);
 }
 
 // Generates DRAM query trace in DRAM addressing, begin with a base address.
@@ -369,49 +152,15 @@ int GenDRAMTrace_4(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenDRAMTrace_5(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
+int GenDRAMTrace_5(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenDRAMTrace_5 is running, Select f9 from table-a where f10 > x | most f10 > x.\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_R = "R";
-
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f10_addr = {};
-  Address f3_addr = {};
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-  // row read f10 first
-  for(int i = 0; i < num_tuples; i++) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of the f3 and f10 elements
-    f3_addr = addr;
-    f10_addr = addr;
-    f3_addr.column += offsetof(IMDBRow, f3) / kCellSize;
-    f10_addr.column += offsetof(IMDBRow, f10) / kCellSize;
-    uint32_t curr_row_addr = ColAddr2RowAddr(GenColAddr(f10_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-    num_traces++;
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 5);
+  return GenPlanTrace(trace_file_name, plan, kDRAM);
 }
 
 // Generates DRAM query trace in DRAM addressing, begin with a base address.
@@ -433,65 +182,15 @@ int GenDRAMTrace_5(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenDRAMTrace_6(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
+int GenDRAMTrace_6(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenDRAMTrace_6 is running, update table-a set f3 = xx, f4 = xx where f10 = xx. | few f10 = xx\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_R = "R";
-  const char *op_W = "W";
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
-
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f10_addr = {};
-  Address f3_addr = {};
 
-  // row read f10 first
-  for(int i = 0; i < num_tuples; i++) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of the f3 and f10 elements
-    f3_addr = addr;
-    f10_addr = addr;
-    f3_addr.column += offsetof(IMDBRow, f3) / kCellSize;
-    f10_addr.column += offsetof(IMDBRow, f10) / kCellSize;
-    uint32_t curr_row_addr = ColAddr2RowAddr(GenColAddr(f10_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-    num_traces++;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-    // if f10 match row read f1, f2, f3, f4
-    if(i % 10 < THRESHOLD)
-    {
-      continue;
-    }
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_W,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_W,
-              curr_row_addr);
-#endif
-    num_traces++;
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 13);
+  return GenPlanTrace(trace_file_name, plan, kDRAM);
 }
 
 // Generates DRAM query trace in row addressing, begin with a base address.
@@ -509,221 +208,33 @@ int GenDRAMTrace_6(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 2 | Tuple 6 |  |         |
 //+---------+---------+--+---------+
 //| Tuple 3 | Tuple 7 |  |         |
-//+---------+---------+--+---------+
-//| Tuple 4 | Tuple 8 |  | Tuple N |
-//+---------+---------+--+---------+
-// Assume Tuple 1 is in Column 0
-int GenDRAMTrace_7(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr_a, uint32_t base_col_addr_b) {
-  printf("GenDRAMTrace_7 is running, Select table-a.f3, table-b.f4 from table-a, table-b where table-a.f1 > table-b.f1 and table-a.f9 = table-b.f9.\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_R = "R";
-
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
-
-  printf("Base column address for table-a: 0x%08x\n", base_col_addr_a);
-  printf("Base column address for table-b: 0x%08x\n", base_col_addr_b);
-
-  // row read table-a.f1 and table-a.f9
-  for(int i = 0; i < num_tuples; i++) {
-    Address addr = {};
-    Address f1_addr = {};
-    Address f9_addr = {};
-    uint32_t curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr_a);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of f1 and f9
-    f1_addr = addr;
-    f9_addr = addr;
-    f1_addr.column += offsetof(IMDBRow, f1) / kCellSize;
-    f9_addr.column += offsetof(IMDBRow, f9) / kCellSize;
-    uint32_t curr_row_addr_f1 = ColAddr2RowAddr(GenColAddr(f1_addr));
-    uint32_t curr_row_addr_f9 = ColAddr2RowAddr(GenColAddr(f9_addr));
-    curr_row_addr_f1 = GetCacheLineAddr(curr_row_addr_f1);
-    curr_row_addr_f9 = GetCacheLineAddr(curr_row_addr_f9);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr_f1, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_R,
-              curr_row_addr_f1, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-        ParseRowAddr(curr_row_addr_f9, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_R,
-              curr_row_addr_f9, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_R,
-              curr_row_addr_f1);
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_R,
-              curr_row_addr_f9);
-#endif
-  }
-  // row read table-a.f1 and table-b.f9
-  for(int i = 0; i < num_tuples; i++) {
-    Address addr = {};
-    Address f1_addr = {};
-    Address f9_addr = {};
-    uint32_t curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr_b);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of f1 and f9
-    f1_addr = addr;
-    f9_addr = addr;
-    f1_addr.column += offsetof(IMDBRow, f1) / kCellSize;
-    f9_addr.column += offsetof(IMDBRow, f9) / kCellSize;
-    uint32_t curr_row_addr_f1 = ColAddr2RowAddr(GenColAddr(f1_addr));
-    uint32_t curr_row_addr_f9 = ColAddr2RowAddr(GenColAddr(f9_addr));
-    curr_row_addr_f1 = GetCacheLineAddr(curr_row_addr_f1);
-    curr_row_addr_f9 = GetCacheLineAddr(curr_row_addr_f9);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr_f1, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_R,
-              curr_row_addr_f1, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-        ParseRowAddr(curr_row_addr_f9, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_R,
-              curr_row_addr_f9, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_R,
-              curr_row_addr_f1);
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_R,
-              curr_row_addr_f9);
-#endif
-  }
-
-  // row read table-a.f3 & table-b.f4
-  // They have been accessed with f1
-
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
-}
-
-// Generates DRAM query trace in row addressing, begin with a base address.
-// The acces pattern of the following SQL query:
-// Select table-a.f3, table-b.f4 from table-a, table-b where table-a.f9 = table-b.f9 
-// 
-// The base_addr means the address of the first element in the left-upper corner
-// of the IMDB in the form of column addressing.
-
-// Layout 2:
-// Fill as many tuples as possible in a row
-//+=========+=========+==+=========+
-//| Tuple 1 | Tuple 5 |  |         |
-//+---------+---------+--+---------+
-//| Tuple 2 | Tuple 6 |  |         |
-//+---------+---------+--+---------+
-//| Tuple 3 | Tuple 7 |  |         |
-//+---------+---------+--+---------+
-//| Tuple 4 | Tuple 8 |  | Tuple N |
-//+---------+---------+--+---------+
-// Assume Tuple 1 is in Column 0
-int GenDRAMTrace_8(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr_a, uint32_t base_col_addr_b) {
-  printf("GenDRAMTrace_8 is running, Select table-a.f3, table-b.f4 from table-a, table-b where table-a.f9 = table-b.f9.\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_R = "R";
-
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
-
-  printf("Base column address for table-a: 0x%08x\n", base_col_addr_a);
-  printf("Base column address for table-b: 0x%08x\n", base_col_addr_b);
-
-  // row read table-a.f9
-  for(int i = 0; i < num_tuples; i++) {
-    Address addr = {};
-    Address f9_addr = {};
-    uint32_t curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr_a);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of f9
-    f9_addr = addr;
-    f9_addr.column += offsetof(IMDBRow, f9) / kCellSize;
-    uint32_t curr_row_addr = ColAddr2RowAddr(GenColAddr(f9_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_R,
-              curr_row_addr);
-#endif
-  }
-  // row read table-b.f9
-  for(int i = 0; i < num_tuples; i++) {
-    Address addr = {};
-    Address f9_addr = {};
-    uint32_t curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr_b);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of f9
-    f9_addr = addr;
-    f9_addr.column += offsetof(IMDBRow, f9) / kCellSize;
-    uint32_t curr_row_addr = ColAddr2RowAddr(GenColAddr(f9_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_R,
-              curr_row_addr);
-#endif
-  }
+//+---------+---------+--+---------+
+//| Tuple 4 | Tuple 8 |  | Tuple N |
+//+---------+---------+--+---------+
+// Assume Tuple 1 is in Column 0
+int GenDRAMTrace_7(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr_a, uint64_t base_col_addr_b) {
+  printf("GenDRAMTrace_7 is running, Select table-a.f3, table-b.f4 from table-a, table-b where table-a.f1 > table-b.f1 and table-a.f9 = table-b.f9.\n");
 
-  // row read table-a.f3 & table-b.f4
-  for(int i = 0; i < num_tuples; i++) {
-    // if table-a.f9 = table-b.f9 row read f3 & f4
-    if(i % 10 < THRESHOLD)
-    {
-      continue;
-    }
-    // Calculate the column address of f3 & f4
-    // f3 & f4 belong to the first cache line in each tuple
-    Address f_addr = {};
-    uint32_t curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr_a);
-    ParseColAddr(curr_col_addr, f_addr);
-    uint32_t curr_row_addr = ColAddr2RowAddr(GenColAddr(f_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_R,
-              curr_row_addr);
-#endif
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr_b);
-    ParseColAddr(curr_col_addr, f_addr);
-    curr_row_addr = ColAddr2RowAddr(GenColAddr(f_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_R,
-              curr_row_addr);
-#endif
+  printf("Base column address for table-a: 0x%08llx\n",
+         (unsigned long long)base_col_addr_a);
+  printf("Base column address for table-b: 0x%08llx\n",
+         (unsigned long long)base_col_addr_b);
+  if (GetJoinMethod().kind != kJoinByTuple) {
+    printf("Base column address for the %s: 0x%08llx\n",
+           GetJoinMethod().kind == kJoinHash ? "hash table" : "sorted runs",
+           (unsigned long long)kOLXPJoinAddr);
   }
 
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr_a);
+  AddPlanTable(&plan, base_col_addr_b);
+  AddOLXPQuery(&plan, 8);
+  return GenPlanTrace(trace_file_name, plan, kDRAM);
 }
 
 // Generates DRAM query trace in row addressing, begin with a base address.
 // The acces pattern of the following SQL query:
-// Select f3,f4 from table-a where f1 > x and f9 < y
+// Select table-a.f3, table-b.f4 from table-a, table-b where table-a.f9 = table-b.f9 
 // 
 // The base_addr means the address of the first element in the left-upper corner
 // of the IMDB in the form of column addressing.
@@ -740,66 +251,54 @@ int GenDRAMTrace_8(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenDRAMTrace_9(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
-  printf("GenDRAMTrace_9 is running, Select f3,f4 from table-a where f1 > x and f9 < y.\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
+int GenDRAMTrace_8(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr_a, uint64_t base_col_addr_b) {
+  printf("GenDRAMTrace_8 is running, Select table-a.f3, table-b.f4 from table-a, table-b where table-a.f9 = table-b.f9.\n");
 
-  const char *op_R = "R";
+  printf("Base column address for table-a: 0x%08llx\n",
+         (unsigned long long)base_col_addr_a);
+  printf("Base column address for table-b: 0x%08llx\n",
+         (unsigned long long)base_col_addr_b);
+  if (GetJoinMethod().kind != kJoinByTuple) {
+    printf("Base column address for the %s: 0x%08llx\n",
+           GetJoinMethod().kind == kJoinHash ? "hash table" : "sorted runs",
+           (unsigned long long)kOLXPJoinAddr);
+  }
 
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr_a);
+  AddPlanTable(&plan, base_col_addr_b);
+  AddOLXPQuery(&plan, 9);
+  return GenPlanTrace(trace_file_name, plan, kDRAM);
+}
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f1_addr = {};
-  Address f9_addr = {};
+// Generates DRAM query trace in row addressing, begin with a base address.
+// The acces pattern of the following SQL query:
+// Select f3,f4 from table-a where f1 > x and f9 < y
+// 
+// The base_addr means the address of the first element in the left-upper corner
+// of the IMDB in the form of column addressing.
 
-  // row read f1, f9 first
-  for(int i = 0; i < num_tuples; i++) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of the f1 and f9 elements
-    f1_addr = addr;
-    f9_addr = addr;
-    f1_addr.column += offsetof(IMDBRow, f1) / kCellSize;
-    f9_addr.column += offsetof(IMDBRow, f9) / kCellSize;
-    uint32_t curr_row_addr = ColAddr2RowAddr(GenColAddr(f1_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-    num_traces++;
+// Layout 2:
+// Fill as many tuples as possible in a row
+//+=========+=========+==+=========+
+//| Tuple 1 | Tuple 5 |  |         |
+//+---------+---------+--+---------+
+//| Tuple 2 | Tuple 6 |  |         |
+//+---------+---------+--+---------+
+//| Tuple 3 | Tuple 7 |  |         |
+//+---------+---------+--+---------+
+//| Tuple 4 | Tuple 8 |  | Tuple N |
+//+---------+---------+--+---------+
+// Assume Tuple 1 is in Column 0
+int GenDRAMTrace_9(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
+  printf("GenDRAMTrace_9 is running, Select f3,f4 from table-a where f1 > x and f9 < y.\n");
 
-    curr_row_addr = ColAddr2RowAddr(GenColAddr(f9_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-    num_traces++;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-    // if f1 and f9 match then row read f3, f4
-    // but f3 & f4 are in the same cache line with f1
-    // so there is nothing to do here
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 10);
+  return GenPlanTrace(trace_file_name, plan, kDRAM);
 }
 
 
@@ -823,50 +322,15 @@ int GenDRAMTrace_9(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenDRAMTrace_10(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
+int GenDRAMTrace_10(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenDRAMTrace_10 is running, Select f3,f4 from table-a where f1 > x and f2 < y.\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_R = "R";
-
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
-
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f1_addr = {};
 
-  // row read f1, f2 first
-  for(int i = 0; i < num_tuples; i++) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of f1
-    f1_addr = addr;
-    f1_addr.column += offsetof(IMDBRow, f1) / kCellSize;
-    uint32_t curr_row_addr = ColAddr2RowAddr(GenColAddr(f1_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-    num_traces++;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-    // if f1 and f2 match then row read f3, f4
-    // but f3 & f4 are in the same cache line with f1 & f2
-    // so there is nothing to do here
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 11);
+  return GenPlanTrace(trace_file_name, plan, kDRAM);
 }
 
 // Generates hybrid query trace in hybrid addressing, begin with a base address.
@@ -888,27 +352,27 @@ int GenDRAMTrace_10(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenDRAMTrace_11(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr, int L3_size) {
+int GenDRAMTrace_11(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr, int L3_size) {
 
   printf("GenDRAMTrace_11 is running, Select f3,f4 from table-a where f10 > x . | use L3 cache to speed up\n");
   // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
+  TraceWriter *fp = OpenTraceWriter(trace_file_name);
   if (fp == NULL) return kFailure;
 
   const char *op_R = "R";
 
   //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
+  int64_t num_traces = 0;
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
+  uint64_t curr_col_addr = base_col_addr;
   Address addr = {};
   Address f10_addr = {};
   Address f3_addr = {};
 
   // row read f10 first
-  for(int i = 0; i < num_tuples; i++) {
+  for(int64_t i = 0; i < num_tuples; i++) {
     curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
     ParseColAddr(curr_col_addr, addr);
     // Calculate the column address of the f3 and f10 elements
@@ -916,7 +380,7 @@ int GenDRAMTrace_11(const char* trace_file_name, int num_tuples, int tuple_size,
     f10_addr = addr;
     f3_addr.column += offsetof(IMDBRow, f3) / kCellSize;
     f10_addr.column += offsetof(IMDBRow, f10) / kCellSize;
-    uint32_t curr_row_addr = ColAddr2RowAddr(GenColAddr(f10_addr));
+    uint64_t curr_row_addr = ColAddr2RowAddr(GenColAddr(f10_addr));
     curr_row_addr = GetCacheLineAddr(curr_row_addr);
 #ifdef DEBUG
         ParseRowAddr(curr_row_addr, addr);
@@ -924,7 +388,7 @@ int GenDRAMTrace_11(const char* trace_file_name, int num_tuples, int tuple_size,
               curr_row_addr, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
+        cprintf(fp, num_traces, op_R,
               curr_row_addr);
 #endif
     num_traces++;
@@ -942,14 +406,13 @@ int GenDRAMTrace_11(const char* trace_file_name, int num_tuples, int tuple_size,
               curr_row_addr, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
+        cprintf(fp, num_traces, op_R,
               curr_row_addr);
 #endif
     num_traces++;
   }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  printf("Total number of traces: %lld\n", (long long)num_traces);
+  return CloseTraceWriter(fp);
 }
 
 // Generates DRAM query trace in DRAM addressing, begin with a base address.
@@ -983,14 +446,14 @@ int GenDRAMTrace_12(const char* trace_file_name, int num_query, int r_ratio, int
   }
 
   // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
+  TraceWriter *fp = OpenTraceWriter(trace_file_name);
   if (fp == NULL){
     fclose(data);
     return kFailure;
   }
 
   int op, pos;
-  int num_traces = 0;
+  int64_t num_traces = 0;
   int stride =  kCachelineSize / kCellSize;
 
   while (fscanf(data, "%d %d", &op, &pos) > 0){
@@ -1005,7 +468,7 @@ int GenDRAMTrace_12(const char* trace_file_name, int num_query, int r_ratio, int
               pos, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-      	cprintf(fp, "%d %s 0x%08x 0 0\n", ++num_traces, "R", pos);
+      	cprintf(fp, ++num_traces, "R", pos);
 #endif
         break;
       case 1:
@@ -1016,13 +479,13 @@ int GenDRAMTrace_12(const char* trace_file_name, int num_query, int r_ratio, int
               pos, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-      	cprintf(fp, "%d %s 0x%08x 0 0\n", ++num_traces, "W", pos);
+      	cprintf(fp, ++num_traces, "W", pos);
 #endif
         break;
       case 2:
         for (int i = 0; i < stride; i ++){
-    	  uint32_t temp_col = pos + i * kCellSize;
-    	  uint32_t curr_row_addr = ColAddr2RowAddr(temp_col);
+    	  uint64_t temp_col = pos + i * kCellSize;
+    	  uint64_t curr_row_addr = ColAddr2RowAddr(temp_col);
 	  curr_row_addr = GetCacheLineAddr(curr_row_addr);
 #ifdef DEBUG
       	  ParseRowAddr(curr_row_addr, addr);
@@ -1030,14 +493,14 @@ int GenDRAMTrace_12(const char* trace_file_name, int num_query, int r_ratio, int
                 curr_row_addr, addr.highrow, addr.bank,
                 addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-          cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, "R", curr_row_addr);
+          cprintf(fp, num_traces++, "R", curr_row_addr);
 #endif
         }
         break;
       case 3:
         for (int i = 0; i < stride; i ++){
-    	  uint32_t temp_col = pos + i * kCellSize;
-    	  uint32_t curr_row_addr = ColAddr2RowAddr(temp_col);
+    	  uint64_t temp_col = pos + i * kCellSize;
+    	  uint64_t curr_row_addr = ColAddr2RowAddr(temp_col);
 	  curr_row_addr = GetCacheLineAddr(curr_row_addr);
 #ifdef DEBUG
       	  ParseRowAddr(curr_row_addr, addr);
@@ -1045,17 +508,16 @@ int GenDRAMTrace_12(const char* trace_file_name, int num_query, int r_ratio, int
                 curr_row_addr, addr.highrow, addr.bank,
                 addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-          cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, "W", curr_row_addr);
+          cprintf(fp, num_traces++, "W", curr_row_addr);
 #endif
         }
         break;
     } 
   }
-  printf("Total number of traces: %d\n", num_traces);
+  printf("Total number of traces: %lld\n", (long long)num_traces);
 
   fclose(data);
-  fclose(fp);
-  return kSuccess;
+  return CloseTraceWriter(fp);
 }
 
 // Generates hybrid query trace in hybrid addressing, begin with a base address.
@@ -1078,48 +540,18 @@ int GenDRAMTrace_12(const char* trace_file_name, int num_query, int r_ratio, int
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenDRAMTrace_13(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr, int prefetch_size) {
+int GenDRAMTrace_13(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr, int prefetch_size) {
   printf("GenDRAMTrace_13 is running, Select f3,f4 from table-a where f1 > x and f9 < y.\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_R = "R";
 
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f3_addr = {};
-  int column_num = (offsetof(IMDBOverCLRow, f4) - offsetof(IMDBOverCLRow, f3)) / kCellSize;
-
-  // row read f3
-  for(int i = 0; i < num_tuples; i++) {
-    for (int j = 0; j < column_num; j += kCachelineSize){
-      curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-      ParseColAddr(curr_col_addr, addr);
-      // Calculate the column address of f3
-      f3_addr = addr;
-      f3_addr.column += offsetof(IMDBRow, f3) / kCellSize + j;
-      uint32_t curr_row_addr = ColAddr2RowAddr(GenColAddr(f3_addr));
-      curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-      ParseRowAddr(curr_row_addr, addr);
-      dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_R,
-            curr_row_addr, addr.highrow, addr.bank,
-            addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-      cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_R,
-            curr_row_addr);
-#endif
-    }
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  plan.prefetch_size = prefetch_size;
+  // The wide f3 is walked in steps of kCachelineSize cells, which reads only
+  // the row cache line of its first cell; keep that access
+  PlanScan(&plan, 0, {PlanField{(int)(offsetof(IMDBRow, f3) / kCellSize), 1}});
+  return GenPlanTrace(trace_file_name, plan, kDRAM);
 }
 
 // Generates DRAM query trace in DRAM addressing, begin with a base address.
@@ -1142,54 +574,16 @@ int GenDRAMTrace_13(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenDRAMTrace_14(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr, int prefetch_size) {
+int GenDRAMTrace_14(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr, int prefetch_size) {
   printf("GenDRAMTrace_14 is running, Select f3, f6, f10 from table-a.\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_R = "R";
-
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
-
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
 
-  for(int i = 0; i < num_tuples; i++) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of the f3 and f10 elements
-    uint32_t curr_row_addr = ColAddr2RowAddr(curr_col_addr);
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-    num_traces++;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-    curr_row_addr += kCachelineSize;
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-    num_traces++;
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  plan.prefetch_size = prefetch_size;
+  AddOLXPQuery(&plan, 15);
+  return GenPlanTrace(trace_file_name, plan, kDRAM);
 }
 
 // Generates DRAM query trace in DRAM addressing, begin with a base address.
@@ -1213,27 +607,27 @@ int GenDRAMTrace_14(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenDRAMTrace_15(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr, int prefetch_size) {
+int GenDRAMTrace_15(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr, int prefetch_size) {
   printf("GenDRAMTrace_15 is running, Select f1,f9 from table-a, f9 is a 64B wide col\n");
   // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
+  TraceWriter *fp = OpenTraceWriter(trace_file_name);
   if (fp == NULL) return kFailure;
 
   const char *op_R = "R";
 
   //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
+  int64_t num_traces = 0;
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
+  uint64_t curr_col_addr = base_col_addr;
   Address addr = {};
 
-  for(int i = 0; i < num_tuples; i++) {
+  for(int64_t i = 0; i < num_tuples; i++) {
     curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
     ParseColAddr(curr_col_addr, addr);
     // Calculate the column address of the f3 and f10 elements
-    uint32_t curr_row_addr = ColAddr2RowAddr(curr_col_addr);
+    uint64_t curr_row_addr = ColAddr2RowAddr(curr_col_addr);
     curr_row_addr = GetCacheLineAddr(curr_row_addr);
 #ifdef DEBUG
         ParseRowAddr(curr_row_addr, addr);
@@ -1241,7 +635,7 @@ int GenDRAMTrace_15(const char* trace_file_name, int num_tuples, int tuple_size,
               curr_row_addr, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
+        cprintf(fp, num_traces, op_R,
               curr_row_addr);
 #endif
     num_traces++;
@@ -1253,14 +647,13 @@ int GenDRAMTrace_15(const char* trace_file_name, int num_tuples, int tuple_size,
               curr_row_addr, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
+        cprintf(fp, num_traces, op_R,
               curr_row_addr);
 #endif
     num_traces++;
   }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  printf("Total number of traces: %lld\n", (long long)num_traces);
+  return CloseTraceWriter(fp);
 }
 
 // Generates DRAM query trace in DRAM addressing, begin with a base address.
@@ -1282,33 +675,33 @@ int GenDRAMTrace_15(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenDRAMTrace_16(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr, int prefetch_size) {
+int GenDRAMTrace_16(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr, int prefetch_size) {
   printf("GenDRAMTrace_16 is running, Select f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16  from table-a where f19 > x.\n");
   // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
+  TraceWriter *fp = OpenTraceWriter(trace_file_name);
   if (fp == NULL) return kFailure;
 
   const char *op_R = "R";
 
   //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
+  int64_t num_traces = 0;
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
+  uint64_t curr_col_addr = base_col_addr;
   Address addr = {};
   Address f10_addr = {};
   Address f1_addr = {};
   Address f17_addr = {};
 
   // row read f10 first
-  for(int i = 0; i < num_tuples; i++) {
+  for(int64_t i = 0; i < num_tuples; i++) {
     curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
     ParseColAddr(curr_col_addr, addr);
     // Calculate the column address of the f3 and f10 elements
     f10_addr.column += offsetof(IMDB_Large, f10) / kCellSize;
     f17_addr.column += offsetof(IMDB_Large, f17) / kCellSize;
-    uint32_t curr_row_addr = ColAddr2RowAddr(GenColAddr(f17_addr));
+    uint64_t curr_row_addr = ColAddr2RowAddr(GenColAddr(f17_addr));
     curr_row_addr = GetCacheLineAddr(curr_row_addr);
 #ifdef DEBUG
         ParseRowAddr(curr_row_addr, addr);
@@ -1316,7 +709,7 @@ int GenDRAMTrace_16(const char* trace_file_name, int num_tuples, int tuple_size,
               curr_row_addr, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
+        cprintf(fp, num_traces, op_R,
               curr_row_addr);
 #endif
     num_traces++;
@@ -1334,7 +727,7 @@ int GenDRAMTrace_16(const char* trace_file_name, int num_tuples, int tuple_size,
               curr_row_addr, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
+        cprintf(fp, num_traces, op_R,
               curr_row_addr);
 #endif
     num_traces++;
@@ -1346,14 +739,13 @@ int GenDRAMTrace_16(const char* trace_file_name, int num_tuples, int tuple_size,
               curr_row_addr, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
+        cprintf(fp, num_traces, op_R,
               curr_row_addr);
 #endif
     num_traces++;
   }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  printf("Total number of traces: %lld\n", (long long)num_traces);
+  return CloseTraceWriter(fp);
 }
 
 // Generates DRAM query trace in DRAM addressing, begin with a base address.
@@ -1376,32 +768,32 @@ int GenDRAMTrace_16(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenDRAMTrace_17(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr, int prefetch_size) {
+int GenDRAMTrace_17(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr, int prefetch_size) {
   printf("GenDRAMTrace_17 is running, Select * from table-a where f19 > x\n");
-  FILE *fp = fopen(trace_file_name, "w");
+  TraceWriter *fp = OpenTraceWriter(trace_file_name);
   if (fp == NULL) return kFailure;
 
   const char *op_R = "R";
 
   //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
+  int64_t num_traces = 0;
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
+  uint64_t curr_col_addr = base_col_addr;
   Address addr = {};
   Address f19_addr = {};
   Address f1_addr = {};
   Address f17_addr = {};
 
   // row read f10 first
-  for(int i = 0; i < num_tuples; i++) {
+  for(int64_t i = 0; i < num_tuples; i++) {
     curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
     ParseColAddr(curr_col_addr, addr);
     // Calculate the column address of the f3 and f10 elements
     f19_addr.column += offsetof(IMDB_Large, f19) / kCellSize;
     f17_addr.column += offsetof(IMDB_Large, f17) / kCellSize;
-    uint32_t curr_row_addr = ColAddr2RowAddr(GenColAddr(f19_addr));
+    uint64_t curr_row_addr = ColAddr2RowAddr(GenColAddr(f19_addr));
     curr_row_addr = GetCacheLineAddr(curr_row_addr);
 #ifdef DEBUG
         ParseRowAddr(curr_row_addr, addr);
@@ -1409,7 +801,7 @@ int GenDRAMTrace_17(const char* trace_file_name, int num_tuples, int tuple_size,
               curr_row_addr, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
+        cprintf(fp, num_traces, op_R,
               curr_row_addr);
 #endif
     num_traces++;
@@ -1434,16 +826,15 @@ int GenDRAMTrace_17(const char* trace_file_name, int num_tuples, int tuple_size,
               curr_row_addr, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
+        cprintf(fp, num_traces, op_R,
               curr_row_addr);
 #endif
     num_traces++;
 	curr_row_addr += kCachelineSize;
 	}  
   }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  printf("Total number of traces: %lld\n", (long long)num_traces);
+  return CloseTraceWriter(fp);
 }
 
 // Generates DRAM query trace in DRAM addressing, begin with a base address.
@@ -1466,26 +857,26 @@ int GenDRAMTrace_17(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenDRAMTrace_18(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr, int prefetch_size) {
+int GenDRAMTrace_18(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr, int prefetch_size) {
   printf("GenDRAMTrace_18 is running, Select f1,f9,f19,f29  from table-a.\n");
   // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
+  TraceWriter *fp = OpenTraceWriter(trace_file_name);
   if (fp == NULL) return kFailure;
 
   const char *op_R = "R";
 
   //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
+  int64_t num_traces = 0;
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
+  uint64_t curr_col_addr = base_col_addr;
   Address addr = {};
   
-  for(int i = 0; i < num_tuples; i++) {
+  for(int64_t i = 0; i < num_tuples; i++) {
     curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
     ParseColAddr(curr_col_addr, addr);
-    uint32_t curr_row_addr = ColAddr2RowAddr(GenColAddr(addr));
+    uint64_t curr_row_addr = ColAddr2RowAddr(GenColAddr(addr));
     curr_row_addr = GetCacheLineAddr(curr_row_addr);
     for(int k = 0; k < 4; k++)
     {
@@ -1495,16 +886,15 @@ int GenDRAMTrace_18(const char* trace_file_name, int num_tuples, int tuple_size,
               curr_row_addr, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
+        cprintf(fp, num_traces, op_R,
               curr_row_addr);
 #endif
     num_traces++;
   	curr_row_addr += kCachelineSize;	
     }
   }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  printf("Total number of traces: %lld\n", (long long)num_traces);
+  return CloseTraceWriter(fp);
 }
 
 // Generates DRAM query trace in DRAM addressing, begin with a base address.
@@ -1527,26 +917,26 @@ int GenDRAMTrace_18(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenDRAMTrace_19(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr, int prefetch_size) {
+int GenDRAMTrace_19(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr, int prefetch_size) {
   printf("GenDRAMTrace_19 is running, Select f1,f9,f19,f29,f39  from table-a.\n");
   // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
+  TraceWriter *fp = OpenTraceWriter(trace_file_name);
   if (fp == NULL) return kFailure;
 
   const char *op_R = "R";
 
   //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
+  int64_t num_traces = 0;
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
+  uint64_t curr_col_addr = base_col_addr;
   Address addr = {};
   
-  for(int i = 0; i < num_tuples; i++) {
+  for(int64_t i = 0; i < num_tuples; i++) {
     curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
     ParseColAddr(curr_col_addr, addr);
-    uint32_t curr_row_addr = ColAddr2RowAddr(GenColAddr(addr));
+    uint64_t curr_row_addr = ColAddr2RowAddr(GenColAddr(addr));
     curr_row_addr = GetCacheLineAddr(curr_row_addr);
     for(int k = 0; k < 5; k++)
     {
@@ -1556,16 +946,15 @@ int GenDRAMTrace_19(const char* trace_file_name, int num_tuples, int tuple_size,
               curr_row_addr, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
+        cprintf(fp, num_traces, op_R,
               curr_row_addr);
 #endif
     num_traces++;
   	curr_row_addr += kCachelineSize;	
     }
   }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  printf("Total number of traces: %lld\n", (long long)num_traces);
+  return CloseTraceWriter(fp);
 }
 
 
@@ -1587,36 +976,36 @@ int GenDRAMTrace_19(const char* trace_file_name, int num_tuples, int tuple_size,
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
 // mix of col read and row read
-int GenDRAMTrace_20(const char* trace_file_name, int num_tuples, int tuple_size,
-		  uint32_t base_col_addr, int row_rate, int col_rate) {
+int GenDRAMTrace_20(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+		  uint64_t base_col_addr, int row_rate, int col_rate) {
   printf("GenDRAMTrace_20 is running, Mix col read with row read Row Select f1 from table a, Col Select f10 from table a. The rate is Row:Col =  %d : %d.\n",row_rate,col_rate);
 
-  FILE *fp = fopen(trace_file_name, "w");
+  TraceWriter *fp = OpenTraceWriter(trace_file_name);
   if (fp == NULL) return kFailure;
 
   const char *op_R = "R";
 
   //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
+  int64_t num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  uint32_t curr_col_addr2 = base_col_addr;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
+  uint64_t curr_col_addr = base_col_addr;
+  uint64_t curr_col_addr2 = base_col_addr;
 
   int row_tuple_count = 0;
   int col_tuple_count = 0;
   // col read f10 first
 
-  for(int i = 0; i < num_tuples; i ++) {
+  for(int64_t i = 0; i < num_tuples; i ++) {
    if((i % (row_rate + col_rate)) < col_rate)
 {
 	for(int k = 0; k < kCachelineSize / kCellSize; k++)
 	{
     curr_col_addr = CalTupleColAddrLayout2(col_tuple_count++, tuple_size, base_col_addr);
-    uint32_t curr_row_addr = ColAddr2RowAddr(curr_col_addr);
+    uint64_t curr_row_addr = ColAddr2RowAddr(curr_col_addr);
     curr_row_addr = GetCacheLineAddr(curr_row_addr);
     curr_row_addr += kCachelineSize;	
 #ifdef DEBUG
@@ -1625,7 +1014,7 @@ int GenDRAMTrace_20(const char* trace_file_name, int num_tuples, int tuple_size,
               curr_row_addr, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-      	cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
+      	cprintf(fp, num_traces, op_R,
               curr_row_addr);
 #endif
       	++num_traces;
@@ -1634,7 +1023,7 @@ int GenDRAMTrace_20(const char* trace_file_name, int num_tuples, int tuple_size,
 else
 {	// for each line in of the data in this cacheline, compare f10 first, if success, then row_read the f3,f4
 	curr_col_addr2 = CalTupleColAddrLayout2(row_tuple_count++, tuple_size, base_col_addr);
-    	uint32_t curr_row_addr2 = ColAddr2RowAddr(curr_col_addr2);
+    	uint64_t curr_row_addr2 = ColAddr2RowAddr(curr_col_addr2);
 	curr_row_addr2 = GetCacheLineAddr(curr_row_addr2);
 	
 #ifdef DEBUG
@@ -1643,15 +1032,14 @@ else
               curr_row_addr2, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-      	cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
+      	cprintf(fp, num_traces, op_R,
               curr_row_addr2);
 #endif
       	++num_traces;
 	}
 } 
-printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+printf("Total number of traces: %lld\n", (long long)num_traces);
+  return CloseTraceWriter(fp);
 }
 
 // Generates DRAM query trace in hybrid addressing, begin with a base address.
@@ -1672,36 +1060,36 @@ printf("Total number of traces: %d\n", num_traces);
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
 // mix of col read and row read
-int GenDRAMTrace_21(const char* trace_file_name, int num_tuples, int tuple_size,
-		  uint32_t base_col_addr, int row_rate, int col_rate) {
+int GenDRAMTrace_21(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+		  uint64_t base_col_addr, int row_rate, int col_rate) {
   printf("GenDRAMTrace_21 is running, Mix col read with row read Row Set f1 from table a, Col Set f10 from table a. The rate is Row:Col =  %d : %d.\n",row_rate,col_rate);
 
-  FILE *fp = fopen(trace_file_name, "w");
+  TraceWriter *fp = OpenTraceWriter(trace_file_name);
   if (fp == NULL) return kFailure;
 
   const char *op_R = "W";
 
   //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
+  int64_t num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  uint32_t curr_col_addr2 = base_col_addr;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
+  uint64_t curr_col_addr = base_col_addr;
+  uint64_t curr_col_addr2 = base_col_addr;
 
   int row_tuple_count = 0;
   int col_tuple_count = 0;
   // col read f10 first
 
-  for(int i = 0; i < num_tuples; i ++) {
+  for(int64_t i = 0; i < num_tuples; i ++) {
    if((i % (row_rate + col_rate)) < col_rate)
 {
 	for(int k = 0; k < kCachelineSize / kCellSize; k++)
 	{
     curr_col_addr = CalTupleColAddrLayout2(col_tuple_count++, tuple_size, base_col_addr);
-    uint32_t curr_row_addr = ColAddr2RowAddr(curr_col_addr);
+    uint64_t curr_row_addr = ColAddr2RowAddr(curr_col_addr);
     curr_row_addr = GetCacheLineAddr(curr_row_addr);
     curr_row_addr += kCachelineSize;	
 #ifdef DEBUG
@@ -1710,7 +1098,7 @@ int GenDRAMTrace_21(const char* trace_file_name, int num_tuples, int tuple_size,
               curr_row_addr, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-      	cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
+      	cprintf(fp, num_traces, op_R,
               curr_row_addr);
 #endif
       	++num_traces;
@@ -1719,7 +1107,7 @@ int GenDRAMTrace_21(const char* trace_file_name, int num_tuples, int tuple_size,
 else
 {	// for each line in of the data in this cacheline, compare f10 first, if success, then row_read the f3,f4
 	curr_col_addr2 = CalTupleColAddrLayout2(row_tuple_count++, tuple_size, base_col_addr);
-    	uint32_t curr_row_addr2 = ColAddr2RowAddr(curr_col_addr2);
+    	uint64_t curr_row_addr2 = ColAddr2RowAddr(curr_col_addr2);
 	curr_row_addr2 = GetCacheLineAddr(curr_row_addr2);
 	
 #ifdef DEBUG
@@ -1728,15 +1116,14 @@ else
               curr_row_addr2, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-      	cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
+      	cprintf(fp, num_traces, op_R,
               curr_row_addr2);
 #endif
       	++num_traces;
 	}
 } 
-printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+printf("Total number of traces: %lld\n", (long long)num_traces);
+  return CloseTraceWriter(fp);
 }
 
 // Generates DRAM query trace in DRAM addressing, begin with a base address.
@@ -1759,49 +1146,15 @@ printf("Total number of traces: %d\n", num_traces);
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenDRAMTrace_22(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
+int GenDRAMTrace_22(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenDRAMTrace_22 is running, Select f9 from table-a where f10 > x | few f10 > x.\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_R = "R";
-
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f10_addr = {};
-  Address f3_addr = {};
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-  // row read f10 first
-  for(int i = 0; i < num_tuples; i++) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of the f3 and f10 elements
-    f3_addr = addr;
-    f10_addr = addr;
-    f3_addr.column += offsetof(IMDBRow, f3) / kCellSize;
-    f10_addr.column += offsetof(IMDBRow, f10) / kCellSize;
-    uint32_t curr_row_addr = ColAddr2RowAddr(GenColAddr(f10_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-    num_traces++;
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 4);
+  return GenPlanTrace(trace_file_name, plan, kDRAM);
 }
 
 
@@ -1824,67 +1177,15 @@ int GenDRAMTrace_22(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenDRAMTrace_23(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
+int GenDRAMTrace_23(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenDRAMTrace_23 is running, Select AVG(f1) from table-a where f10 > x .\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_R = "R";
-
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
-
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f10_addr = {};
-  Address f1_addr = {};
 
-  // row read f10 first
-  for(int i = 0; i < num_tuples; i++) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of the f1 and f10 elements
-    f1_addr = addr;
-    f10_addr = addr;
-    f1_addr.column += offsetof(IMDBRow, f1) / kCellSize;
-    f10_addr.column += offsetof(IMDBRow, f10) / kCellSize;
-    uint32_t curr_row_addr = ColAddr2RowAddr(GenColAddr(f10_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-    num_traces++;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-    // if f10 match row read f1
-    if(i % 10 < THRESHOLD)
-    {
-      continue;
-    }
-    curr_row_addr = ColAddr2RowAddr(GenColAddr(f1_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-    num_traces++;
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 6);
+  return GenPlanTrace(trace_file_name, plan, kDRAM);
 }
 
 
@@ -1908,67 +1209,30 @@ int GenDRAMTrace_23(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenDRAMTrace_24(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
-
+int GenDRAMTrace_24(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenDRAMTrace_24 is running, Select AVG(f1) from table-a where f10 > x | most of f10 is > x .\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_R = "R";
-
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f10_addr = {};
-  Address f1_addr = {};
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-  // row read f10 first
-  for(int i = 0; i < num_tuples; i++) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of the f1 and f10 elements
-    f1_addr = addr;
-    f10_addr = addr;
-    f1_addr.column += offsetof(IMDBRow, f1) / kCellSize;
-    f10_addr.column += offsetof(IMDBRow, f10) / kCellSize;
-    uint32_t curr_row_addr = ColAddr2RowAddr(GenColAddr(f10_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-    num_traces++;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 7);
+  return GenPlanTrace(trace_file_name, plan, kDRAM);
+}
 
-    // if f10 match row read f1
-    if(i % 10 < THRESHOLD_LOW)
-    {
-      continue;
-    }
-    curr_row_addr = ColAddr2RowAddr(GenColAddr(f1_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-    num_traces++;
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+// Generates DRAM query trace, begin with a base address.
+// The acces pattern of the following SQL query:
+// Select f1, SUM(f9) from table-a group by f1
+int GenDRAMTrace_25(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
+  printf("GenDRAMTrace_25 is running, Select f1, SUM(f9) from table-a group by f1 .\n");
+
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
+  printf("Base column address for the hash table: 0x%08llx\n",
+         (unsigned long long)kOLXPGroupAddr);
+
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 16);
+  return GenPlanTrace(trace_file_name, plan, kDRAM);
 }
 
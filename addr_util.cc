@@ -5,122 +5,475 @@
 #include "addr_util.h"
 #include "gen_trace.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <assert.h>
+#include <chrono>
+#include <vector>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
-uint32_t ColAddr2RowAddr(uint32_t col_addr) {
+static AddrCodec MakeAddrCodec(const DeviceGeometry& geometry) {
+  AddrCodec codec = {};
+  codec.geometry = geometry;
+  const int width[kNumAddrFields] = {
+    geometry.high_row_bit, geometry.bank_bit, geometry.channel_bit,
+    geometry.low_row_bit, geometry.column_bit, geometry.intra_bus_bit,
+  };
+  // Fields from the least significant bit up
+  const AddrField row_order[] = {
+    kFieldIntraBus, kFieldColumn, kFieldLowRow, kFieldChannel, kFieldBank,
+    kFieldHighRow,
+  };
+  const AddrField col_order[] = {
+    kFieldIntraBus, kFieldLowRow, kFieldColumn, kFieldChannel, kFieldBank,
+    kFieldHighRow,
+  };
+  int row_shift = 0;
+  int col_shift = 0;
+  for (int i = 0; i < kNumAddrFields; i++) {
+    codec.row_shift[row_order[i]] = row_shift;
+    codec.col_shift[col_order[i]] = col_shift;
+    row_shift += width[row_order[i]];
+    col_shift += width[col_order[i]];
+  }
+  for (int f = 0; f < kNumAddrFields; f++) {
+    codec.mask[f] = (1ull << width[f]) - 1;
+  }
+  // HighRow takes every bit above the other fields, as far as Address holds
+  int high_row_shift = codec.row_shift[kFieldHighRow];
+  codec.mask[kFieldHighRow] = 64 - high_row_shift > kMaxHighRowBit
+                              ? (1ull << kMaxHighRowBit) - 1
+                              : ~0ull >> high_row_shift;
+  codec.addr_bits = row_shift;
+
+  codec.row_low_row_mask =
+      codec.mask[kFieldLowRow] << codec.row_shift[kFieldLowRow];
+  codec.row_column_mask =
+      codec.mask[kFieldColumn] << codec.row_shift[kFieldColumn];
+  codec.col_low_row_mask =
+      codec.mask[kFieldLowRow] << codec.col_shift[kFieldLowRow];
+  codec.col_column_mask =
+      codec.mask[kFieldColumn] << codec.col_shift[kFieldColumn];
+  codec.keep_mask = ~(codec.row_low_row_mask | codec.row_column_mask);
+
+  codec.column_buffer_shift = -1;
+  for (int shift = 0; shift < 31; shift++) {
+    if ((1ull << shift) == (uint64_t)geometry.column_buffer_size) {
+      codec.column_buffer_shift = shift;
+    }
+  }
+  return codec;
+}
+
+AddrCodec g_addr_codec = MakeAddrCodec(kDefaultGeometry);
+
+int SetDeviceGeometry(const DeviceGeometry& geometry) {
+  const DeviceGeometry& g = geometry;
+  const int width[kNumAddrFields] = {
+    g.high_row_bit, g.bank_bit, g.channel_bit, g.low_row_bit, g.column_bit,
+    g.intra_bus_bit,
+  };
+  // Every field is checked on its own first, so that neither the total nor
+  // the shifts below overflow
+  bool fields_fit = true;
+  int total = 0;
+  for (int f = 0; f < kNumAddrFields; f++) {
+    fields_fit = fields_fit && width[f] >= 0 && width[f] < 63;
+    if (fields_fit) total += width[f];
+  }
+  const char* error = NULL;
+  if (!fields_fit || g.high_row_bit < 1 || g.low_row_bit < 1
+      || g.column_bit < 1 || total > 64 || g.high_row_bit > kMaxHighRowBit) {
+    error = "fields must fit in 64 bits and HighRow in 31, with at least one "
+            "HighRow, LowRow and Column bit";
+  } else if ((1ull << g.intra_bus_bit) != (uint64_t)kCellSize) {
+    // Tuples are laid out in cells, see CalTupleColAddrLayout2
+    error = "IntraBus must address the bytes of a cell";
+  } else if (g.row_buffer_size < 1
+             || (uint64_t)g.row_buffer_size > (1ull << g.column_bit)
+             || g.column_buffer_size < 1
+             || (uint64_t)g.column_buffer_size > (1ull << g.low_row_bit)) {
+    error = "buffers must fit in the Column and LowRow fields";
+  }
+  if (error != NULL) {
+    fprintf(stderr, "Invalid device geometry: %s\n", error);
+    return kFailure;
+  }
+  bool bmi2 = g_addr_codec.bmi2;
+  g_addr_codec = MakeAddrCodec(geometry);
+  g_addr_codec.bmi2 = bmi2;
+  return kSuccess;
+}
+
+const DeviceGeometry& GetDeviceGeometry() {
+  return g_addr_codec.geometry;
+}
+
+void PrintDeviceGeometry() {
+  const DeviceGeometry& g = g_addr_codec.geometry;
+  printf("Device geometry: HighRow(%d) Bank(%d) C(%d) LowRow(%d) Column(%d) "
+         "IntraBus(%d), row buffer %d cells, column buffer %d cells\n",
+         g.high_row_bit, g.bank_bit, g.channel_bit, g.low_row_bit,
+         g.column_bit, g.intra_bus_bit, g.row_buffer_size,
+         g.column_buffer_size);
+}
+
+int LoadDeviceGeometry(const char* file_name, DeviceGeometry* geometry) {
+  FILE* fp = fopen(file_name, "r");
+  if (fp == NULL) {
+    fprintf(stderr, "Cannot open device geometry %s\n", file_name);
+    return kFailure;
+  }
+  struct {
+    const char* key;
+    int* value;
+  } keys[] = {
+    {"high_row_bits", &geometry->high_row_bit},
+    {"bank_bits", &geometry->bank_bit},
+    {"channel_bits", &geometry->channel_bit},
+    {"low_row_bits", &geometry->low_row_bit},
+    {"column_bits", &geometry->column_bit},
+    {"intra_bus_bits", &geometry->intra_bus_bit},
+    {"row_buffer_size", &geometry->row_buffer_size},
+    {"column_buffer_size", &geometry->column_buffer_size},
+  };
+  *geometry = kDefaultGeometry;
+  char line[256];
+  int line_num = 0;
+  int status = kSuccess;
+  while (status == kSuccess && fgets(line, sizeof(line), fp) != NULL) {
+    ++line_num;
+    char* comment = strchr(line, '#');
+    if (comment != NULL) *comment = '\0';
+    char key[64];
+    int value;
+    char extra;
+    int n = sscanf(line, "%63s %d %c", key, &value, &extra);
+    if (n <= 0) continue;
+    status = kFailure;
+    for (size_t k = 0; n == 2 && k < sizeof(keys) / sizeof(keys[0]); k++) {
+      if (strcmp(key, keys[k].key) == 0) {
+        *keys[k].value = value;
+        status = kSuccess;
+      }
+    }
+  }
+  fclose(fp);
+  if (status != kSuccess) {
+    fprintf(stderr, "%s:%d: expected: <key> <value>, with a known key\n",
+            file_name, line_num);
+  }
+  return status;
+}
+
+uint64_t ColAddr2RowAddrParse(uint64_t col_addr) {
   Address addr = {};
   ParseColAddr(col_addr, addr);
-  uint32_t temp_addr = GenRowAddr(addr);
+  uint64_t temp_addr = GenRowAddr(addr);
   return temp_addr;
 }
 
-uint32_t RowAddr2ColAddr(uint32_t row_addr) {
+uint64_t RowAddr2ColAddrParse(uint64_t row_addr) {
   Address addr = {};
   ParseRowAddr(row_addr, addr);
-  uint32_t temp_addr = GenColAddr(addr);
+  uint64_t temp_addr = GenColAddr(addr);
   return temp_addr;
 }
 
-int ParseRowAddr(uint32_t row_addr, Address& result) {
-  uint32_t high_row_shift = kBankBit + kChannelBit + kLowRowBit + kColumnBit
-      + kIntraBusBit;
-  uint32_t bank_shift = high_row_shift - kBankBit;
-  uint32_t channel_shift = bank_shift - kChannelBit;
-  uint32_t low_row_shift = channel_shift - kLowRowBit;
-  uint32_t column_shift = low_row_shift - kColumnBit;
+#if defined(__x86_64__)
+__attribute__((target("bmi2")))
+uint64_t ColAddr2RowAddrBMI2(uint64_t col_addr) {
+  const AddrCodec& c = g_addr_codec;
+  return (col_addr & c.keep_mask)
+      | _pdep_u64(_pext_u64(col_addr, c.col_low_row_mask), c.row_low_row_mask)
+      | _pdep_u64(_pext_u64(col_addr, c.col_column_mask), c.row_column_mask);
+}
+
+__attribute__((target("bmi2")))
+uint64_t RowAddr2ColAddrBMI2(uint64_t row_addr) {
+  const AddrCodec& c = g_addr_codec;
+  return (row_addr & c.keep_mask)
+      | _pdep_u64(_pext_u64(row_addr, c.row_low_row_mask), c.col_low_row_mask)
+      | _pdep_u64(_pext_u64(row_addr, c.row_column_mask), c.col_column_mask);
+}
+
+static bool CPUSupportsBMI2() {
+  return __builtin_cpu_supports("bmi2");
+}
+#else
+uint64_t ColAddr2RowAddrBMI2(uint64_t col_addr) {
+  return ColAddr2RowAddrParse(col_addr);
+}
+
+uint64_t RowAddr2ColAddrBMI2(uint64_t row_addr) {
+  return RowAddr2ColAddrParse(row_addr);
+}
+
+static bool CPUSupportsBMI2() {
+  return false;
+}
+#endif
+
+// Addresses the conversions are timed on, spread over all fields
+static const int kBenchAddrs = 1 << 14;
+
+// Converts num_addrs addresses with convert and returns the time per address
+// in ns. The results are folded into *sum so the loop is not optimized away.
+template <typename Convert>
+static double TimeConversion(const std::vector<uint64_t>& addrs, int num_addrs,
+                             Convert convert, uint64_t* sum) {
+  std::chrono::steady_clock::time_point begin =
+      std::chrono::steady_clock::now();
+  uint64_t folded = 0;
+  for (int i = 0; i < num_addrs; i++) {
+    folded ^= convert(addrs[i & (kBenchAddrs - 1)]) + i;
+  }
+  *sum = folded;
+  return std::chrono::duration<double, std::nano>(
+      std::chrono::steady_clock::now() - begin).count() / num_addrs;
+}
+
+static std::vector<uint64_t> BenchAddrs() {
+  std::vector<uint64_t> addrs(kBenchAddrs);
+  uint32_t addr = 0x12345678u;
+  for (int i = 0; i < kBenchAddrs; i++) {
+    addrs[i] = addr;
+    addr = addr * 1664525u + 1013904223u;
+  }
+  return addrs;
+}
+
+// The mask/shift swap of ColAddr2RowAddr; g_addr_codec.bmi2 must be false
+static double TimeSwap(const std::vector<uint64_t>& addrs, int num_addrs,
+                       uint64_t* sum) {
+  return TimeConversion(addrs, num_addrs, [](uint64_t a) {
+    return ColAddr2RowAddr(a);
+  }, sum);
+}
+
+static double TimeBMI2(const std::vector<uint64_t>& addrs, int num_addrs,
+                       uint64_t* sum) {
+  return TimeConversion(addrs, num_addrs, ColAddr2RowAddrBMI2, sum);
+}
+
+// pext/pdep only pays off where the inlined mask/shift swap is not faster,
+// which a short run decides
+void SelectAddrConverter() {
+  g_addr_codec.bmi2 = false;
+  if (!CPUSupportsBMI2()) return;
+  std::vector<uint64_t> addrs = BenchAddrs();
+  uint64_t swap_sum, bmi2_sum;
+  double swap_ns = TimeSwap(addrs, 1 << 18, &swap_sum);
+  double bmi2_ns = TimeBMI2(addrs, 1 << 18, &bmi2_sum);
+  g_addr_codec.bmi2 = bmi2_sum == swap_sum && bmi2_ns < swap_ns;
+}
+
+bool AddrConverterUsesBMI2() {
+  return g_addr_codec.bmi2;
+}
+
+static bool IsDefaultGeometry(const DeviceGeometry& g) {
+  const DeviceGeometry& d = kDefaultGeometry;
+  return g.high_row_bit == d.high_row_bit && g.bank_bit == d.bank_bit
+      && g.channel_bit == d.channel_bit && g.low_row_bit == d.low_row_bit
+      && g.column_bit == d.column_bit && g.intra_bus_bit == d.intra_bus_bit;
+}
+
+void BenchAddrConversion(int num_addrs) {
+  bool bmi2 = CPUSupportsBMI2();
+  bool selected_bmi2 = g_addr_codec.bmi2;
+  g_addr_codec.bmi2 = false;
+  for (uint64_t addr = 0; addr < (1u << 24); addr += 0x3f1u) {
+    uint64_t row_addr = ColAddr2RowAddrParse(addr);
+    assert(ColAddr2RowAddr(addr) == row_addr);
+    assert(RowAddr2ColAddr(row_addr) == RowAddr2ColAddrParse(row_addr));
+    assert(!bmi2 || ColAddr2RowAddrBMI2(addr) == row_addr);
+    assert(!bmi2 || RowAddr2ColAddrBMI2(row_addr)
+                    == RowAddr2ColAddrParse(row_addr));
+  }
 
-  result.highrow = row_addr >> high_row_shift;
-  result.bank = (row_addr >> bank_shift) & ((1 << kBankBit) - 1);
-  result.channel = (row_addr >> channel_shift) & ((1 << kChannelBit) - 1);
-  result.lowrow = (row_addr >> low_row_shift) & ((1 << kLowRowBit) - 1);
-  result.column = (row_addr >> column_shift) & ((1 << kColumnBit) - 1);
-  result.intrabus = row_addr & ((1 << kIntraBusBit) - 1);
+  std::vector<uint64_t> addrs = BenchAddrs();
+  uint64_t parse_sum, swap_sum, bmi2_sum, fixed_sum;
+  double parse_ns = TimeConversion(addrs, num_addrs, ColAddr2RowAddrParse,
+                                   &parse_sum);
+  double swap_ns = TimeSwap(addrs, num_addrs, &swap_sum);
+  printf("Column to row address conversion, %d addresses:\n", num_addrs);
+  printf("  parse/rebuild        %6.2f ns per address\n", parse_ns);
+  printf("  mask/shift           %6.2f ns per address, %.1fx\n", swap_ns,
+         parse_ns / swap_ns);
+  assert(swap_sum == parse_sum);
+  if (IsDefaultGeometry(g_addr_codec.geometry)) {
+    // The swap with the widths of the default device compiled in
+    double fixed_ns = TimeConversion(addrs, num_addrs, [](uint64_t a) {
+      return SwapAddrFields<kIntraBusBit, kLowRowBit, kColumnBit>(a);
+    }, &fixed_sum);
+    printf("  mask/shift template  %6.2f ns per address, %.1fx\n", fixed_ns,
+           parse_ns / fixed_ns);
+    assert(fixed_sum == parse_sum);
+  }
+  if (bmi2) {
+    double bmi2_ns = TimeBMI2(addrs, num_addrs, &bmi2_sum);
+    printf("  pext/pdep (BMI2)     %6.2f ns per address, %.1fx\n", bmi2_ns,
+           parse_ns / bmi2_ns);
+    assert(bmi2_sum == parse_sum);
+  } else {
+    printf("  pext/pdep (BMI2)     not supported by this CPU\n");
+  }
+  g_addr_codec.bmi2 = selected_bmi2;
+  printf("ColAddr2RowAddr uses %s\n",
+         selected_bmi2 ? "pext/pdep" : "mask/shift");
+}
+
+static inline void ParseAddr(uint64_t addr, const int* shift,
+                             Address& result) {
+  const uint64_t* mask = g_addr_codec.mask;
+  result.highrow = (addr >> shift[kFieldHighRow]) & mask[kFieldHighRow];
+  result.bank = (addr >> shift[kFieldBank]) & mask[kFieldBank];
+  result.channel = (addr >> shift[kFieldChannel]) & mask[kFieldChannel];
+  result.lowrow = (addr >> shift[kFieldLowRow]) & mask[kFieldLowRow];
+  result.column = (addr >> shift[kFieldColumn]) & mask[kFieldColumn];
+  result.intrabus = addr & mask[kFieldIntraBus];
+}
+
+int ParseRowAddr(uint64_t row_addr, Address& result) {
+  ParseAddr(row_addr, g_addr_codec.row_shift, result);
+  return kSuccess;
+}
 
+int ParseColAddr(uint64_t col_addr, Address& result) {
+  ParseAddr(col_addr, g_addr_codec.col_shift, result);
   return kSuccess;
 }
 
-int ParseColAddr(uint32_t col_addr, Address& result) {
-  uint32_t high_row_shift = kBankBit + kChannelBit + kColumnBit + kLowRowBit
-      + kIntraBusBit;
-  uint32_t bank_shift = high_row_shift - kBankBit;
-  uint32_t channel_shift = bank_shift - kChannelBit;
-  uint32_t column_shift = channel_shift - kColumnBit;
-  uint32_t low_row_shift = column_shift - kLowRowBit;
+static void PrintAddrFields(uint64_t addr, const int* shift,
+                            const AddrField* order) {
+  static const char* const kFieldNames[kNumAddrFields] = {
+    "HighRow", "Bank", "Channel", "LowRow", "Column", "IntraBus",
+  };
+  for (int i = 0; i < kNumAddrFields; i++) {
+    AddrField f = order[i];
+    uint64_t bits = (addr >> shift[f]) & g_addr_codec.mask[f];
+    printf("%s bits: 0x%llx (%llu)\n", kFieldNames[f],
+           (unsigned long long)bits, (unsigned long long)bits);
+  }
+}
 
-  result.highrow = col_addr >> high_row_shift;
-  result.bank = (col_addr >> bank_shift) & ((1 << kBankBit) - 1);
-  result.channel = (col_addr >> channel_shift) & ((1 << kChannelBit) - 1);
-  result.column = (col_addr >> column_shift) & ((1 << kColumnBit) - 1);
-  result.lowrow = (col_addr >> low_row_shift) & ((1 << kLowRowBit) - 1);
-  result.intrabus = col_addr & ((1 << kIntraBusBit) - 1);
+int ParsePrintRowAddr(uint64_t row_addr) {
+  static const AddrField kOrder[kNumAddrFields] = {
+    kFieldHighRow, kFieldBank, kFieldChannel, kFieldLowRow, kFieldColumn,
+    kFieldIntraBus,
+  };
+  printf("Row address to be parsed: 0x%08llx\n",
+         (unsigned long long)row_addr);
+  PrintAddrFields(row_addr, g_addr_codec.row_shift, kOrder);
+  return kSuccess;
+}
 
+int ParsePrintColAddr(uint64_t col_addr) {
+  static const AddrField kOrder[kNumAddrFields] = {
+    kFieldHighRow, kFieldBank, kFieldChannel, kFieldColumn, kFieldLowRow,
+    kFieldIntraBus,
+  };
+  printf("Column address to be parsed: 0x%08llx\n",
+         (unsigned long long)col_addr);
+  PrintAddrFields(col_addr, g_addr_codec.col_shift, kOrder);
   return kSuccess;
 }
 
+static BankInterleave g_bank_interleave = kInterleaveNone;
 
-int ParsePrintRowAddr(uint32_t row_addr) {
-  uint32_t high_row_shift = kBankBit + kChannelBit + kLowRowBit + kColumnBit
-      + kIntraBusBit;
-  uint32_t bank_shift = high_row_shift - kBankBit;
-  uint32_t channel_shift = bank_shift - kChannelBit;
-  uint32_t low_row_shift = channel_shift - kLowRowBit;
-  uint32_t column_shift = low_row_shift - kColumnBit;
-  assert(column_shift == (unsigned)kIntraBusBit);
+void SetBankInterleave(BankInterleave interleave) {
+  g_bank_interleave = interleave;
+}
 
-  printf("Row address to be parsed: 0x%08x\n", row_addr);
+BankInterleave GetBankInterleave() {
+  return g_bank_interleave;
+}
 
-  uint32_t high_row_bit = row_addr >> high_row_shift;
-  printf("HighRow bits: 0x%x (%u)\n", high_row_bit, high_row_bit);
-  uint32_t bank_bit = (row_addr >> bank_shift) & ((1 << kBankBit) - 1);
-  printf("Bank bits: 0x%x (%u)\n", bank_bit, bank_bit);
-  uint32_t channel_bit = (row_addr >> channel_shift) & ((1 << kChannelBit) - 1);
-  printf("Channel bits: 0x%x (%u)\n", channel_bit, channel_bit);
-  uint32_t low_row_bit = (row_addr >> low_row_shift) & ((1 << kLowRowBit) - 1);
-  printf("LowRow bits: 0x%x (%u)\n", low_row_bit, low_row_bit);
-  uint32_t column_bit = (row_addr >> column_shift) & ((1 << kColumnBit) - 1);
-  printf("Column bits: 0x%x (%u)\n", column_bit, column_bit);
-  uint32_t intra_bus_bit = row_addr & ((1 << kIntraBusBit) - 1);
-  printf("IntraBus bits: 0x%x (%u)\n", intra_bus_bit, intra_bus_bit);
+static const char* const kBankInterleaveNames[] = {"none", "rr", "xor"};
 
-  return kSuccess;
+int ParseBankInterleave(const char* name, BankInterleave* interleave) {
+  for (int i = kInterleaveNone; i <= kInterleaveXor; i++) {
+    if (strcmp(name, kBankInterleaveNames[i]) == 0) {
+      *interleave = (BankInterleave)i;
+      return kSuccess;
+    }
+  }
+  return kFailure;
+}
+
+const char* BankInterleaveName(BankInterleave interleave) {
+  return kBankInterleaveNames[interleave];
+}
+
+static TableLayout g_table_layout = kColumnFirstLayout;
+
+void SetTableLayout(const TableLayout& layout) {
+  g_table_layout = layout;
+}
+
+const TableLayout& GetTableLayout() {
+  return g_table_layout;
 }
 
-int ParsePrintColAddr(uint32_t col_addr) {
-  uint32_t high_row_shift = kBankBit + kChannelBit + kColumnBit + kLowRowBit
-      + kIntraBusBit;
-  uint32_t bank_shift = high_row_shift - kBankBit;
-  uint32_t channel_shift = bank_shift - kChannelBit;
-  uint32_t column_shift = channel_shift - kColumnBit;
-  uint32_t low_row_shift = column_shift - kLowRowBit;
-  assert(low_row_shift == (unsigned )kIntraBusBit);
-
-  printf("Column address to be parsed: 0x%08x\n", col_addr);
-
-  uint32_t high_row_bit = col_addr >> high_row_shift;
-  printf("HighRow bits: 0x%x (%u)\n", high_row_bit, high_row_bit);
-  uint32_t bank_bit = (col_addr >> bank_shift) & ((1 << kBankBit) - 1);
-  printf("Bank bits: 0x%x (%u)\n", bank_bit, bank_bit);
-  uint32_t channel_bit = (col_addr >> channel_shift) & ((1 << kChannelBit) - 1);
-  printf("Channel bits: 0x%x (%u)\n", channel_bit, channel_bit);
-  uint32_t column_bit = (col_addr >> column_shift) & ((1 << kColumnBit) - 1);
-  printf("Column bits: 0x%x (%u)\n", column_bit, column_bit);
-  uint32_t low_row_bit = (col_addr >> low_row_shift) & ((1 << kLowRowBit) - 1);
-  printf("LowRow bits: 0x%x (%u)\n", low_row_bit, low_row_bit);
-  uint32_t intra_bus_bit = col_addr & ((1 << kIntraBusBit) - 1);
-  printf("IntraBus bits: 0x%x (%u)\n", intra_bus_bit, intra_bus_bit);
+// Cells of a column group and tuples of a tile row unless the name says
+static const int kDefaultGroupCells = kCachelineSize / kCellSize;
+static const int kDefaultTileTuples = 4;
+
+// Parses the number after prefix in name into *param, which keeps its value
+// when there is none
+static bool ParseLayoutParam(const char* name, const char* prefix,
+                             int* param) {
+  size_t len = strlen(prefix);
+  if (strncmp(name, prefix, len) != 0) return false;
+  if (name[len] == '\0') return true;
+  char* end;
+  long value = strtol(name + len, &end, 10);
+  if (*end != '\0' || value <= 0 || value > (1 << 20)) return false;
+  *param = (int)value;
+  return true;
+}
 
+int ParseTableLayout(const char* name, TableLayout* layout) {
+  int group_cells = kDefaultGroupCells;
+  int tile_tuples = kDefaultTileTuples;
+  if (strcmp(name, "row") == 0) {
+    *layout = kRowFirstLayout;
+  } else if (strcmp(name, "col") == 0) {
+    *layout = kColumnFirstLayout;
+  } else if (strcmp(name, "pax") == 0) {
+    *layout = TableLayout{kLayoutPax, 0};
+  } else if (ParseLayoutParam(name, "group", &group_cells)) {
+    // A group is whole cache lines of a tuple
+    if (group_cells % (kCachelineSize / kCellSize) != 0) return kFailure;
+    *layout = TableLayout{kLayoutColumnGroup, group_cells};
+  } else if (ParseLayoutParam(name, "tile", &tile_tuples)) {
+    *layout = TableLayout{kLayoutHybridTile, tile_tuples};
+  } else {
+    return kFailure;
+  }
   return kSuccess;
 }
 
-uint32_t CalTupleRowAddrLayout1(int n, int tuple_size, uint32_t row_base_addr) {
-  return (row_base_addr + (uint32_t)tuple_size * (uint32_t)n);
+std::string TableLayoutName(const TableLayout& layout) {
+  switch (layout.kind) {
+    case kLayoutRowFirst: return "layout1";
+    case kLayoutColumnFirst: return "layout2";
+    case kLayoutPax: return "pax";
+    case kLayoutColumnGroup: return "group" + std::to_string(layout.param);
+    case kLayoutHybridTile: return "tile" + std::to_string(layout.param);
+  }
+  return "?";
+}
+
+uint64_t CalTupleRowAddrLayout1(int64_t n, int tuple_size,
+                                uint64_t row_base_addr) {
+  return CalTupleRowAddr(n, tuple_size, row_base_addr, g_bank_interleave);
 }
-uint32_t CalTupleColAddrLayout2(int n, int tuple_size, uint32_t col_base_addr) {
-  int column_span = n / kColumnBufferSize;
-  int remain_tuple = n % kColumnBufferSize;
-  int column_shift = kLowRowBit + kIntraBusBit;
-  // Overflow, alignment?
-  uint32_t column_offset = (uint32_t)((((tuple_size - 1) / kCellSize + 1)
-      << column_shift) * column_span);
-  return col_base_addr + column_offset + (remain_tuple << kIntraBusBit);
+
+uint64_t CalTupleColAddrLayout2(int64_t n, int tuple_size,
+                                uint64_t col_base_addr) {
+  return CalTupleColAddr(n, tuple_size, col_base_addr, g_bank_interleave);
 }
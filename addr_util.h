@@ -6,6 +6,8 @@
 #define ADDR_UTIL_H_
 
 #include "gen_trace.h"
+#include <assert.h>
+#include <string>
 
 // Aligns the supplied size to the specified PowerOfTwo
 #define ALIGN_SIZE( sizeToAlign, PowerOfTwo )       \
@@ -19,78 +21,336 @@
 #define THRESHOLD 8
 #define THRESHOLD_LOW 2
 
-uint32_t GenRowAddr(int high_row, int low_row, int column, int bank,
+uint64_t GenRowAddr(int high_row, int low_row, int column, int bank,
                     int channel, int intra_bus);
-uint32_t GenRowAddr(int high_row, int low_row, int column);
-uint32_t GenRowAddr(Address addr);
-uint32_t GenColAddr(int high_row, int low_row, int column, int bank,
-                       int channel, int intra_bus);
-uint32_t GenColAddr(int high_row, int low_row, int column);
-uint32_t GenColAddr(Address addr);
-uint32_t ColAddr2RowAddr(uint32_t col_addr);
-uint32_t RowAddr2ColAddr(uint32_t row_addr);
-int ParsePrintRowAddr(uint32_t row_addr);
-int ParsePrintColAddr(uint32_t col_addr);
-int ParseRowAddr(uint32_t row_addr, Address& result);
-int ParseColAddr(uint32_t col_addr, Address& result);
-
-uint32_t CalTupleRowAddrLayout1(int n, int tuple_size, uint32_t base_addr);
-uint32_t CalTupleColAddrLayout2(int n, int tuple_size, uint32_t base_addr);
-
-uint32_t GetCacheLineAddr(uint32_t addr);
+uint64_t GenRowAddr(int high_row, int low_row, int column);
+uint64_t GenRowAddr(Address addr);
+uint64_t GenColAddr(int high_row, int low_row, int column, int bank,
+                    int channel, int intra_bus);
+uint64_t GenColAddr(int high_row, int low_row, int column);
+uint64_t GenColAddr(Address addr);
+uint64_t ColAddr2RowAddr(uint64_t col_addr);
+uint64_t RowAddr2ColAddr(uint64_t row_addr);
+// The conversions by parsing into an Address and rebuilding it, and with the
+// BMI2 pext/pdep instructions; the latter only on CPUs that have them
+uint64_t ColAddr2RowAddrParse(uint64_t col_addr);
+uint64_t RowAddr2ColAddrParse(uint64_t row_addr);
+uint64_t ColAddr2RowAddrBMI2(uint64_t col_addr);
+uint64_t RowAddr2ColAddrBMI2(uint64_t row_addr);
+
+// Makes ColAddr2RowAddr and RowAddr2ColAddr use pext/pdep if the CPU supports
+// BMI2 and a short run finds it faster; called from main once the device
+// geometry is set
+void SelectAddrConverter();
+bool AddrConverterUsesBMI2();
+// Times the conversions over num_addrs addresses and checks they agree
+void BenchAddrConversion(int num_addrs);
+
+// Shifts and masks of the address fields of the selected device geometry,
+// computed once by SetDeviceGeometry
+enum AddrField {
+  kFieldHighRow,
+  kFieldBank,
+  kFieldChannel,
+  kFieldLowRow,
+  kFieldColumn,
+  kFieldIntraBus,
+  kNumAddrFields,
+};
+
+struct AddrCodec {
+  DeviceGeometry geometry;
+  int row_shift[kNumAddrFields];
+  int col_shift[kNumAddrFields];
+  uint64_t mask[kNumAddrFields];  // of a field shifted down to bit 0
+  // LowRow and Column in place in row and column addresses, and the bits
+  // the two formats share
+  uint64_t row_low_row_mask;
+  uint64_t row_column_mask;
+  uint64_t col_low_row_mask;
+  uint64_t col_column_mask;
+  uint64_t keep_mask;
+  int addr_bits;  // the fields together
+  // log2 of a power of two column buffer, else -1
+  int column_buffer_shift;
+  bool bmi2;  // conversions through pext/pdep, see SelectAddrConverter
+};
+
+extern AddrCodec g_addr_codec;
+
+// HighRow bits an Address holds
+static const int kMaxHighRowBit = 31;
+
+// Checks geometry and builds the codec tables from it. Must not be called
+// while traces are generated.
+int SetDeviceGeometry(const DeviceGeometry& geometry);
+const DeviceGeometry& GetDeviceGeometry();
+void PrintDeviceGeometry();
+
+// Reads a device geometry from a config file of "key value" lines, with '#'
+// starting a comment. The keys are high_row_bits, bank_bits, channel_bits,
+// low_row_bits, column_bits, intra_bus_bits, row_buffer_size and
+// column_buffer_size; missing keys keep the value of kDefaultGeometry.
+int LoadDeviceGeometry(const char* file_name, DeviceGeometry* geometry);
+
+int ParsePrintRowAddr(uint64_t row_addr);
+int ParsePrintColAddr(uint64_t col_addr);
+int ParseRowAddr(uint64_t row_addr, Address& result);
+int ParseColAddr(uint64_t col_addr, Address& result);
+
+// Interleaving of the layouts below, selected once from main; tables of a
+// query plan may override it
+void SetBankInterleave(BankInterleave interleave);
+BankInterleave GetBankInterleave();
+// "none", "rr" or "xor"; returns kFailure for anything else
+int ParseBankInterleave(const char* name, BankInterleave* interleave);
+const char* BankInterleaveName(BankInterleave interleave);
+
+// Layout of the tables of query plans, selected once from main; tables of a
+// schema file may override it
+void SetTableLayout(const TableLayout& layout);
+const TableLayout& GetTableLayout();
+// "row", "col", "pax", "group[cells]" or "tile[tuples]"; returns kFailure for
+// anything else
+int ParseTableLayout(const char* name, TableLayout* layout);
+// "layout1", "layout2", "pax", "group<cells>" or "tile<tuples>", as used in
+// trace file names
+std::string TableLayoutName(const TableLayout& layout);
+
+// Row address of tuple n of a row-first table (Layout 1) and column address
+// of tuple n of a column-first table (Layout 2), with the interleaving of
+// GetBankInterleave()
+uint64_t CalTupleRowAddrLayout1(int64_t n, int tuple_size, uint64_t base_addr);
+uint64_t CalTupleColAddrLayout2(int64_t n, int tuple_size, uint64_t base_addr);
+// The same with the interleaving given. An interleaved stripe takes the
+// bank/channel unit its number maps to, and the stripes of a unit fill its
+// rows from base_addr on. Tuples should not straddle row buffers.
+inline uint64_t CalTupleRowAddr(int64_t n, int tuple_size, uint64_t base_addr,
+                                BankInterleave interleave);
+inline uint64_t CalTupleColAddr(int64_t n, int tuple_size, uint64_t base_addr,
+                                BankInterleave interleave);
+
+uint64_t GetCacheLineAddr(uint64_t addr);
 
 inline
-uint32_t GenRowAddr(int high_row, int low_row, int column) {
+uint64_t GenRowAddr(int high_row, int low_row, int column) {
   return GenRowAddr(high_row, low_row, column, 0, 0, 0);
 }
 
 inline
-uint32_t GenColAddr(int high_row, int low_row, int column) {
+uint64_t GenColAddr(int high_row, int low_row, int column) {
   return GenColAddr(high_row, low_row, column, 0, 0, 0);
 }
 
 inline
-uint32_t GenRowAddr(Address addr) {
+uint64_t GenRowAddr(Address addr) {
   return GenRowAddr(addr.highrow, addr.lowrow, addr.column, addr.bank,
                     addr.channel, addr.intrabus);
 }
 
 inline
-uint32_t GenColAddr(Address addr) {
+uint64_t GenColAddr(Address addr) {
   return GenColAddr(addr.highrow, addr.lowrow, addr.column, addr.bank,
                     addr.channel, addr.intrabus);
 }
 
+// Overflow check of the generators, an assert and so compiled out with
+// -DNDEBUG: an address must not run past the fields of the device. Fields may
+// carry into the next one, which some generators rely on.
+inline bool FitsAddrSpace(uint64_t addr) {
+  return g_addr_codec.addr_bits == 64 || (addr >> g_addr_codec.addr_bits) == 0;
+}
 
 inline
-uint32_t GenRowAddr(int high_row, int low_row, int column, int bank,
+uint64_t GenRowAddr(int high_row, int low_row, int column, int bank,
                     int channel, int intra_bus) {
-  // TODO: validation of arguments
-  uint32_t temp_addr = high_row;
-  temp_addr = (temp_addr << kBankBit) | bank;
-  temp_addr = (temp_addr << kChannelBit) | channel;
-  temp_addr = (temp_addr << kLowRowBit) | low_row;
-  temp_addr = (temp_addr << kColumnBit) | column;
-  temp_addr = (temp_addr << kIntraBusBit) | intra_bus;
-  return temp_addr;
+  const int* shift = g_addr_codec.row_shift;
+  uint64_t row_addr = ((uint64_t)(uint32_t)high_row << shift[kFieldHighRow])
+      | ((uint64_t)(uint32_t)bank << shift[kFieldBank])
+      | ((uint64_t)(uint32_t)channel << shift[kFieldChannel])
+      | ((uint64_t)(uint32_t)low_row << shift[kFieldLowRow])
+      | ((uint64_t)(uint32_t)column << shift[kFieldColumn])
+      | (uint64_t)(uint32_t)intra_bus;
+  assert(FitsAddrSpace(row_addr));
+  return row_addr;
 }
 
 inline
-uint32_t GenColAddr(int high_row, int low_row, int column, int bank,
+uint64_t GenColAddr(int high_row, int low_row, int column, int bank,
                     int channel, int intra_bus) {
-  // TODO: validation of arguments
-  uint32_t temp_addr = high_row;
-  temp_addr = (temp_addr << kBankBit) | bank;
-  temp_addr = (temp_addr << kChannelBit) | channel;
-  temp_addr = (temp_addr << kColumnBit) | column;
-  temp_addr = (temp_addr << kLowRowBit) | low_row;
-  temp_addr = (temp_addr << kIntraBusBit) | intra_bus;
-  return temp_addr;
+  const int* shift = g_addr_codec.col_shift;
+  uint64_t col_addr = ((uint64_t)(uint32_t)high_row << shift[kFieldHighRow])
+      | ((uint64_t)(uint32_t)bank << shift[kFieldBank])
+      | ((uint64_t)(uint32_t)channel << shift[kFieldChannel])
+      | ((uint64_t)(uint32_t)column << shift[kFieldColumn])
+      | ((uint64_t)(uint32_t)low_row << shift[kFieldLowRow])
+      | (uint64_t)(uint32_t)intra_bus;
+  assert(FitsAddrSpace(col_addr));
+  return col_addr;
 }
 
-inline uint32_t GetCacheLineAddr(uint32_t addr) {
+// Swaps the field of kLowBits bits at bit kShift with the field of kHighBits
+// bits right above it. Row and column addresses differ only in the order of
+// LowRow and Column, so a conversion is one swap; ColAddr2RowAddr does it
+// with the widths of the runtime geometry.
+template <int kShift, int kLowBits, int kHighBits>
+inline uint64_t SwapAddrFields(uint64_t addr) {
+  const uint64_t low_mask = ((1ull << kLowBits) - 1) << kShift;
+  const uint64_t high_mask = ((1ull << kHighBits) - 1) << (kShift + kLowBits);
+  return (addr & ~(low_mask | high_mask))
+      | ((addr & low_mask) << kHighBits)
+      | ((addr & high_mask) >> kLowBits);
+}
+
+inline uint64_t ColAddr2RowAddr(uint64_t col_addr) {
+  const AddrCodec& codec = g_addr_codec;
+  if (codec.bmi2) return ColAddr2RowAddrBMI2(col_addr);
+  return (col_addr & codec.keep_mask)
+      | ((col_addr & codec.col_low_row_mask) << codec.geometry.column_bit)
+      | ((col_addr & codec.col_column_mask) >> codec.geometry.low_row_bit);
+}
+
+inline uint64_t RowAddr2ColAddr(uint64_t row_addr) {
+  const AddrCodec& codec = g_addr_codec;
+  if (codec.bmi2) return RowAddr2ColAddrBMI2(row_addr);
+  return (row_addr & codec.keep_mask)
+      | ((row_addr & codec.row_low_row_mask) >> codec.geometry.column_bit)
+      | ((row_addr & codec.row_column_mask) << codec.geometry.low_row_bit);
+}
+
+inline uint64_t GetCacheLineAddr(uint64_t addr) {
   return (addr & (~(kCachelineSize - 1)));
 }
 
+// Column cache line of a column address: the cells of kCachelineSize /
+// kCellSize LowRows under one Column
+inline uint64_t GetColumnLineAddr(uint64_t col_addr) {
+  return col_addr & ~(((uint64_t)(kCachelineSize / kCellSize)
+                       << g_addr_codec.col_shift[kFieldLowRow]) - 1);
+}
+
+// Bank/channel unit of stripe; *local is the number of the stripe among the
+// stripes of its unit. Channel and Bank are next to each other in both
+// address formats, Channel below, so a unit is the two fields together.
+inline uint64_t InterleaveUnit(int64_t stripe, BankInterleave interleave,
+                               int64_t* local) {
+  const DeviceGeometry& g = g_addr_codec.geometry;
+  int unit_bits = g.bank_bit + g.channel_bit;
+  uint64_t unit_mask = (1ull << unit_bits) - 1;
+  *local = stripe >> unit_bits;
+  uint64_t unit = (uint64_t)stripe;
+  if (interleave == kInterleaveXor) unit ^= (uint64_t)*local;
+  return unit & unit_mask;
+}
+
+// Row address of byte offset of row stripe stripe, a whole row of the Column
+// field, counting from the row address base_addr
+inline uint64_t RowStripeAddr(uint64_t base_addr, int64_t stripe,
+                              uint64_t offset, BankInterleave interleave) {
+  const AddrCodec& codec = g_addr_codec;
+  int row_bits = codec.geometry.column_bit + codec.geometry.intra_bus_bit;
+  if (interleave == kInterleaveNone) {
+    return base_addr + ((uint64_t)stripe << row_bits) + offset;
+  }
+  int64_t local;
+  uint64_t unit = InterleaveUnit(stripe, interleave, &local);
+  return base_addr
+      + ((uint64_t)(local >> codec.geometry.low_row_bit)
+         << codec.row_shift[kFieldHighRow])
+      + (unit << codec.row_shift[kFieldChannel])
+      + (((uint64_t)local & codec.mask[kFieldLowRow])
+         << codec.row_shift[kFieldLowRow])
+      + offset;
+}
+
+// Column address of the cell at LowRow low_row and Column column of column
+// stripe stripe, stripe_cells wide, counting from the column address
+// base_addr. Without interleaving the stripes go side by side along the
+// Column field and carry on into the fields above it.
+inline uint64_t ColStripeAddr(uint64_t base_addr, int64_t stripe,
+                              uint64_t stripe_cells, int64_t low_row,
+                              uint64_t column, BankInterleave interleave) {
+  const AddrCodec& codec = g_addr_codec;
+  int column_shift = codec.col_shift[kFieldColumn];
+  uint64_t col_addr = base_addr
+      + ((uint64_t)low_row << codec.col_shift[kFieldLowRow]);
+  if (interleave == kInterleaveNone) {
+    // Alignment?
+    return col_addr + ((stripe_cells << column_shift) * (uint64_t)stripe
+                       + (column << column_shift));
+  }
+  // The stripes of a unit go side by side along its Column field and on to
+  // the next HighRow when a row has no room for another one
+  int64_t local;
+  uint64_t unit = InterleaveUnit(stripe, interleave, &local);
+  uint64_t row_stripes = (1ull << codec.geometry.column_bit) / stripe_cells;
+  assert(row_stripes > 0);
+  return col_addr
+      + ((uint64_t)local / row_stripes << codec.col_shift[kFieldHighRow])
+      + (unit << codec.col_shift[kFieldChannel])
+      + (((uint64_t)local % row_stripes * stripe_cells + column)
+         << column_shift);
+}
+
+// Row address of byte offset of tuple n, unchecked
+inline uint64_t TupleRowAddr(int64_t n, int tuple_size, uint64_t offset,
+                             uint64_t base_addr, BankInterleave interleave) {
+  offset += (uint64_t)tuple_size * (uint64_t)n;
+  if (interleave == kInterleaveNone) return base_addr + offset;
+  // A stripe is a whole row of the Column field
+  const DeviceGeometry& g = g_addr_codec.geometry;
+  int row_bits = g.column_bit + g.intra_bus_bit;
+  return RowStripeAddr(base_addr, offset >> row_bits,
+                       offset & ((1ull << row_bits) - 1), interleave);
+}
+
+// Column address of cell column of tuple n, unchecked. Tuple n is at LowRow
+// n % column_buffer_size of stripe n / column_buffer_size.
+inline uint64_t TupleColAddr(int64_t n, int tuple_size, uint64_t column,
+                             uint64_t base_addr, BankInterleave interleave) {
+  const AddrCodec& codec = g_addr_codec;
+  int64_t column_span, remain_tuple;
+  if (codec.column_buffer_shift >= 0) {
+    column_span = n >> codec.column_buffer_shift;
+    remain_tuple = n & (codec.geometry.column_buffer_size - 1);
+  } else {
+    column_span = n / codec.geometry.column_buffer_size;
+    remain_tuple = n % codec.geometry.column_buffer_size;
+  }
+  uint64_t tuple_cells = (tuple_size - 1) / kCellSize + 1;
+  return ColStripeAddr(base_addr, column_span, tuple_cells, remain_tuple,
+                       column, interleave);
+}
+
+inline uint64_t CalTupleRowAddr(int64_t n, int tuple_size, uint64_t base_addr,
+                                BankInterleave interleave) {
+  uint64_t row_addr = TupleRowAddr(n, tuple_size, 0, base_addr, interleave);
+  assert(n >= 0 && FitsAddrSpace(row_addr));
+  return row_addr;
+}
+
+inline uint64_t CalTupleColAddr(int64_t n, int tuple_size, uint64_t base_addr,
+                                BankInterleave interleave) {
+  uint64_t col_addr = TupleColAddr(n, tuple_size, 0, base_addr, interleave);
+  assert(n >= 0 && FitsAddrSpace(col_addr));
+  return col_addr;
+}
+
+// Whether the last byte of a table of num_tuples tuples from base_addr is
+// inside the fields of the device in both formats. The generators only
+// assert that their addresses are, so main checks every table up front.
+inline bool TableFitsAddrSpace(int64_t num_tuples, int tuple_size,
+                               uint64_t base_addr, BankInterleave interleave) {
+  if (g_addr_codec.addr_bits == 64 || num_tuples <= 0) return true;
+  // Every tuple takes a byte at least, which also keeps the offsets below
+  // from overflowing
+  if ((uint64_t)num_tuples >> g_addr_codec.addr_bits != 0) return false;
+  int64_t last = num_tuples - 1;
+  uint64_t last_cell = (tuple_size - 1) / kCellSize;
+  return FitsAddrSpace(TupleRowAddr(last, tuple_size, tuple_size - 1,
+                                    base_addr, interleave))
+      && FitsAddrSpace(TupleColAddr(last, tuple_size, last_cell, base_addr,
+                                    interleave));
+}
 
 #endif /* ADDR_UTIL_H_ */
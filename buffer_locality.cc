@@ -0,0 +1,272 @@
+/*
+ * buffer_locality.cc
+ */
+
+#include "buffer_locality.h"
+#include "addr_util.h"
+#include "trace_compress.h"
+#include "trace_writer.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+uint64_t BufferCounts::Total(BufferKind kind) const {
+  uint64_t total = 0;
+  for (int o = 0; o < kNumBufferOutcomes; o++) total += accesses[kind][o];
+  return total;
+}
+
+void BufferCounts::Add(const BufferCounts& other) {
+  for (int k = 0; k < kNumBufferKinds; k++) {
+    for (int o = 0; o < kNumBufferOutcomes; o++) {
+      accesses[k][o] += other.accesses[k][o];
+    }
+  }
+}
+
+BufferKind DecodeBufferAccess(char op, uint64_t addr, int* unit,
+                              uint64_t* buffer) {
+  const DeviceGeometry& geometry = GetDeviceGeometry();
+  BufferKind kind = op == 'r' || op == 'w' ? kColumnBuffer : kRowBuffer;
+  Address a;
+  if (kind == kRowBuffer) {
+    ParseRowAddr(addr, a);
+    *buffer = (((uint64_t)a.highrow << geometry.low_row_bit) | a.lowrow)
+                  << geometry.column_bit
+              | (uint64_t)(a.column / geometry.row_buffer_size);
+  } else {
+    ParseColAddr(addr, a);
+    *buffer = (((uint64_t)a.highrow << geometry.column_bit) | a.column)
+                  << geometry.low_row_bit
+              | (uint64_t)(a.lowrow / geometry.column_buffer_size);
+  }
+  *unit = a.channel << geometry.bank_bit | a.bank;
+  return kind;
+}
+
+int NumBufferUnits() {
+  const DeviceGeometry& geometry = GetDeviceGeometry();
+  return 1 << (geometry.bank_bit + geometry.channel_bit);
+}
+
+// The buffers the banks have open while a trace is read
+class BufferTracker {
+ public:
+  explicit BufferTracker(BufferLocality* result) : result_(result) {
+    int num_units = NumBufferUnits();
+    BufferCounts zero;
+    memset(&zero, 0, sizeof(zero));
+    result_->units.assign(num_units, zero);
+    result_->total = zero;
+    Bank closed = {kNumBufferKinds, 0};
+    banks_.assign(num_units, closed);
+  }
+
+  void Access(char op, uint64_t addr) {
+    int unit;
+    uint64_t buffer;
+    BufferKind kind = DecodeBufferAccess(op, addr, &unit, &buffer);
+    Bank& bank = banks_[unit];
+    BufferOutcome outcome;
+    if (bank.kind == kNumBufferKinds) {
+      outcome = kBufferMiss;
+    } else if (bank.kind != kind) {
+      outcome = kBufferSwitch;
+    } else {
+      outcome = bank.buffer == buffer ? kBufferHit : kBufferConflict;
+    }
+    bank.kind = kind;
+    bank.buffer = buffer;
+    ++result_->units[unit].accesses[kind][outcome];
+  }
+
+ private:
+  struct Bank {
+    BufferKind kind;  // kNumBufferKinds while closed
+    uint64_t buffer;
+  };
+
+  BufferLocality* result_;
+  std::vector<Bank> banks_;
+};
+
+// Access of an NVMain text line in [p, end); false if the line is not an
+// access or not the first line of one
+static bool ParseTextAccess(const char* p, const char* end, char* op,
+                            uint64_t* addr) {
+  int64_t n = 0;
+  const char* digits = p;
+  for (; p < end && *p >= '0' && *p <= '9'; p++) n = n * 10 + (*p - '0');
+  if (p == digits || n % kLinesPerAccess != 0) return false;
+  if (end - p < 5 || p[0] != ' ' || p[2] != ' ' || p[3] != '0'
+      || p[4] != 'x') {
+    return false;
+  }
+  *op = p[1];
+  uint64_t a = 0;
+  for (p += 5; p < end; p++) {
+    int digit;
+    if (*p >= '0' && *p <= '9') {
+      digit = *p - '0';
+    } else if (*p >= 'a' && *p <= 'f') {
+      digit = *p - 'a' + 10;
+    } else if (*p >= 'A' && *p <= 'F') {
+      digit = *p - 'A' + 10;
+    } else {
+      break;
+    }
+    a = a << 4 | digit;
+  }
+  *addr = a;
+  return true;
+}
+
+// Runs the complete lines of [data, data + size) through tracker and returns
+// the bytes they take; with last the rest is a line too
+static size_t TrackText(const char* data, size_t size, bool last,
+                        BufferTracker* tracker) {
+  const char* p = data;
+  const char* end = data + size;
+  while (p < end) {
+    const char* eol = (const char*)memchr(p, '\n', end - p);
+    if (eol == NULL) {
+      if (!last) break;
+      eol = end;
+    }
+    char op;
+    uint64_t addr;
+    if (ParseTextAccess(p, eol, &op, &addr)) tracker->Access(op, addr);
+    p = eol < end ? eol + 1 : end;
+  }
+  return p - data;
+}
+
+// The same for the whole records of a binary trace
+static size_t TrackRecords(const char* data, size_t size, int record_size,
+                           BufferTracker* tracker) {
+  const uint8_t* record = (const uint8_t*)data;
+  size_t num_records = size / record_size;
+  int addr_size = record_size - 4;
+  for (size_t i = 0; i < num_records; i++, record += record_size) {
+    uint8_t op = record[addr_size];
+    if (op == kBinaryOpSetIndex) continue;
+    uint64_t addr = 0;
+    for (int b = addr_size - 1; b >= 0; b--) addr = addr << 8 | record[b];
+    tracker->Access((char)op, addr);
+  }
+  return num_records * record_size;
+}
+
+int AnalyzeBufferLocality(const char* trace_file_name,
+                          BufferLocality* result) {
+  FILE* in = fopen(trace_file_name, "rb");
+  if (in == NULL) {
+    fprintf(stderr, "Cannot open %s\n", trace_file_name);
+    return kFailure;
+  }
+  // The reads are a block each and strictly sequential
+  setvbuf(in, NULL, _IONBF, 0);
+  posix_fadvise(fileno(in), 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  std::vector<char> buffer(kTraceBufferSize);
+  size_t used = fread(buffer.data(), 1, buffer.size(), in);
+  int record_size = 0;
+  size_t begin = 0;
+  if (used >= sizeof(kCompressedTraceMagic)
+      && memcmp(buffer.data(), kCompressedTraceMagic,
+                sizeof(kCompressedTraceMagic)) == 0) {
+    fprintf(stderr, "%s is compressed; decompress it with u first\n",
+            trace_file_name);
+    fclose(in);
+    return kFailure;
+  }
+  if (used >= (size_t)kBinaryTraceHeaderSize
+      && memcmp(buffer.data(), kBinaryTraceMagic,
+                sizeof(kBinaryTraceMagic)) == 0) {
+    const uint8_t* header = (const uint8_t*)buffer.data();
+    record_size = header[6] | (header[7] << 8);
+    if (record_size != kBinaryTraceRecordSize
+        && record_size != kBinaryTraceRecordSize64) {
+      fprintf(stderr, "%s has records of unsupported size %d\n",
+              trace_file_name, record_size);
+      fclose(in);
+      return kFailure;
+    }
+    begin = kBinaryTraceHeaderSize;
+  }
+
+  BufferTracker tracker(result);
+  bool eof = false;
+  while (true) {
+    size_t size = used - begin;
+    size_t done = record_size > 0
+        ? TrackRecords(buffer.data() + begin, size, record_size, &tracker)
+        : TrackText(buffer.data() + begin, size, eof, &tracker);
+    if (eof) break;
+    // The partial line or record at the end moves to the front
+    memmove(buffer.data(), buffer.data() + begin + done, size - done);
+    used = size - done;
+    begin = 0;
+    if (used == buffer.size()) {
+      fprintf(stderr, "%s has a line longer than %zu bytes\n",
+              trace_file_name, buffer.size());
+      fclose(in);
+      return kFailure;
+    }
+    size_t got = fread(buffer.data() + used, 1, buffer.size() - used, in);
+    // One more round for a last line without a newline
+    if (got == 0) eof = true;
+    used += got;
+  }
+  bool failed = ferror(in) != 0;
+  fclose(in);
+  if (failed) {
+    fprintf(stderr, "Failed to read %s\n", trace_file_name);
+    return kFailure;
+  }
+  for (size_t u = 0; u < result->units.size(); u++) {
+    result->total.Add(result->units[u]);
+  }
+  return kSuccess;
+}
+
+// "<accesses> (hit x% miss x% conflict x% switch x%)" of kind
+static std::string FormatBufferCounts(const BufferCounts& counts,
+                                      BufferKind kind) {
+  uint64_t total = counts.Total(kind);
+  char text[160];
+  if (total == 0) return "0";
+  const uint64_t* a = counts.accesses[kind];
+  snprintf(text, sizeof(text),
+           "%llu (hit %.1f%% miss %.1f%% conflict %.1f%% switch %.1f%%)",
+           (unsigned long long)total, 100.0 * a[kBufferHit] / total,
+           100.0 * a[kBufferMiss] / total, 100.0 * a[kBufferConflict] / total,
+           100.0 * a[kBufferSwitch] / total);
+  return text;
+}
+
+void PrintBufferLocality(const char* name, const BufferLocality& locality,
+                         bool per_unit) {
+  const BufferCounts& total = locality.total;
+  uint64_t switches = total.accesses[kRowBuffer][kBufferSwitch]
+                      + total.accesses[kColumnBuffer][kBufferSwitch];
+  printf("%s: %llu accesses, %llu row/column mode switches\n", name,
+         (unsigned long long)(total.Total(kRowBuffer)
+                              + total.Total(kColumnBuffer)),
+         (unsigned long long)switches);
+  printf("  row buffers (R/W)    %s\n",
+         FormatBufferCounts(total, kRowBuffer).c_str());
+  printf("  column buffers (r/w) %s\n",
+         FormatBufferCounts(total, kColumnBuffer).c_str());
+  if (!per_unit) return;
+  int bank_bit = GetDeviceGeometry().bank_bit;
+  for (size_t u = 0; u < locality.units.size(); u++) {
+    const BufferCounts& counts = locality.units[u];
+    if (counts.Total(kRowBuffer) + counts.Total(kColumnBuffer) == 0) continue;
+    printf("  channel %d bank %d: R/W %s, r/w %s\n", (int)(u >> bank_bit),
+           (int)(u & ((1 << bank_bit) - 1)),
+           FormatBufferCounts(counts, kRowBuffer).c_str(),
+           FormatBufferCounts(counts, kColumnBuffer).c_str());
+  }
+}
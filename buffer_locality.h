@@ -0,0 +1,66 @@
+/*
+ * buffer_locality.h
+ *
+ * Row and column buffer locality of a trace, to tell whether it is worth a
+ * simulator run before it gets one. Every cache line access is decoded with
+ * the selected device geometry into its bank and channel and the buffer it
+ * needs: a row buffer for 'R' and 'W', a column buffer for 'r' and 'w'. A
+ * bank keeps the one buffer it opened last, and the access either hits it,
+ * finds the bank closed, conflicts with another buffer of the same kind, or
+ * switches the bank between row and column mode.
+ */
+
+#ifndef BUFFER_LOCALITY_H_
+#define BUFFER_LOCALITY_H_
+
+#include <stdint.h>
+#include <vector>
+
+enum BufferOutcome {
+  kBufferHit,       // the buffer is open
+  kBufferMiss,      // nothing is open in the bank yet
+  kBufferConflict,  // another buffer of the same kind is open
+  kBufferSwitch,    // a buffer of the other kind is open
+  kNumBufferOutcomes,
+};
+
+enum BufferKind {
+  kRowBuffer,     // 'R' and 'W'
+  kColumnBuffer,  // 'r' and 'w'
+  kNumBufferKinds,
+};
+
+// Kind of buffer the access op at addr needs, with the unit of its bank and
+// channel (channel << bank_bit | bank) and the buffer within the bank: a row
+// segment of row_buffer_size cells of a row, or a column segment of
+// column_buffer_size cells of a column
+BufferKind DecodeBufferAccess(char op, uint64_t addr, int* unit,
+                              uint64_t* buffer);
+// Bank and channel units of the selected geometry
+int NumBufferUnits();
+
+struct BufferCounts {
+  uint64_t accesses[kNumBufferKinds][kNumBufferOutcomes];
+
+  uint64_t Total(BufferKind kind) const;
+  void Add(const BufferCounts& other);
+};
+
+// Counts of a trace, per unit and over all of them
+struct BufferLocality {
+  std::vector<BufferCounts> units;
+  BufferCounts total;
+};
+
+// Streams the text or binary trace in trace_file_name, one block at a time,
+// into *result. Compressed traces have to be decompressed first. Returns
+// kFailure if the file cannot be read or is not a trace.
+int AnalyzeBufferLocality(const char* trace_file_name,
+                          BufferLocality* result);
+
+// Prints the counts of name, with a line per unit that has accesses if
+// per_unit
+void PrintBufferLocality(const char* name, const BufferLocality& locality,
+                         bool per_unit);
+
+#endif /* BUFFER_LOCALITY_H_ */
@@ -0,0 +1,270 @@
+/*
+ * cache_filter.cc
+ */
+
+#include "cache_filter.h"
+#include "gen_trace.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static CacheConfig g_cache_config = kDefaultCacheConfig;
+static bool g_cache_filter = false;
+
+void SetCacheConfig(const CacheConfig& config) {
+  g_cache_config = config;
+  g_cache_filter = true;
+}
+
+const CacheConfig* GetCacheConfig() {
+  return g_cache_filter ? &g_cache_config : NULL;
+}
+
+static bool IsPowerOfTwo(int64_t n) {
+  return n > 0 && (n & (n - 1)) == 0;
+}
+
+// Parses "<size>[k|m]:<ways>[:lru|:rrip]" at p into *level, returns the end
+// of it or NULL
+static const char* ParseCacheLevel(const char* p, CacheLevel* level) {
+  char* end;
+  long long size = strtoll(p, &end, 10);
+  if (end == p || size <= 0) return NULL;
+  if (*end == 'k') {
+    size <<= 10;
+    end++;
+  } else if (*end == 'm') {
+    size <<= 20;
+    end++;
+  }
+  if (*end != ':') return NULL;
+  p = end + 1;
+  long ways = strtol(p, &end, 10);
+  if (end == p || ways < 1 || ways > 64) return NULL;
+  p = end;
+  level->size = size;
+  level->ways = (int)ways;
+  level->replacement = kReplaceLRU;
+  if (strncmp(p, ":lru", 4) == 0) {
+    p += 4;
+  } else if (strncmp(p, ":rrip", 5) == 0) {
+    level->replacement = kReplaceRRIP;
+    p += 5;
+  }
+  if (size % ((int64_t)kCachelineSize * ways) != 0
+      || !IsPowerOfTwo(size / kCachelineSize / ways)) {
+    return NULL;
+  }
+  return p;
+}
+
+int ParseCacheConfig(const char* name, CacheConfig* config) {
+  if (strcmp(name, "default") == 0) {
+    *config = kDefaultCacheConfig;
+    return kSuccess;
+  }
+  CacheConfig result = {0, {}};
+  const char* p = name;
+  while (true) {
+    if (result.num_levels == kMaxCacheLevels) return kFailure;
+    p = ParseCacheLevel(p, &result.levels[result.num_levels++]);
+    if (p == NULL) return kFailure;
+    if (*p == '\0') break;
+    if (*p++ != ',') return kFailure;
+  }
+  *config = result;
+  return kSuccess;
+}
+
+std::string CacheConfigName(const CacheConfig& config) {
+  std::string name;
+  for (int l = 0; l < config.num_levels; l++) {
+    const CacheLevel& level = config.levels[l];
+    char size[32];
+    if (level.size % (1 << 20) == 0) {
+      snprintf(size, sizeof(size), "%lldm", (long long)(level.size >> 20));
+    } else if (level.size % (1 << 10) == 0) {
+      snprintf(size, sizeof(size), "%lldk", (long long)(level.size >> 10));
+    } else {
+      snprintf(size, sizeof(size), "%lld", (long long)level.size);
+    }
+    name += (l > 0 ? "," : "") + std::string(size) + ":"
+            + std::to_string(level.ways)
+            + (level.replacement == kReplaceLRU ? ":lru" : ":rrip");
+  }
+  return name;
+}
+
+// Re-reference predictions of RRIP: a hit predicts a near one, a fill a long
+// one, and only lines predicted distant are evicted
+static const uint8_t kRRIPNear = 0;
+static const uint8_t kRRIPLong = 2;
+static const uint8_t kRRIPDistant = 3;
+
+SetAssocCache::SetAssocCache(const CacheLevel& level)
+    : replacement_(level.replacement), num_ways_(level.ways),
+      set_mask_((uint64_t)(level.size / kCachelineSize / level.ways) - 1),
+      clock_(0) {
+  Way empty = {0, 0, 0, 0, 0, 0};
+  ways_.resize((set_mask_ + 1) * num_ways_, empty);
+}
+
+bool SetAssocCache::Lookup(uint64_t line, bool write) {
+  Way* set = SetOf(line);
+  for (int w = 0; w < num_ways_; w++) {
+    Way& way = set[w];
+    if (!way.valid || way.line != line) continue;
+    way.last_use = ++clock_;
+    way.rrpv = kRRIPNear;
+    if (write) way.dirty = 1;
+    return true;
+  }
+  return false;
+}
+
+SetAssocCache::Way* SetAssocCache::Victim(Way* set) {
+  for (int w = 0; w < num_ways_; w++) {
+    if (!set[w].valid) return &set[w];
+  }
+  if (replacement_ == kReplaceLRU) {
+    Way* victim = &set[0];
+    for (int w = 1; w < num_ways_; w++) {
+      if (set[w].last_use < victim->last_use) victim = &set[w];
+    }
+    return victim;
+  }
+  // Age the set until a line is predicted distant
+  while (true) {
+    for (int w = 0; w < num_ways_; w++) {
+      if (set[w].rrpv >= kRRIPDistant) return &set[w];
+    }
+    for (int w = 0; w < num_ways_; w++) set[w].rrpv++;
+  }
+}
+
+bool SetAssocCache::Fill(uint64_t line, bool dirty, int op_width,
+                         uint64_t* victim, int* victim_width,
+                         bool* victim_dirty) {
+  Way* way = Victim(SetOf(line));
+  bool evicts = way->valid;
+  if (evicts) {
+    *victim = way->line;
+    *victim_width = way->op_width;
+    *victim_dirty = way->dirty;
+  }
+  way->line = line;
+  way->last_use = ++clock_;
+  way->valid = 1;
+  way->dirty = dirty;
+  way->rrpv = kRRIPLong;
+  way->op_width = (uint8_t)op_width;
+  return evicts;
+}
+
+// Lines of the caches are cache line numbers, with the top bit set for
+// column lines
+static const uint64_t kColumnLine = 1ull << 63;
+
+static inline CacheMiss LineMiss(char row_op, uint64_t line, int op_width,
+                                 int thread_id) {
+  bool column = (line & kColumnLine) != 0;
+  CacheMiss miss = {column ? (char)(row_op - 'A' + 'a') : row_op,
+                    (line & ~kColumnLine) * kCachelineSize, op_width,
+                    thread_id};
+  return miss;
+}
+
+void SetAssocCache::Clean(int thread_id, std::unordered_set<uint64_t>* done,
+                          std::vector<CacheMiss>* out) {
+  for (size_t w = 0; w < ways_.size(); w++) {
+    Way& way = ways_[w];
+    if (!way.valid || !way.dirty) continue;
+    way.dirty = 0;
+    if (done->insert(way.line).second) {
+      out->push_back(LineMiss('W', way.line, way.op_width, thread_id));
+    }
+  }
+}
+
+CacheHierarchy::CacheHierarchy(const CacheConfig& config)
+    : config_(config), shared_(config.levels[config.num_levels - 1]) {
+  memset(&stats_, 0, sizeof(stats_));
+}
+
+void CacheHierarchy::WriteBack(SetAssocCache** path, int level,
+                               uint64_t line, int op_width, int thread_id,
+                               CacheMiss* out, int* num_out) {
+  if (level == config_.num_levels) {
+    assert(*num_out < kMaxCacheMisses);
+    out[(*num_out)++] = LineMiss('W', line, op_width, thread_id);
+    ++stats_.num_writebacks;
+    return;
+  }
+  if (path[level]->Lookup(line, true)) return;
+  Install(path, level, line, true, op_width, thread_id, out, num_out);
+}
+
+void CacheHierarchy::Install(SetAssocCache** path, int level, uint64_t line,
+                             bool dirty, int op_width, int thread_id,
+                             CacheMiss* out, int* num_out) {
+  uint64_t victim;
+  int victim_width;
+  bool victim_dirty;
+  if (path[level]->Fill(line, dirty, op_width, &victim, &victim_width,
+                        &victim_dirty)
+      && victim_dirty) {
+    WriteBack(path, level + 1, victim, victim_width, thread_id, out,
+              num_out);
+  }
+}
+
+int CacheHierarchy::Access(char op, uint64_t addr, int thread_id,
+                           int op_width, CacheMiss* out) {
+  bool write = op == 'W' || op == 'w';
+  bool column = op == 'r' || op == 'w';
+  uint64_t line = addr / kCachelineSize | (column ? kColumnLine : 0);
+  ++stats_.num_accesses;
+
+  int num_levels = config_.num_levels;
+  if ((size_t)thread_id >= private_.size()) private_.resize(thread_id + 1);
+  std::vector<SetAssocCache>& caches = private_[thread_id];
+  if (caches.empty()) {
+    for (int l = 0; l + 1 < num_levels; l++) {
+      caches.push_back(SetAssocCache(config_.levels[l]));
+    }
+  }
+  SetAssocCache* path[kMaxCacheLevels];
+  for (int l = 0; l + 1 < num_levels; l++) path[l] = &caches[l];
+  path[num_levels - 1] = &shared_;
+
+  // Only the first level sees the write; the others get the line when it
+  // is written back
+  int hit = 0;
+  while (hit < num_levels && !path[hit]->Lookup(line, write && hit == 0)) {
+    hit++;
+  }
+  int num_out = 0;
+  if (hit == num_levels) {
+    out[num_out++] = LineMiss('R', line, op_width, thread_id);
+    ++stats_.num_fills;
+  }
+  for (int l = hit - 1; l >= 0; l--) {
+    Install(path, l, line, write && l == 0, op_width, thread_id, out,
+            &num_out);
+  }
+  return num_out;
+}
+
+void CacheHierarchy::Drain(std::vector<CacheMiss>* out) {
+  // The levels closer to the core hold the newer data of a line
+  size_t first = out->size();
+  std::unordered_set<uint64_t> done;
+  for (int l = 0; l + 1 < config_.num_levels; l++) {
+    for (size_t t = 0; t < private_.size(); t++) {
+      if (!private_[t].empty()) private_[t][l].Clean((int)t, &done, out);
+    }
+  }
+  shared_.Clean(0, &done, out);
+  stats_.num_writebacks += out->size() - first;
+}
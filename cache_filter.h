@@ -0,0 +1,143 @@
+/*
+ * cache_filter.h
+ *
+ * Cache hierarchy between the generators and the trace file, so that a trace
+ * holds what the memory controller sees instead of every cache line the
+ * query touches. The levels but the last are private to the thread of an
+ * access (its ThreadID), the last is shared; all of them are set-associative,
+ * write-back and write-allocate, and neither inclusive nor exclusive. Only
+ * the fills of misses in the last level and the write-backs of dirty lines
+ * it evicts reach the trace, and at its end the write-backs of the dirty
+ * lines left, so that every write of the generator gets to memory.
+ *
+ * Row and column accesses of RC-NVM cache the line in their own orientation:
+ * a row line and a column line sharing a cell are two lines, and a write to
+ * one of them leaves the other as it is. The private levels of the threads
+ * are not kept coherent either.
+ */
+
+#ifndef CACHE_FILTER_H_
+#define CACHE_FILTER_H_
+
+#include <stdint.h>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+enum CacheReplacement {
+  kReplaceLRU,
+  kReplaceRRIP,  // static RRIP with 2-bit re-reference predictions
+};
+
+struct CacheLevel {
+  int64_t size;  // bytes
+  int ways;
+  CacheReplacement replacement;
+};
+
+const int kMaxCacheLevels = 3;
+
+struct CacheConfig {
+  int num_levels;
+  CacheLevel levels[kMaxCacheLevels];  // from the core out
+};
+
+const CacheConfig kDefaultCacheConfig = {
+  3,
+  {{32 << 10, 8, kReplaceLRU},
+   {256 << 10, 8, kReplaceLRU},
+   {8 << 20, 16, kReplaceRRIP}},
+};
+
+// Caches of the traces, selected once from main; without them the traces
+// hold every access of the generators
+void SetCacheConfig(const CacheConfig& config);
+const CacheConfig* GetCacheConfig();
+// "default" or up to kMaxCacheLevels comma-separated levels
+// "<size>[k|m]:<ways>[:lru|:rrip]", LRU unless they say, whose number of sets
+// is a power of two; returns kFailure for anything else
+int ParseCacheConfig(const char* name, CacheConfig* config);
+std::string CacheConfigName(const CacheConfig& config);
+
+// Access of the hierarchy to memory
+struct CacheMiss {
+  char op;  // 'R' or 'r' for a fill, 'W' or 'w' for a write-back
+  uint64_t addr;
+  int op_width;
+  int thread_id;
+};
+
+// Upper bound of the memory accesses of one access of the hierarchy
+const int kMaxCacheMisses = 16;
+
+// What went through a hierarchy
+struct CacheStats {
+  uint64_t num_accesses;
+  uint64_t num_fills;
+  uint64_t num_writebacks;
+};
+
+// A set-associative cache of lines
+class SetAssocCache {
+ public:
+  explicit SetAssocCache(const CacheLevel& level);
+
+  // Whether line is cached; a hit counts as a use, and with write the line
+  // becomes dirty
+  bool Lookup(uint64_t line, bool write);
+  // Caches line, which is not cached yet. Returns true if that evicts a
+  // valid line, which goes to *victim with its width and dirtiness.
+  bool Fill(uint64_t line, bool dirty, int op_width, uint64_t* victim,
+            int* victim_width, bool* victim_dirty);
+  // Cleans the dirty lines and adds those not in done to out as write-backs
+  // of thread, and to done
+  void Clean(int thread_id, std::unordered_set<uint64_t>* done,
+             std::vector<CacheMiss>* out);
+
+ private:
+  struct Way {
+    uint64_t line;
+    uint64_t last_use;  // kReplaceLRU
+    uint8_t valid;
+    uint8_t dirty;
+    uint8_t rrpv;       // kReplaceRRIP
+    uint8_t op_width;
+  };
+
+  Way* SetOf(uint64_t line) { return &ways_[(line & set_mask_) * num_ways_]; }
+  Way* Victim(Way* set);
+
+  CacheReplacement replacement_;
+  int num_ways_;
+  uint64_t set_mask_;
+  uint64_t clock_;
+  std::vector<Way> ways_;
+};
+
+// The caches of config for the threads of a trace
+class CacheHierarchy {
+ public:
+  explicit CacheHierarchy(const CacheConfig& config);
+
+  // Runs the access of thread through the caches and stores the memory
+  // accesses it takes in out, fills first. Returns their number.
+  int Access(char op, uint64_t addr, int thread_id, int op_width,
+             CacheMiss* out);
+  // Adds the write-backs of every dirty line to out, once per line
+  void Drain(std::vector<CacheMiss>* out);
+
+  const CacheStats& stats() const { return stats_; }
+
+ private:
+  void Install(SetAssocCache** path, int level, uint64_t line, bool dirty,
+               int op_width, int thread_id, CacheMiss* out, int* num_out);
+  void WriteBack(SetAssocCache** path, int level, uint64_t line,
+                 int op_width, int thread_id, CacheMiss* out, int* num_out);
+
+  CacheConfig config_;
+  std::vector<std::vector<SetAssocCache> > private_;  // per thread
+  SetAssocCache shared_;                              // the last level
+  CacheStats stats_;
+};
+
+#endif /* CACHE_FILTER_H_ */
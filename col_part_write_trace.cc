@@ -27,22 +27,23 @@
 //|         |         |         | Tuple N |
 //+---------+---------+---------+---------+
 // Assume Tuple 1 is in Column 0
-int GenColTrace_3(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
+int GenColTrace_3(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenColTrace_3 is running, Sequential Column Read.\n");
   // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
+  TraceWriter *fp = OpenTraceWriter(trace_file_name);
   if (fp == NULL) return kFailure;
 
   const char *read_op = "w";
   const char *op = read_op;
 
   // Count how many cache tuples in 1 2D-NVM row
-  int tuple_in_one_row = (kRowBufferSize * kCellSize) / tuple_size;
-  int temp = num_tuples
+  int tuple_in_one_row = (GetDeviceGeometry().row_buffer_size * kCellSize)
+      / tuple_size;
+  int64_t temp = num_tuples
       / (tuple_in_one_row * kCachelineSize / kCellSize);
-  int remain = num_tuples % (tuple_in_one_row * kCachelineSize / kCellSize);
-  int num_traces = temp * tuple_in_one_row * 2;
+  int64_t remain = num_tuples % (tuple_in_one_row * kCachelineSize / kCellSize);
+  int64_t num_traces = temp * tuple_in_one_row * 2;
   if (remain < tuple_in_one_row)
     num_traces += remain * 2;
   else
@@ -50,10 +51,11 @@ int GenColTrace_3(const char* trace_file_name, int num_tuples, int tuple_size,
 
   // Column access by cache lines
   // read trace_total cache lines
-  uint32_t base_curr_addr_cacheline = GetCacheLineAddr(base_col_addr);
-  printf("Base column address: 0x%08x\n", base_curr_addr_cacheline);
+  uint64_t base_curr_addr_cacheline = GetCacheLineAddr(base_col_addr);
+  printf("Base column address: 0x%08llx\n",
+         (unsigned long long)base_curr_addr_cacheline);
 
-  uint32_t curr_addr = base_curr_addr_cacheline;
+  uint64_t curr_addr = base_curr_addr_cacheline;
   Address addr = {};
   ParseColAddr(curr_addr, addr);
   // Calculate the column address of the f3 and f10 elements in the first row
@@ -62,7 +64,7 @@ int GenColTrace_3(const char* trace_file_name, int num_tuples, int tuple_size,
   Address f10_addr = addr;
   f10_addr.column = addr.column + offsetof(IMDBRow, f10) / kCellSize;
 
-  for (int i = 0; i < num_traces; i += 2 * tuple_in_one_row) {
+  for (int64_t i = 0; i < num_traces; i += 2 * tuple_in_one_row) {
     f3_addr = addr;
     f10_addr = addr;
     for (int j = 0; j < tuple_in_one_row && i + 2 * j  < num_traces; j++) {
@@ -81,18 +83,17 @@ int GenColTrace_3(const char* trace_file_name, int num_tuples, int tuple_size,
               f10_addr.channel, f10_addr.lowrow, f10_addr.column,
               f10_addr.intrabus);
 #else
-      cprintf(fp, "%d %s 0x%08x 0 1\n", i + 2 * j, op, GenColAddr(f3_addr));
-      cprintf(fp, "%d %s 0x%08x 0 1\n", i + 2 * j + 1, op,
-              GenColAddr(f10_addr));
+      cprintf(fp, i + 2 * j, op, GenColAddr(f3_addr), 1);
+      cprintf(fp, i + 2 * j + 1, op,
+              GenColAddr(f10_addr), 1);
 #endif
     }
     // Increment rows by a cache line
     curr_addr += kCachelineSize;
     ParseColAddr(curr_addr, addr);
   }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  printf("Total number of traces: %lld\n", (long long)num_traces);
+  return CloseTraceWriter(fp);
 }
 
 // Layout 2
@@ -109,25 +110,25 @@ int GenColTrace_3(const char* trace_file_name, int num_tuples, int tuple_size,
 //+---------+---------+--+---------+
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
-int GenColTrace_4(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
+int GenColTrace_4(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenColTrace_4 is running\n");
-  FILE *fp = fopen(trace_file_name, "w");
+  TraceWriter *fp = OpenTraceWriter(trace_file_name);
   if (fp == NULL) return kFailure;
 
   const char *read_op = "w";
   const char *op = read_op;
 
-  int num_traces = 0;
+  int64_t num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
+  uint64_t curr_col_addr = base_col_addr;
   Address addr = {};
   Address f3_addr = {}, f10_addr = {};
 
-  for(int i = 0; i < num_tuples; i += kCachelineSize / kCellSize) {
+  for(int64_t i = 0; i < num_tuples; i += kCachelineSize / kCellSize) {
     curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
     ParseColAddr(curr_col_addr, addr);
     // Calculate the column address of the f3 and f10 elements
@@ -144,12 +145,11 @@ int GenColTrace_4(const char* trace_file_name, int num_tuples, int tuple_size,
             f10_addr.channel, f10_addr.lowrow, f10_addr.column,
             f10_addr.intrabus);
 #else
-    cprintf(fp, "%d %s 0x%08x 0 1\n", num_traces++, op, GenColAddr(f3_addr));
-    cprintf(fp, "%d %s 0x%08x 0 1\n", num_traces++, op, GenColAddr(f10_addr));
+    cprintf(fp, num_traces++, op, GenColAddr(f3_addr), 1);
+    cprintf(fp, num_traces++, op, GenColAddr(f10_addr), 1);
 #endif
   }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  printf("Total number of traces: %lld\n", (long long)num_traces);
+  return CloseTraceWriter(fp);
 }
 
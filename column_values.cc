@@ -0,0 +1,222 @@
+/*
+ * column_values.cc
+ */
+
+#include "column_values.h"
+#include "gen_trace.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// Prime multiplier that spreads the Zipf ranks over the domain; while it is
+// coprime to the domain no two ranks share a value
+static const int64_t kZipfScatter = 7919;
+
+ColumnValues::ColumnValues(const ValueDistribution& distribution,
+                           int64_t num_tuples, int64_t domain)
+    : distribution_(distribution), num_tuples_(num_tuples), domain_(domain),
+      zipf_scatter_(domain % kZipfScatter == 0 ? 1 : kZipfScatter) {
+  assert(domain > 0 && domain <= (1ll << 32));
+  if (distribution.kind != kValuesZipf) return;
+  double sum = 0;
+  zipf_cdf_.resize(domain);
+  for (int64_t rank = 0; rank < domain; rank++) {
+    sum += 1.0 / pow((double)(rank + 1), distribution.param);
+    zipf_cdf_[rank] = sum;
+  }
+  for (int64_t rank = 0; rank < domain; rank++) zipf_cdf_[rank] /= sum;
+}
+
+int64_t ColumnValues::ZipfValue(uint64_t hash) const {
+  double u = (double)(hash >> 11) / 9007199254740992.0;  // 2^53
+  int64_t rank = std::upper_bound(zipf_cdf_.begin(), zipf_cdf_.end(), u)
+      - zipf_cdf_.begin();
+  if (rank >= domain_) rank = domain_ - 1;
+  return (int64_t)((uint64_t)rank * zipf_scatter_ % domain_);
+}
+
+static ValueDistribution g_value_distribution = kPeriodicValues;
+
+void SetValueDistribution(const ValueDistribution& distribution) {
+  g_value_distribution = distribution;
+}
+
+const ValueDistribution& GetValueDistribution() {
+  return g_value_distribution;
+}
+
+// Default exponent of zipf, tuples of a run, and fraction of correlated
+// tuples unless the name says
+static const double kDefaultZipfExponent = 1.0;
+static const double kDefaultRunTuples = 64;
+static const double kDefaultCorrelation = 0.9;
+
+// Parses the number after prefix in name into *param, which keeps its value
+// when there is none
+static bool ParseValueParam(const char* name, const char* prefix,
+                            double* param) {
+  size_t len = strlen(prefix);
+  if (strncmp(name, prefix, len) != 0) return false;
+  if (name[len] == '\0') return true;
+  char* end;
+  double value = strtod(name + len, &end);
+  if (*end != '\0' || !(value >= 0) || value > 1e9) return false;
+  *param = value;
+  return true;
+}
+
+int ParseValueDistribution(const char* name, ValueDistribution* distribution) {
+  double zipf = kDefaultZipfExponent;
+  double runs = kDefaultRunTuples;
+  double correlation = kDefaultCorrelation;
+  if (strcmp(name, "periodic") == 0) {
+    *distribution = kPeriodicValues;
+  } else if (strcmp(name, "uniform") == 0) {
+    *distribution = ValueDistribution{kValuesUniform, 0};
+  } else if (strcmp(name, "sorted") == 0) {
+    *distribution = ValueDistribution{kValuesSorted, 0};
+  } else if (ParseValueParam(name, "zipf", &zipf)) {
+    *distribution = ValueDistribution{kValuesZipf, zipf};
+  } else if (ParseValueParam(name, "runs", &runs)) {
+    if (runs < 1 || runs != floor(runs)) return kFailure;
+    *distribution = ValueDistribution{kValuesRuns, runs};
+  } else if (ParseValueParam(name, "corr", &correlation)) {
+    if (correlation > 1) return kFailure;
+    *distribution = ValueDistribution{kValuesCorrelated, correlation};
+  } else {
+    return kFailure;
+  }
+  return kSuccess;
+}
+
+std::string ValueDistributionName(const ValueDistribution& distribution) {
+  char param[32];
+  snprintf(param, sizeof(param), "%g", distribution.param);
+  switch (distribution.kind) {
+    case kValuesPeriodic: return "periodic";
+    case kValuesUniform: return "uniform";
+    case kValuesZipf: return std::string("zipf") + param;
+    case kValuesSorted: return "sorted";
+    case kValuesRuns: return std::string("runs") + param;
+    case kValuesCorrelated: return std::string("corr") + param;
+  }
+  return "?";
+}
+
+void ColumnValues::Fill(int column, int64_t t, int n, int32_t* values) const {
+  switch (distribution_.kind) {
+    case kValuesPeriodic: {
+      int64_t r = t % 10;
+      for (int i = 0; i < n; i++) {
+        values[i] = (int32_t)(r * (domain_ / 10));
+        if (++r == 10) r = 0;
+      }
+      break;
+    }
+    case kValuesUniform:
+      for (int i = 0; i < n; i++) {
+        values[i] = (int32_t)UniformValue(ValueHash(column, t + i), domain_);
+      }
+      break;
+    default:
+      for (int i = 0; i < n; i++) values[i] = (int32_t)Value(column, t + i);
+      break;
+  }
+}
+
+static bool g_predicate_avx2 = false;
+
+uint64_t MatchAtLeastScalar(const int32_t* values, int n, int32_t constant) {
+  uint64_t bits = 0;
+  for (int i = 0; i < n; i++) {
+    bits |= (uint64_t)(values[i] >= constant) << i;
+  }
+  return bits;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("avx2")))
+uint64_t MatchAtLeastAVX2(const int32_t* values, int n, int32_t constant) {
+  // values >= constant is values > constant - 1; a compare of 8 lanes gives
+  // 8 bits through the sign bits of the lanes
+  __m256i bound = _mm256_set1_epi32(constant - 1);
+  uint64_t bits = 0;
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i v = _mm256_loadu_si256((const __m256i*)(values + i));
+    __m256i match = _mm256_cmpgt_epi32(v, bound);
+    bits |= (uint64_t)(uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(match))
+            << i;
+  }
+  if (i < n) bits |= MatchAtLeastScalar(values + i, n - i, constant) << i;
+  return bits;
+}
+
+static bool CPUSupportsAVX2() {
+  return __builtin_cpu_supports("avx2");
+}
+#else
+uint64_t MatchAtLeastAVX2(const int32_t* values, int n, int32_t constant) {
+  return MatchAtLeastScalar(values, n, constant);
+}
+
+static bool CPUSupportsAVX2() {
+  return false;
+}
+#endif
+
+uint64_t MatchAtLeast(const int32_t* values, int n, int32_t constant) {
+  return g_predicate_avx2 ? MatchAtLeastAVX2(values, n, constant)
+                          : MatchAtLeastScalar(values, n, constant);
+}
+
+void SelectPredicateEvaluator() {
+  g_predicate_avx2 = CPUSupportsAVX2();
+}
+
+bool PredicateUsesAVX2() {
+  return g_predicate_avx2;
+}
+
+static double TimeMatch(const std::vector<int32_t>& values,
+                        uint64_t (*match)(const int32_t*, int, int32_t),
+                        uint64_t* sum) {
+  uint64_t start = gettimestamp_ns();
+  uint64_t s = 0;
+  for (size_t i = 0; i + 64 <= values.size(); i += 64) {
+    s += __builtin_popcountll(match(&values[i], 64, kValueDomain / 2));
+  }
+  *sum = s;
+  return (double)(gettimestamp_ns() - start) / values.size();
+}
+
+void BenchPredicates(int num_values) {
+  ColumnValues uniform(ValueDistribution{kValuesUniform, 0}, num_values);
+  std::vector<int32_t> values(num_values);
+  for (int i = 0; i + 64 <= num_values; i += 64) {
+    uniform.Fill(0, i, 64, &values[i]);
+  }
+  for (int n = 0; n <= 64 && n <= num_values; n++) {
+    assert(!CPUSupportsAVX2()
+           || MatchAtLeastAVX2(&values[0], n, kValueDomain / 2)
+              == MatchAtLeastScalar(&values[0], n, kValueDomain / 2));
+  }
+  uint64_t scalar_sum, avx2_sum = 0;
+  double scalar_ns = TimeMatch(values, MatchAtLeastScalar, &scalar_sum);
+  printf("Predicate over %d values: scalar %.3f ns/value", num_values,
+         scalar_ns);
+  if (CPUSupportsAVX2()) {
+    double avx2_ns = TimeMatch(values, MatchAtLeastAVX2, &avx2_sum);
+    printf(", AVX2 %.3f ns/value%s", avx2_ns,
+           avx2_sum == scalar_sum ? "" : " (MISMATCH)");
+  }
+  printf(", %llu of them match, MatchAtLeast uses %s\n",
+         (unsigned long long)scalar_sum,
+         PredicateUsesAVX2() ? "AVX2" : "scalar code");
+}
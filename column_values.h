@@ -0,0 +1,123 @@
+/*
+ * column_values.h
+ *
+ * Synthetic values of the columns of a table, for the predicates of query
+ * plans to compare against. A value depends on the column and the tuple only,
+ * so a shard of the tuples sees the same values as a single-threaded run and
+ * no table is ever materialized.
+ */
+
+#ifndef COLUMN_VALUES_H_
+#define COLUMN_VALUES_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+enum ValueKind {
+  kValuesPeriodic,    // tuple t has t % 10 tenths of the domain
+  kValuesUniform,     // independent and uniform over the domain
+  kValuesZipf,        // Zipf with exponent param, hot values spread out
+  kValuesSorted,      // ascending with the tuple
+  kValuesRuns,        // runs of param tuples share a uniform value
+  kValuesCorrelated,  // a fraction param of the tuples has one uniform value
+                      // in all columns, the rest independent ones
+};
+
+struct ValueDistribution {
+  ValueKind kind;
+  double param;  // see ValueKind; 0 for the others
+};
+
+const ValueDistribution kPeriodicValues = {kValuesPeriodic, 0};
+
+// Values of the fields filters compare are in [0, kValueDomain)
+const int64_t kValueDomain = 1000;
+
+class ColumnValues {
+ public:
+  // Values in [0, domain), domain at most 2^32
+  ColumnValues(const ValueDistribution& distribution, int64_t num_tuples,
+               int64_t domain = kValueDomain);
+
+  // Value of tuple t in column, any number that tells the columns apart
+  int64_t Value(int column, int64_t t) const;
+  // Values of tuples [t, t + n) in column, for a domain that fits int32_t
+  void Fill(int column, int64_t t, int n, int32_t* values) const;
+
+ private:
+  int64_t ZipfValue(uint64_t hash) const;
+
+  ValueDistribution distribution_;
+  int64_t num_tuples_;
+  int64_t domain_;
+  int64_t zipf_scatter_;
+  std::vector<double> zipf_cdf_;  // of the ranks, domain_ entries
+};
+
+// Distribution of the columns of query plans, selected once from main;
+// tables of a schema file may override it
+void SetValueDistribution(const ValueDistribution& distribution);
+const ValueDistribution& GetValueDistribution();
+// "periodic", "uniform", "zipf[s]", "sorted", "runs[tuples]" or
+// "corr[fraction]"; returns kFailure for anything else
+int ParseValueDistribution(const char* name, ValueDistribution* distribution);
+std::string ValueDistributionName(const ValueDistribution& distribution);
+
+// Bit i of the result is set when values[i] >= constant, for n <= 64
+// values. Uses AVX2 if SelectPredicateEvaluator found the CPU has it.
+uint64_t MatchAtLeast(const int32_t* values, int n, int32_t constant);
+uint64_t MatchAtLeastScalar(const int32_t* values, int n, int32_t constant);
+uint64_t MatchAtLeastAVX2(const int32_t* values, int n, int32_t constant);
+
+// Makes MatchAtLeast use AVX2 if the CPU supports it; called from main
+void SelectPredicateEvaluator();
+bool PredicateUsesAVX2();
+// Times the predicate evaluation over num_values values and checks that the
+// two evaluators agree
+void BenchPredicates(int num_values);
+
+// splitmix64 finalizer: a bijection that spreads every input bit over the
+// output
+inline uint64_t MixBits(uint64_t x) {
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+// Uniform value in [0, domain) of a hash, domain at most 2^32
+inline int64_t UniformValue(uint64_t hash, int64_t domain) {
+  return (int64_t)(((hash >> 32) * (uint64_t)domain) >> 32);
+}
+
+inline uint64_t ValueHash(int column, int64_t t) {
+  return MixBits(MixBits((uint64_t)column + 0x9e3779b97f4a7c15ull)
+                 ^ (uint64_t)t);
+}
+
+inline int64_t ColumnValues::Value(int column, int64_t t) const {
+  switch (distribution_.kind) {
+    case kValuesPeriodic:
+      return t % 10 * (domain_ / 10);
+    case kValuesUniform:
+      return UniformValue(ValueHash(column, t), domain_);
+    case kValuesZipf:
+      return ZipfValue(ValueHash(column, t));
+    case kValuesSorted:
+      return t * domain_ / num_tuples_;
+    case kValuesRuns:
+      return UniformValue(ValueHash(column, t / (int64_t)distribution_.param),
+                          domain_);
+    case kValuesCorrelated: {
+      // The low half of the hash picks the tuples that share their value
+      uint64_t shared = ValueHash(-1, t);
+      if ((double)(uint32_t)shared < distribution_.param * 4294967296.0) {
+        return UniformValue(shared, domain_);
+      }
+      return UniformValue(ValueHash(column, t), domain_);
+    }
+  }
+  return 0;
+}
+
+#endif /* COLUMN_VALUES_H_ */
@@ -0,0 +1,99 @@
+/*
+ * cpu_model.cc
+ */
+
+#include "cpu_model.h"
+#include "gen_trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+static CpuModel g_cpu_model = kDefaultCpuModel;
+static bool g_cycle_traces = false;
+
+void SetCpuModel(const CpuModel& model) {
+  g_cpu_model = model;
+  g_cycle_traces = true;
+}
+
+const CpuModel* GetCpuModel() {
+  return g_cycle_traces ? &g_cpu_model : NULL;
+}
+
+int ParseCpuModel(const char* name, CpuModel* model) {
+  CpuModel result = kDefaultCpuModel;
+  if (strcmp(name, "default") == 0) {
+    *model = result;
+    return kSuccess;
+  }
+  const char* p = name;
+  while (*p != '\0') {
+    const char* eq = strchr(p, '=');
+    if (eq == NULL) return kFailure;
+    std::string key(p, eq - p);
+    char* end;
+    long value = strtol(eq + 1, &end, 10);
+    if (end == eq + 1 || value < 0 || value > 1 << 20) return kFailure;
+    if (key == "pred") {
+      result.predicate_cycles = (int)value;
+    } else if (key == "agg") {
+      result.aggregate_cycles = (int)value;
+    } else if (key == "mat") {
+      result.materialize_cycles = (int)value;
+    } else if (key == "issue") {
+      result.issue_cycles = (int)value;
+    } else if (key == "mlp" && value >= 1) {
+      result.max_misses = (int)value;
+    } else if (key == "lat") {
+      result.miss_latency = (int)value;
+    } else {
+      return kFailure;
+    }
+    p = end;
+    if (*p == ',') {
+      p++;
+    } else if (*p != '\0') {
+      return kFailure;
+    }
+  }
+  *model = result;
+  return kSuccess;
+}
+
+std::string CpuModelName(const CpuModel& model) {
+  char name[128];
+  snprintf(name, sizeof(name), "pred=%d,agg=%d,mat=%d,issue=%d,mlp=%d,lat=%d",
+           model.predicate_cycles, model.aggregate_cycles,
+           model.materialize_cycles, model.issue_cycles, model.max_misses,
+           model.miss_latency);
+  return name;
+}
+
+CycleClock::CycleClock(const CpuModel& model) : model_(model) {
+}
+
+CycleClock::Core& CycleClock::GetCore(int thread_id) {
+  if ((size_t)thread_id >= cores_.size()) {
+    Core core = {0, 0, std::vector<int64_t>(model_.max_misses, 0), 0};
+    cores_.resize(thread_id + 1, core);
+  }
+  return cores_[thread_id];
+}
+
+void CycleClock::Compute(int thread_id, int64_t cycles, bool wait) {
+  Core& core = GetCore(thread_id);
+  if (wait) core.cycle = std::max(core.cycle, core.last_done);
+  core.cycle += cycles;
+}
+
+int64_t CycleClock::Issue(int thread_id) {
+  Core& core = GetCore(thread_id);
+  // The oldest of max_misses outstanding accesses has to complete first
+  int64_t issue = std::max(core.cycle, core.done[core.oldest]);
+  core.last_done = issue + model_.miss_latency;
+  core.done[core.oldest] = core.last_done;
+  core.oldest = (core.oldest + 1) % core.done.size();
+  core.cycle = issue + model_.issue_cycles;
+  return issue;
+}
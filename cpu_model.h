@@ -0,0 +1,74 @@
+/*
+ * cpu_model.h
+ *
+ * Issue cycles of the accesses of a trace, for the simulator to replay them
+ * with the compute of the core in between instead of back to back. The query
+ * plans charge their work per operator: predicate terms, aggregated fields
+ * and materialized rows. Every access then issues once the core has done the
+ * work before it, and once fewer than max_misses accesses of its thread are
+ * outstanding; work that needs the data of an access waits until it
+ * completes, miss_latency cycles after its issue. Each logical thread of a
+ * trace (see trace_threads.h) is a core of its own.
+ *
+ * The cycles go to a sidecar file next to the trace, "<trace>.cycles", one
+ * line "<access> <cycle>" per cache line access, where access is the counter
+ * the trace numbers the NVMain lines of the access with (line = access * 8).
+ */
+
+#ifndef CPU_MODEL_H_
+#define CPU_MODEL_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+struct CpuModel {
+  int predicate_cycles;    // per predicate term and tuple, or key compared
+  int aggregate_cycles;    // per aggregated field of a kept tuple
+  int materialize_cycles;  // per fetched row of a kept tuple
+  int issue_cycles;        // per access
+  int max_misses;          // outstanding accesses per thread
+  int miss_latency;        // cycles from the issue of an access to its data
+};
+
+const CpuModel kDefaultCpuModel = {2, 4, 16, 1, 10, 200};
+
+// Model of the cycle traces, selected once from main; without one no
+// sidecar files are written
+void SetCpuModel(const CpuModel& model);
+const CpuModel* GetCpuModel();
+// "default" or a comma-separated list of "<key>=<cycles>" with the keys
+// pred, agg, mat, issue, mlp and lat, the others as in kDefaultCpuModel;
+// returns kFailure for anything else
+int ParseCpuModel(const char* name, CpuModel* model);
+std::string CpuModelName(const CpuModel& model);
+
+// Suffix of the sidecar file of a trace
+const char kCyclesSuffix[] = ".cycles";
+
+// Issue cycles of the accesses of the threads of a trace, in trace order
+class CycleClock {
+ public:
+  explicit CycleClock(const CpuModel& model);
+
+  // Work of cycles on thread before its next access. With wait the work
+  // needs the data of the last access of the thread and starts once it is in.
+  void Compute(int thread_id, int64_t cycles, bool wait);
+  // Issue cycle of the next access of thread
+  int64_t Issue(int thread_id);
+
+ private:
+  struct Core {
+    int64_t cycle;              // the core is done with its work
+    int64_t last_done;          // the last access completes
+    std::vector<int64_t> done;  // completion of the outstanding accesses
+    size_t oldest;              // of done, a ring of max_misses
+  };
+
+  Core& GetCore(int thread_id);
+
+  CpuModel model_;
+  std::vector<Core> cores_;
+};
+
+#endif /* CPU_MODEL_H_ */
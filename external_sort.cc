@@ -0,0 +1,126 @@
+/*
+ * external_sort.cc
+ */
+
+#include "external_sort.h"
+#include <algorithm>
+#include "addr_util.h"
+
+uint64_t SortRegion::Size() const {
+  return 2 * ALIGN_SIZE((uint64_t)num_records * record_size, kCachelineSize);
+}
+
+uint64_t SortRegion::LineAddr(int area, int64_t n) const {
+  uint64_t byte = offset + area * (Size() / 2) + (uint64_t)n * record_size;
+  return GetCacheLineAddr(CalTupleRowAddr((int64_t)byte, 1, base_row_addr,
+                                          interleave));
+}
+
+// Whether record n starts or ends a line of its area; the areas start at
+// line boundaries if offset does
+static inline bool StartsLine(const SortRegion& region, int64_t n) {
+  return (uint64_t)n * region.record_size % kCachelineSize == 0;
+}
+
+static inline bool EndsLine(const SortRegion& region, int64_t n) {
+  return StartsLine(region, n + 1);
+}
+
+static inline void EmitLine(TraceWriter* fp, const char* op, uint64_t addr,
+                            int64_t num_traces) {
+#ifdef DEBUG
+  dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op,
+          addr, 0, 0, 0, 0, 0, 0);
+#else
+  cprintf(fp, num_traces, op, addr);
+#endif
+}
+
+static inline bool operator<(const SortRecord& a, const SortRecord& b) {
+  return a.key != b.key ? a.key < b.key : a.tuple < b.tuple;
+}
+
+MergeCursor::MergeCursor(const ExternalSort& sort, int first_run,
+                         int last_run)
+    : sort_(sort), first_run_(first_run),
+      pos_(sort.run_begin_.begin() + first_run,
+           sort.run_begin_.begin() + last_run) {
+  for (int k = 0; k < last_run - first_run; k++) {
+    if (pos_[k] == sort.run_begin_[first_run + k + 1]) continue;
+    heap_.push_back(Head{sort.records_[pos_[k]].key, k});
+  }
+  std::make_heap(heap_.begin(), heap_.end(), Later);
+}
+
+bool MergeCursor::Next(TraceWriter* fp, int64_t* num_traces,
+                       SortRecord* record) {
+  if (heap_.empty()) return false;
+  std::pop_heap(heap_.begin(), heap_.end(), Later);
+  int k = heap_.back().run;
+  heap_.pop_back();
+  int64_t n = pos_[k]++;
+  *record = sort_.records_[n];
+  const SortRegion& region = sort_.region_;
+  if (n == sort_.run_begin_[first_run_ + k] || StartsLine(region, n)) {
+    EmitLine(fp, "R", region.LineAddr(sort_.area_, n), (*num_traces)++);
+  }
+  if (pos_[k] < sort_.run_begin_[first_run_ + k + 1]) {
+    heap_.push_back(Head{sort_.records_[pos_[k]].key, k});
+    std::push_heap(heap_.begin(), heap_.end(), Later);
+  }
+  return true;
+}
+
+ExternalSort::ExternalSort(const SortRegion& region,
+                           std::vector<SortRecord> records,
+                           int64_t run_tuples, int fan_in)
+    : region_(region), run_tuples_(run_tuples), fan_in_(fan_in), area_(0) {
+  records_.swap(records);
+  int64_t num_records = (int64_t)records_.size();
+  for (int64_t n = 0; n < num_records; n += run_tuples) {
+    run_begin_.push_back(n);
+    std::sort(records_.begin() + n,
+              records_.begin() + std::min(n + run_tuples, num_records));
+  }
+  run_begin_.push_back(num_records);
+}
+
+bool ExternalSort::EndsRun(int64_t t) const {
+  return (t + 1) % run_tuples_ == 0 || t + 1 == region_.num_records;
+}
+
+int64_t ExternalSort::WriteRun(TraceWriter* fp, int64_t t,
+                               int64_t num_traces) const {
+  for (int64_t n = t / run_tuples_ * run_tuples_; n <= t; n++) {
+    if (EndsLine(region_, n) || n == t) {
+      EmitLine(fp, "W", region_.LineAddr(0, n), num_traces++);
+    }
+  }
+  return num_traces;
+}
+
+int64_t ExternalSort::Merge(TraceWriter* fp, int64_t num_traces) {
+  while (num_runs() > fan_in_) {
+    int area = 1 - area_;
+    std::vector<SortRecord> merged(records_.size());
+    std::vector<int64_t> run_begin;
+    int64_t n = 0;
+    for (int first = 0; first < num_runs(); first += fan_in_) {
+      int last = std::min(first + fan_in_, num_runs());
+      run_begin.push_back(n);
+      MergeCursor cursor(*this, first, last);
+      SortRecord record;
+      for (; cursor.Next(fp, &num_traces, &record); n++) {
+        merged[n] = record;
+        if (EndsLine(region_, n) || n + 1 == run_begin_[last]) {
+          EmitLine(fp, "W", region_.LineAddr(area, n), num_traces++);
+        }
+      }
+    }
+    run_begin.push_back(n);
+    records_.swap(merged);
+    run_begin_.swap(run_begin);
+    area_ = area;
+  }
+  return num_traces;
+}
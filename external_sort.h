@@ -0,0 +1,104 @@
+/*
+ * external_sort.h
+ *
+ * External merge sort of the records of a table, for the sort-merge joins of
+ * query plans. Run generation cuts the records into runs of run_tuples, sorts
+ * every run in memory and writes it out; merge passes then merge fan_in runs
+ * at a time into one until at most fan_in runs are left, which the merge join
+ * reads. The records are sorted for real, so the reads of a merge interleave
+ * over its runs the way the keys make them.
+ *
+ * The runs live in a scratch region of two areas that the passes alternate
+ * between, a record of record_size bytes each. Every access is a row cache
+ * line access: a line of a run is read ('R') when the merge takes the first
+ * record from it and written ('W') once its last record is in.
+ */
+
+#ifndef EXTERNAL_SORT_H_
+#define EXTERNAL_SORT_H_
+
+#include <stdint.h>
+#include <vector>
+#include "gen_trace.h"
+#include "trace_writer.h"
+
+struct SortRecord {
+  uint64_t key;
+  int64_t tuple;
+};
+
+// Where the runs of a sort go: two areas for num_records records each, one
+// after the other from byte offset of the space at the row address
+// base_row_addr, interleaved as tuples of a row-first table are
+struct SortRegion {
+  uint64_t base_row_addr;
+  uint64_t offset;
+  BankInterleave interleave;
+  int record_size;  // bytes, a power of two up to kCachelineSize
+  int64_t num_records;
+
+  // Bytes of the region
+  uint64_t Size() const;
+  // Row cache line of record n of area
+  uint64_t LineAddr(int area, int64_t n) const;
+};
+
+class ExternalSort;
+
+// Reads the records of a set of runs in key order, a line at a time
+class MergeCursor {
+ public:
+  MergeCursor(const ExternalSort& sort, int first_run, int last_run);
+
+  // Takes the record with the least key into *record, reading its line if it
+  // is the first record taken from it. Returns false when all runs are done.
+  bool Next(TraceWriter* fp, int64_t* num_traces, SortRecord* record);
+
+ private:
+  struct Head {
+    uint64_t key;
+    int run;
+  };
+
+  // Order of the heap: the least key on top, ties in run order
+  static bool Later(const Head& a, const Head& b) {
+    return a.key != b.key ? a.key > b.key : a.run > b.run;
+  }
+
+  const ExternalSort& sort_;
+  int first_run_;
+  std::vector<int64_t> pos_;  // next record of every run
+  std::vector<Head> heap_;    // min-heap of the runs that have records left
+};
+
+class ExternalSort {
+ public:
+  // Sorts records, record n the one of tuple n of the table, into runs
+  ExternalSort(const SortRegion& region, std::vector<SortRecord> records,
+               int64_t run_tuples, int fan_in);
+
+  // Whether tuple t of the table is the last of its run
+  bool EndsRun(int64_t t) const;
+  // Writes of the lines of the run that tuple t ends, in area 0
+  int64_t WriteRun(TraceWriter* fp, int64_t t, int64_t num_traces) const;
+
+  // Merge passes until at most fan_in runs are left
+  int64_t Merge(TraceWriter* fp, int64_t num_traces);
+
+  // The runs left, for the merge join to read
+  int num_runs() const { return (int)run_begin_.size() - 1; }
+  int fan_in() const { return fan_in_; }
+
+ private:
+  friend class MergeCursor;
+
+  SortRegion region_;
+  int64_t run_tuples_;
+  int fan_in_;
+  int area_;                         // the runs are in
+  std::vector<SortRecord> records_;  // as in area_, sorted per run
+  // Run k is the records [run_begin_[k], run_begin_[k + 1])
+  std::vector<int64_t> run_begin_;
+};
+
+#endif /* EXTERNAL_SORT_H_ */
@@ -11,36 +11,452 @@
 #include <string.h>
 #include <stddef.h>
 #include <assert.h>
+#include <limits.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "addr_util.h"
+#include "buffer_locality.h"
+#include "cache_filter.h"
+#include "cpu_model.h"
+#include "memory_timing.h"
+#include "trace_shard.h"
+#include "trace_job.h"
+#include "trace_sweep.h"
+#include "trace_check.h"
+#include "trace_compress.h"
+#include "query_plan.h"
+#include "tuple_layout.h"
+#include <deque>
+#include <string>
+#include <thread>
 
 // Cache print
-void dprintf(FILE* fp, const char* format, int n, const char* op, unsigned addr_,
-            int highrow, int bank, int channel, int lowrow, int column,
-            int intrabus) {
-    int i;
-    Address addr;
-    if (strcmp(op, "W") == 0 || strcmp(op, "R") == 0) {
-      for (i = 0; i < 8; i ++) {
-        ParseRowAddr(addr_ + 8*i, addr);
-        fprintf(fp, format, n, op,
-                addr_ + 8*i, addr.highrow, addr.bank,
-                addr.channel, addr.lowrow, addr.column, addr.intrabus);
+void dprintf(TraceWriter* fp, const char* format, int64_t n, const char* op,
+             uint64_t addr_, int highrow, int bank, int channel, int lowrow,
+             int column, int intrabus) {
+  if (fp->format() != kTraceText) {
+    // The binary format has no room for the annotation
+    cprintf(fp, n, op, addr_);
+    return;
+  }
+  int i;
+  Address addr;
+  char line[256];
+  if (strcmp(op, "W") == 0 || strcmp(op, "R") == 0) {
+    for (i = 0; i < 8; i ++) {
+      ParseRowAddr(addr_ + 8*i, addr);
+      snprintf(line, sizeof(line), format, (int)n, op,
+               (unsigned)(addr_ + 8*i), addr.highrow, addr.bank,
+               addr.channel, addr.lowrow, addr.column, addr.intrabus);
+      fp->Print(line);
+    }
+  } else {
+    for (i = 0; i < 8; i ++) {
+      ParseColAddr(addr_ + 8*i, addr);
+      snprintf(line, sizeof(line), format, (int)n, op,
+               (unsigned)(addr_ + 8*i), addr.highrow, addr.bank,
+               addr.channel, addr.lowrow, addr.column, addr.intrabus);
+      fp->Print(line);
+    }
+  }
+}
+
+void cprintf(TraceWriter* fp, int64_t n, const char* op, uint64_t addr,
+             int op_width) {
+  fp->Append(n, op[0], addr, 0, op_width);
+}
+
+// What the trace names of join queries gain under join: "hashjoin-" or
+// "merge<run_tuples>x<fan_in>join-", nothing for the tuple-by-tuple join
+static std::string JoinTraceTag(const JoinMethod& join) {
+  if (join.kind == kJoinByTuple) return "";
+  return JoinMethodName(join) + "join-";
+}
+
+static bool HasJoin(const QueryPlan& plan) {
+  for (size_t n = 0; n < plan.nodes.size(); n++) {
+    PlanOp op = plan.nodes[n].op;
+    if (op == kPlanHashJoin || op == kPlanMergeJoin) return true;
+  }
+  return false;
+}
+
+// What the trace names of GROUP BY queries gain: "g<groups>-<values>-"
+static std::string GroupTraceTag(const GroupBy& group_by) {
+  return GroupByName(group_by) + "-";
+}
+
+// What the trace names of the query traces gain under threads:
+// "t<threads>-<schedule>-<interleave>-", nothing for a single thread
+static std::string ThreadTraceTag(const TraceThreads& threads) {
+  if (threads.num_threads <= 1) return "";
+  return TraceThreadsName(threads) + "-";
+}
+
+static bool HasGroupBy(const QueryPlan& plan) {
+  for (size_t n = 0; n < plan.nodes.size(); n++) {
+    if (plan.nodes[n].op == kPlanGroupBy) return true;
+  }
+  return false;
+}
+
+// Whether a table of num_tuples tuples of tuple_size bytes from base_addr
+// fits the device; tells what to change if not
+static bool TableFits(const char* table, int64_t num_tuples, int tuple_size,
+                      uint64_t base_addr, BankInterleave interleave) {
+  if (TableFitsAddrSpace(num_tuples, tuple_size, base_addr, interleave)) {
+    return true;
+  }
+  fprintf(stderr, "%lld tuples of %s (%d bytes) from 0x%llx do not fit the "
+          "%d address bits of the device; select a larger geometry (-g) or "
+          "fewer tuples (-t)\n", (long long)num_tuples, table, tuple_size,
+          (unsigned long long)base_addr, g_addr_codec.addr_bits);
+  return false;
+}
+
+// Adds an RC-NVM and a DRAM trace job for each of queries (all OLXP queries
+// if there are none) over every table of schema_file. The trace file names
+// are kept in names. Queries reading a field a table lacks are skipped.
+static int AddSchemaJobs(const char* schema_file, char** queries,
+                         int num_queries, int64_t num_tuples,
+                         std::vector<TraceJob>* jobs,
+                         std::deque<std::string>* names) {
+  std::vector<TableSchema> schemas;
+  if (LoadSchemas(schema_file, &schemas) != kSuccess) return kFailure;
+  std::vector<int> query_list;
+  for (int i = 0; i < num_queries; i++) query_list.push_back(atoi(queries[i]));
+  for (int q = 1; num_queries == 0 && q <= kNumOLXPQueries; q++) {
+    query_list.push_back(q);
+  }
+
+  for (size_t k = 0; k < schemas.size(); k++) {
+    const TableSchema& schema = schemas[k];
+    PrintSchema(schema);
+    // Table-b of the joins is the higher one
+    if (!TableFits(schema.name.c_str(), num_tuples, schema.tuple_size,
+                   kOLXPTableBAddr, schema.interleave)) {
+      return kFailure;
+    }
+    for (size_t i = 0; i < query_list.size(); i++) {
+      int q = query_list[i];
+      QueryPlan plan(num_tuples, schema.tuple_size, kOLXPTableAAddr);
+      plan.tables[0].interleave = schema.interleave;
+      plan.layout = schema.layout;
+      plan.values = schema.values;
+      AddPlanTable(&plan, kOLXPTableBAddr, schema.interleave);
+      if (AddOLXPQuery(&plan, q, schema) != kSuccess) {
+        printf("Skip Q%d on %s, which lacks its fields\n", q,
+               schema.name.c_str());
+        continue;
       }
-    } else {
-      for (i = 0; i < 8; i ++) {
-        ParseColAddr(addr_ + 8*i, addr);
-        fprintf(fp, format, n, op,
-                addr_ + 8*i, addr.highrow, addr.bank,
-                addr.channel, addr.lowrow, addr.column, addr.intrabus);
+      if (!LayoutFits(schema.layout, schema.tuple_size)) {
+        printf("Skip Q%d on %s, whose tuples do not fit layout %s\n", q,
+               schema.name.c_str(), TableLayoutName(schema.layout).c_str());
+        continue;
+      }
+      std::string suffix = schema.name + "-qurey" + std::to_string(q) + "-"
+                           + (HasJoin(plan) ? JoinTraceTag(plan.join) : "")
+                           + (HasGroupBy(plan) ? GroupTraceTag(plan.group_by)
+                                               : "")
+                           + ThreadTraceTag(plan.threads)
+                           + TableLayoutName(schema.layout) + ".trace";
+      names->push_back("hybrid-" + suffix);
+      TRACE_JOB(*jobs, GenPlanTrace, names->back().c_str(), plan, kRCNVM);
+      names->push_back("DRAM-" + suffix);
+      TRACE_JOB(*jobs, GenPlanTrace, names->back().c_str(), plan, kDRAM);
     }
   }
+  return kSuccess;
 }
-void cprintf(FILE* fp, const char* format, int n,
-		const char* op, unsigned addr) {
-  int i = 0;
-  for (i = 0; i < 8; i ++){
-    fprintf(fp, format, n*8+i, op, addr + 8*i);
+
+// Adds a trace job for every point of spec, whose values go to points. The
+// trace file names are kept in names. Points whose query reads a field their
+// table lacks, or whose tuples do not fit their layout, are skipped.
+static int AddSweepJobs(const SweepSpec& spec, std::vector<TraceJob>* jobs,
+                        std::deque<std::string>* names,
+                        std::vector<SweepPoint>* points) {
+  // The compiled-in rows take the selected interleaving, layout and values
+  // like the tables of a schema file without lines for them
+  std::vector<TableSchema> schemas;
+  bool imdb = spec.schema_file.empty();
+  if (imdb) {
+    schemas.push_back(IMDBRowSchema());
+    schemas.push_back(IMDBOverCLRowSchema());
+    for (size_t k = 0; k < schemas.size(); k++) {
+      schemas[k].interleave = GetBankInterleave();
+      schemas[k].layout = GetTableLayout();
+      schemas[k].values = GetValueDistribution();
+    }
+  } else if (LoadSchemas(spec.schema_file.c_str(), &schemas) != kSuccess) {
+    return kFailure;
+  }
+  std::vector<int> own_selectivity(1, kSweepQuerySelectivity);
+
+  for (size_t k = 0; k < schemas.size(); k++) {
+    const TableSchema& schema = schemas[k];
+    std::vector<TableLayout> layouts = spec.layouts;
+    if (layouts.empty()) layouts.push_back(schema.layout);
+    std::vector<ValueDistribution> values = spec.values;
+    if (values.empty()) values.push_back(schema.values);
+    for (size_t t = 0; t < spec.tuples.size(); t++) {
+      for (int b = 0; b < 2; b++) {
+        if (!TableFits(schema.name.c_str(), spec.tuples[t],
+                       schema.tuple_size, spec.base_col_addrs[b],
+                       schema.interleave)) {
+          return kFailure;
+        }
+      }
+    }
+    for (size_t i = 0; i < spec.queries.size(); i++) {
+      int q = spec.queries[i];
+      // Q14 reads the wide column of IMDBOverCLRow, the others IMDBRow
+      if (imdb && (q == 14) != (k == 1)) continue;
+      QueryPlan probe(1, schema.tuple_size, 0x0u);
+      AddPlanTable(&probe, 0x0u);
+      if (AddOLXPQuery(&probe, q, schema) != kSuccess) {
+        printf("Skip Q%d on %s, which lacks its fields\n", q,
+               schema.name.c_str());
+        continue;
+      }
+      // A query without filters or joins gets one point for all
+      const std::vector<int>& selectivities =
+          spec.selectivities.empty() || !SetPlanSelectivity(&probe, 10)
+              ? own_selectivity : spec.selectivities;
+
+      // Every combination of the other dimensions, the last one fastest
+      size_t sizes[5] = {spec.tuples.size(), layouts.size(), values.size(),
+                         spec.prefetch_sizes.size(), selectivities.size()};
+      size_t num_points = 1;
+      for (int d = 0; d < 5; d++) num_points *= sizes[d];
+      for (size_t n = 0; n < num_points; n++) {
+        size_t index[5];
+        size_t rest = n;
+        for (int d = 4; d >= 0; d--) {
+          index[d] = rest % sizes[d];
+          rest /= sizes[d];
+        }
+        int64_t num_tuples = spec.tuples[index[0]];
+        const TableLayout& layout = layouts[index[1]];
+        int selectivity = selectivities[index[4]];
+        if (!LayoutFits(layout, schema.tuple_size)) {
+          if (index[0] == 0 && index[2] == 0 && index[3] == 0
+              && index[4] == 0) {
+            printf("Skip Q%d on %s, whose tuples do not fit layout %s\n", q,
+                   schema.name.c_str(), TableLayoutName(layout).c_str());
+          }
+          continue;
+        }
+
+        QueryPlan plan(num_tuples, schema.tuple_size, spec.base_col_addrs[0]);
+        plan.tables[0].interleave = schema.interleave;
+        plan.layout = layout;
+        plan.values = values[index[2]];
+        plan.prefetch_size = spec.prefetch_sizes[index[3]];
+        AddPlanTable(&plan, spec.base_col_addrs[1], schema.interleave);
+        AddOLXPQuery(&plan, q, schema);
+        if (selectivity != kSweepQuerySelectivity) {
+          SetPlanSelectivity(&plan, selectivity);
+        }
+        std::string suffix =
+            (imdb ? "" : schema.name + "-") + "qurey" + std::to_string(q)
+            + "-n" + std::to_string(num_tuples)
+            + "-p" + std::to_string(plan.prefetch_size)
+            + (selectivity != kSweepQuerySelectivity
+                   ? "-s" + std::to_string(selectivity) : "")
+            + "-" + ValueDistributionName(plan.values) + "-"
+            + (HasJoin(plan) ? JoinTraceTag(plan.join) : "")
+            + (HasGroupBy(plan) ? GroupTraceTag(plan.group_by) : "")
+            + ThreadTraceTag(plan.threads) + TableLayoutName(layout)
+            + ".trace";
+        for (size_t m = 0; m < spec.memories.size(); m++) {
+          MemoryType memory = spec.memories[m];
+          names->push_back(spec.output + "/"
+                           + (memory == kRCNVM ? "hybrid-" : "DRAM-")
+                           + suffix);
+          TRACE_JOB(*jobs, GenPlanTrace, names->back().c_str(), plan,
+                    memory);
+          SweepPoint point = {names->back(), memory, schema.name, q,
+                              num_tuples, layout, plan.values,
+                              plan.prefetch_size, selectivity};
+          points->push_back(point);
+        }
+      }
+    }
   }
+  return kSuccess;
+}
+
+// Name of a query trace under the layout selected with -l: the "layout2" of
+// name replaced by the name of the layout. The names are kept in names.
+static const char* LayoutTraceName(const char* name,
+                                   std::deque<std::string>* names) {
+  std::string layout = TableLayoutName(GetTableLayout());
+  std::string result = name;
+  size_t pos = result.rfind("layout2");
+  if (layout == "layout2" || pos == std::string::npos) return name;
+  result.replace(pos, strlen("layout2"), layout);
+  names->push_back(result);
+  return names->back().c_str();
+}
+
+// Name of a query trace with tag inserted before the "layout2" of name. The
+// names are kept in names.
+static const char* TagTraceName(const char* name, const std::string& tag,
+                                std::deque<std::string>* names) {
+  std::string result = name;
+  size_t pos = result.rfind("layout2");
+  if (tag.empty() || pos == std::string::npos) return name;
+  result.insert(pos, tag);
+  names->push_back(result);
+  return names->back().c_str();
+}
+
+// Name of a join query trace under the join method selected with -J
+static const char* JoinTraceName(const char* name,
+                                 std::deque<std::string>* names) {
+  return TagTraceName(name, JoinTraceTag(GetJoinMethod()), names);
+}
+
+// Name of a GROUP BY query trace under the groups selected with -G
+static const char* GroupTraceName(const char* name,
+                                  std::deque<std::string>* names) {
+  return TagTraceName(name, GroupTraceTag(GetGroupBy()), names);
+}
+
+// Name of a query trace under the threads selected with -T
+static const char* ThreadTraceName(const char* name,
+                                   std::deque<std::string>* names) {
+  return TagTraceName(name, ThreadTraceTag(GetTraceThreads()), names);
+}
+
+// TRACE_JOB of a query trace, named after the threads selected with -T and
+// the layout selected with -l
+#define QUERY_JOB(jobs, names, gen, file, ...)                           \
+  do {                                                                   \
+    const char* query_trace_name =                                       \
+        LayoutTraceName(ThreadTraceName(file, &names), &names);          \
+    TRACE_JOB(jobs, gen, query_trace_name, __VA_ARGS__);                 \
+  } while (0)
+
+// Row read, row write and column read percentages of the random patterns of
+// mode m; column writes take the rest
+struct RandomPatternRatios {
+  int r_ratio;
+  int w_ratio;
+  int cr_ratio;
+};
+
+static const RandomPatternRatios kRandomPatterns[] = {
+  {15, 15, 35}, {35, 35, 15}, {35, 15, 35}, {15, 35, 15},
+  {100, 0, 0}, {75, 0, 25}, {50, 0, 50}, {25, 0, 75}, {0, 0, 100},
+  {0, 100, 0}, {0, 75, 0}, {0, 50, 0}, {0, 25, 0}, {0, 0, 0},
+};
+
+// Adds the jobs of GenHybTrace_12 and GenDRAMTrace_12 for every pattern of
+// kRandomPatterns, of num_query accesses each. The pattern files are
+// written here, one after the other, so that both traces of a pattern read
+// the same accesses; existing ones are reused. Returns kFailure if a
+// pattern file cannot be written.
+static int AddRandomPatternJobs(int num_query, std::vector<TraceJob>* jobs,
+                                std::deque<std::string>* names) {
+  size_t num_patterns = sizeof(kRandomPatterns) / sizeof(kRandomPatterns[0]);
+  for (size_t i = 0; i < num_patterns; i++) {
+    const RandomPatternRatios& p = kRandomPatterns[i];
+    char description[64];
+    snprintf(description, sizeof(description), "R%d_W%d_r%d_w%d", p.r_ratio,
+             p.w_ratio, p.cr_ratio, 100 - p.r_ratio - p.w_ratio - p.cr_ratio);
+    names->push_back(description);
+    const char* desc = names->back().c_str();
+    names->push_back(std::string("random_") + desc + ".trace");
+    const char* random_file = names->back().c_str();
+    names->push_back(std::string("hybrid-qurey12_") + desc + "-layout2.trace");
+    const char* hyb_file = names->back().c_str();
+    names->push_back(std::string("DRAM-qurey12_") + desc + "-layout2.trace");
+    const char* dram_file = names->back().c_str();
+    if (access(random_file, F_OK) != 0
+        && random_pattern(num_query, p.r_ratio, p.w_ratio, p.cr_ratio,
+                          random_file) != kSuccess) {
+      fprintf(stderr, "Cannot write the random pattern %s\n", random_file);
+      return kFailure;
+    }
+    TRACE_JOB(*jobs, GenHybTrace_12, hyb_file, num_query, p.r_ratio,
+              p.w_ratio, p.cr_ratio, random_file, desc);
+    TRACE_JOB(*jobs, GenDRAMTrace_12, dram_file, num_query, p.r_ratio,
+              p.w_ratio, p.cr_ratio, random_file, desc);
+  }
+  return kSuccess;
+}
+
+static void PrintUsage(const char* prog) {
+  fprintf(stderr,
+          "Usage: %s <r|c|h|d|m|w|t> [-f text|binary] [-a 32|64] [-g geometry] "
+          "[-t tuples] [-i none|rr|xor] [-l layout] [-v values] [-J join] "
+          "[-G groups] [-T threads] [-C cpu] [-L caches] [-M timing] "
+          "[-j jobs] "
+          "[-s threads] [-z threads] [-m] [-n]\n"
+          "       %s x <binary trace> <text trace>\n"
+          "       %s u [-z threads] <compressed trace> <trace> [begin end]\n"
+          "       %s q [options] <schema file> [query ...]\n"
+          "       %s s [options] <sweep file>\n"
+          "       %s b [-g geometry] [-j jobs] <trace> ...\n"
+          "  -f  output format of the generated traces (default: text)\n"
+          "  -a  address width of the traces; 64 writes 16 hex digits and "
+          "binary version 2 (default: 32)\n"
+          "  -g  device geometry config (default: 4 GB, 8 banks, 2 channels)\n"
+          "  -t  tuples of every table (default: 500000)\n"
+          "  -i  interleaving of the tables over banks and channels: none, "
+          "round-robin or XOR-hashed stripes (default: none)\n"
+          "  -l  layout of the query tables: row, col, pax, group[cells] or "
+          "tile[tuples] (default: col)\n"
+          "  -v  values of the fields the query filters compare: periodic, "
+          "uniform, zipf[s], sorted, runs[tuples] or corr[fraction] "
+          "(default: periodic)\n"
+          "  -J  join of the join queries: tuple by tuple, a hash join, or "
+          "a sort-merge join with runs of run_tuples merged fan_in at a "
+          "time: tuple, hash or merge[run_tuples[xfan_in]] "
+          "(default: tuple; merge8192x8)\n"
+          "  -G  groups of the GROUP BY query and the values its keys are "
+          "drawn from: groups[:values] (default: 4096:uniform)\n"
+          "  -T  logical threads of the query traces, their share of the "
+          "tuples and the interleaving of their accesses: "
+          "threads[:static|:morsel[tuples]][:rr|:prop] "
+          "(default: 1; static, morsel16384, rr)\n"
+          "  -C  writes the issue cycle of every access to <trace>.cycles, "
+          "from a CPU model: default or a list of pred, agg, mat, issue, mlp "
+          "and lat cycles, e.g. pred=2,lat=200 (default: no cycles)\n"
+          "  -L  writes only the misses and write-backs of a cache hierarchy: "
+          "default or levels size[k|m]:ways[:lru|:rrip], e.g. "
+          "32k:8,8m:16:rrip (default: no caches; "
+          "32k:8,256k:8,8m:16:rrip)\n"
+          "  -M  reports the memory cycles and bank busy time of every trace "
+          "from a timing model: default, rcnvm or dram, optionally followed "
+          "by rcd, cl, rp, wr, crcd, ccl, crp, cwr, burst, queue and ratio, "
+          "e.g. dram,rp=12 (default: no timing; rcnvm)\n"
+          "  -j  traces generated at the same time "
+          "(default: number of cores)\n"
+          "  -s  threads a sharded generator splits its tuples over "
+          "(default: 1)\n"
+          "  -z  block-compresses every trace file on this many threads "
+          "(default: 0, uncompressed)\n"
+          "  -m  writes the traces through a memory mapping of the file\n"
+          "  -n  dry run: reports the size of every trace without writing it\n"
+          "  m   traces random patterns of row and column reads and writes "
+          "in 14 ratios, of tuples accesses each, written to "
+          "random_<ratios>.trace unless it exists\n"
+          "  w   traces the queries over 512-byte IMDB_Large tuples and the "
+          "mixed row and column queries\n"
+          "  x   converts a binary trace back to NVMain text\n"
+          "  u   decompresses the byte range [begin, end) of a compressed "
+          "trace\n"
+          "  q   traces the OLXP queries (default: all) over every table of a "
+          "schema file\n"
+          "  s   traces every point of the sweep of a spec file and writes "
+          "a manifest of them\n"
+          "  b   reports the row and column buffer hits, misses, conflicts "
+          "and mode switches of text or binary traces, per bank and in "
+          "total\n",
+          prog, prog, prog, prog, prog, prog);
 }
 
 
@@ -49,9 +465,211 @@ int main(int argc, char *argv[]) {
   // according to the command line options.
   if (argc == 1) {
     fprintf(stderr, "No arguments!\n");
+    PrintUsage(argv[0]);
     exit(EXIT_FAILURE);
   }
 
+  // Options follow the mode letter
+  int opt;
+  DeviceGeometry geometry;
+  int64_t num_tuples = 500000;
+  while ((opt = getopt(argc - 1, argv + 1, "f:a:g:t:i:l:v:J:G:T:C:L:M:j:s:z:mn")) != -1) {
+    switch (opt) {
+      case 'f':
+        if (strcmp(optarg, "text") == 0) {
+          SetTraceFormat(kTraceText);
+        } else if (strcmp(optarg, "binary") == 0) {
+          SetTraceFormat(kTraceBinary);
+        } else {
+          PrintUsage(argv[0]);
+          exit(EXIT_FAILURE);
+        }
+        break;
+      case 'a':
+        if (strcmp(optarg, "32") == 0) {
+          SetAddrWidth(kAddr32);
+        } else if (strcmp(optarg, "64") == 0) {
+          SetAddrWidth(kAddr64);
+        } else {
+          PrintUsage(argv[0]);
+          exit(EXIT_FAILURE);
+        }
+        break;
+      case 'g':
+        if (LoadDeviceGeometry(optarg, &geometry) != kSuccess
+            || SetDeviceGeometry(geometry) != kSuccess) {
+          exit(EXIT_FAILURE);
+        }
+        PrintDeviceGeometry();
+        break;
+      case 't':
+        num_tuples = strtoll(optarg, NULL, 0);
+        if (num_tuples <= 0) {
+          PrintUsage(argv[0]);
+          exit(EXIT_FAILURE);
+        }
+        break;
+      case 'i': {
+        BankInterleave interleave;
+        if (ParseBankInterleave(optarg, &interleave) != kSuccess) {
+          PrintUsage(argv[0]);
+          exit(EXIT_FAILURE);
+        }
+        SetBankInterleave(interleave);
+        break;
+      }
+      case 'l': {
+        TableLayout layout;
+        if (ParseTableLayout(optarg, &layout) != kSuccess) {
+          PrintUsage(argv[0]);
+          exit(EXIT_FAILURE);
+        }
+        SetTableLayout(layout);
+        break;
+      }
+      case 'v': {
+        ValueDistribution values;
+        if (ParseValueDistribution(optarg, &values) != kSuccess) {
+          PrintUsage(argv[0]);
+          exit(EXIT_FAILURE);
+        }
+        SetValueDistribution(values);
+        break;
+      }
+      case 'J': {
+        JoinMethod join;
+        if (ParseJoinMethod(optarg, &join) != kSuccess) {
+          PrintUsage(argv[0]);
+          exit(EXIT_FAILURE);
+        }
+        SetJoinMethod(join);
+        break;
+      }
+      case 'G': {
+        GroupBy group_by;
+        if (ParseGroupBy(optarg, &group_by) != kSuccess) {
+          PrintUsage(argv[0]);
+          exit(EXIT_FAILURE);
+        }
+        SetGroupBy(group_by);
+        break;
+      }
+      case 'T': {
+        TraceThreads threads;
+        if (ParseTraceThreads(optarg, &threads) != kSuccess) {
+          PrintUsage(argv[0]);
+          exit(EXIT_FAILURE);
+        }
+        SetTraceThreads(threads);
+        break;
+      }
+      case 'C': {
+        CpuModel model;
+        if (ParseCpuModel(optarg, &model) != kSuccess) {
+          PrintUsage(argv[0]);
+          exit(EXIT_FAILURE);
+        }
+        SetCpuModel(model);
+        printf("CPU model of the cycles: %s\n", CpuModelName(model).c_str());
+        break;
+      }
+      case 'L': {
+        CacheConfig caches;
+        if (ParseCacheConfig(optarg, &caches) != kSuccess) {
+          PrintUsage(argv[0]);
+          exit(EXIT_FAILURE);
+        }
+        SetCacheConfig(caches);
+        printf("Caches of the traces: %s\n", CacheConfigName(caches).c_str());
+        break;
+      }
+      case 'M': {
+        TimingModel timing;
+        if (ParseTimingModel(optarg, &timing) != kSuccess) {
+          PrintUsage(argv[0]);
+          exit(EXIT_FAILURE);
+        }
+        SetTimingModel(timing);
+        printf("Timing model of the traces: %s\n",
+               TimingModelName(timing).c_str());
+        break;
+      }
+      case 'j':
+        SetJobThreads(atoi(optarg));
+        break;
+      case 's':
+        SetShardThreads(atoi(optarg));
+        break;
+      case 'z':
+        SetCompressThreads(atoi(optarg));
+        break;
+      case 'm':
+        SetMappedOutput(true);
+        break;
+      case 'n':
+        SetDryRun(true);
+        break;
+      default:
+        PrintUsage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+  }
+  char** args = argv + 1 + optind;
+  int num_args = argc - 1 - optind;
+  SelectAddrConverter();
+  SelectPredicateEvaluator();
+
+  if (argv[1][0] == 'x') { // convert a binary trace to text
+    if (num_args != 2) {
+      PrintUsage(argv[0]);
+      exit(EXIT_FAILURE);
+    }
+    return ConvertBinaryTrace(args[0], args[1]) == kSuccess ? 0 : 1;
+  }
+  if (argv[1][0] == 'u') { // decompress a compressed trace
+    if (num_args != 2 && num_args != 4) {
+      PrintUsage(argv[0]);
+      exit(EXIT_FAILURE);
+    }
+    uint64_t begin = num_args == 4 ? strtoull(args[2], NULL, 0) : 0;
+    uint64_t end = num_args == 4 ? strtoull(args[3], NULL, 0) : UINT64_MAX;
+    if (begin > end) {
+      fprintf(stderr, "The range to decompress ends before it begins\n");
+      PrintUsage(argv[0]);
+      exit(EXIT_FAILURE);
+    }
+    int num_threads = GetCompressThreads();
+    if (num_threads == 0) num_threads = std::thread::hardware_concurrency();
+    return DecompressTrace(args[0], args[1], begin, end, num_threads)
+        == kSuccess ? 0 : 1;
+  }
+
+  if (argv[1][0] == 'b') { // buffer locality of traces
+    if (num_args < 1) {
+      PrintUsage(argv[0]);
+      exit(EXIT_FAILURE);
+    }
+    std::vector<BufferLocality> results(num_args);
+    std::vector<TraceJob> jobs;
+    for (int i = 0; i < num_args; i++) {
+      BufferLocality* result = &results[i];
+      const char* file = args[i];
+      jobs.push_back(TraceJob("AnalyzeBufferLocality", file, [=]() {
+        return AnalyzeBufferLocality(file, result);
+      }));
+    }
+    int ret = RunTraceJobs(jobs);
+    BufferLocality total;
+    memset(&total.total, 0, sizeof(total.total));
+    for (int i = 0; i < num_args; i++) {
+      if (jobs[i].status != TraceJob::kJobDone) continue;
+      PrintBufferLocality(args[i], results[i], true);
+      total.total.Add(results[i].total);
+    }
+    if (num_args > 1) PrintBufferLocality("All traces", total, false);
+    return ret == kSuccess ? 0 : 1;
+  }
+
   printf("Column offset: f1 = %zu, f2 = %zu, f3 = %zu, f4 = %zu\n"
          "               f5 = %zu, f6 = %zu, f7 = %zu, f8 = %zu\n"
          "               f9 = %zu, f10 = %zu, f11 = %zu, f12 = %zu\n"
@@ -64,158 +682,203 @@ int main(int argc, char *argv[]) {
          offsetof(IMDBRow, f16));
   printf("Length of an IMDB row: %zu\n", sizeof(IMDBRow));
 
-  int num_tuples = 500000;
+  // The compiled-in tables: IMDBRow of r and c from 0, and that of the query
+  // traces from both table addresses with IMDBOverCLRow of Q14 from table-a
+  BankInterleave interleave = GetBankInterleave();
+  if (argv[1][0] == 'r' || argv[1][0] == 'c') {
+    if (!TableFits("IMDBRow", num_tuples, sizeof(IMDBRow), 0x0u,
+                   interleave)) {
+      return 1;
+    }
+  } else if (argv[1][0] == 'h' || argv[1][0] == 'd') {
+    if (!TableFits("IMDBRow", num_tuples, sizeof(IMDBRow), kOLXPTableBAddr,
+                   interleave)
+        || !TableFits("IMDBOverCLRow", num_tuples, sizeof(IMDBOverCLRow),
+                      kOLXPTableAAddr, interleave)) {
+      return 1;
+    }
+  } else if (argv[1][0] == 'w') {
+    if (!TableFits("IMDB_Large", num_tuples, sizeof(IMDB_Large),
+                   kOLXPTableAAddr, interleave)) {
+      return 1;
+    }
+  }
+
+  std::vector<TraceJob> jobs;
+  std::deque<std::string> trace_names;
+  std::vector<SweepPoint> sweep_points;  // of jobs, in order
+  std::string sweep_manifest;
 
   if (argv[1][0] == 'r') { // generate row trace
     printf("Generate row sequential read trace\n");
-    GenRowTrace_1("row-part-read-layout1.trace", num_tuples, sizeof(IMDBRow), 0x0u);
-    GenRowTrace_2("row-part-read-layout2.trace", num_tuples, sizeof(IMDBRow), 0x0u);
-    GenRowTrace_3("row-part-write-layout1.trace", num_tuples, sizeof(IMDBRow), 0x0u);
-    GenRowTrace_4("row-part-write-layout2.trace", num_tuples, sizeof(IMDBRow), 0x0u);
-    GenRowTrace_5("row-seq-read-layout1.trace", num_tuples, sizeof(IMDBRow), 0x0u);
-    GenRowTrace_6("row-seq-read-layout2.trace", num_tuples, sizeof(IMDBRow), 0x0u);
-    GenRowTrace_7("row-seq-write-layout1.trace", num_tuples, sizeof(IMDBRow), 0x0u);
-    GenRowTrace_8("row-seq-write-layout2.trace", num_tuples, sizeof(IMDBRow), 0x0u);
+    TRACE_JOB(jobs, GenRowTrace_1, "row-part-read-layout1.trace", num_tuples, sizeof(IMDBRow), 0x0u);
+    TRACE_JOB(jobs, GenRowTrace_2, "row-part-read-layout2.trace", num_tuples, sizeof(IMDBRow), 0x0u);
+    TRACE_JOB(jobs, GenRowTrace_3, "row-part-write-layout1.trace", num_tuples, sizeof(IMDBRow), 0x0u);
+    TRACE_JOB(jobs, GenRowTrace_4, "row-part-write-layout2.trace", num_tuples, sizeof(IMDBRow), 0x0u);
+    TRACE_JOB(jobs, GenRowTrace_5, "row-seq-read-layout1.trace", num_tuples, sizeof(IMDBRow), 0x0u);
+    TRACE_JOB(jobs, GenRowTrace_6, "row-seq-read-layout2.trace", num_tuples, sizeof(IMDBRow), 0x0u);
+    TRACE_JOB(jobs, GenRowTrace_7, "row-seq-write-layout1.trace", num_tuples, sizeof(IMDBRow), 0x0u);
+    TRACE_JOB(jobs, GenRowTrace_8, "row-seq-write-layout2.trace", num_tuples, sizeof(IMDBRow), 0x0u);
   } else if (argv[1][0] == 'c') { // generate column trace
     printf("Generate column sequential trace for f3 and f10 columns:\n");
-    GenColTrace_1("col-part-read-layout1.trace", num_tuples, sizeof(IMDBRow), 0x0u);
-    GenColTrace_2("col-part-read-layout2.trace", num_tuples, sizeof(IMDBRow), 0x0u);
-    GenColTrace_3("col-part-write-layout1.trace", num_tuples, sizeof(IMDBRow), 0x0u);
-    GenColTrace_4("col-part-write-layout2.trace", num_tuples, sizeof(IMDBRow), 0x0u);
+    TRACE_JOB(jobs, GenColTrace_1, "col-part-read-layout1.trace", num_tuples, sizeof(IMDBRow), 0x0u);
+    TRACE_JOB(jobs, GenColTrace_2, "col-part-read-layout2.trace", num_tuples, sizeof(IMDBRow), 0x0u);
+    TRACE_JOB(jobs, GenColTrace_3, "col-part-write-layout1.trace", num_tuples, sizeof(IMDBRow), 0x0u);
+    TRACE_JOB(jobs, GenColTrace_4, "col-part-write-layout2.trace", num_tuples, sizeof(IMDBRow), 0x0u);
   } else if (argv[1][0] == 'h') { // generate hybrid trace
     printf("Generate hybrid query trace\n");
-    GenHybTrace_1("hybrid-qurey1-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u);
-    GenHybTrace_2("hybrid-qurey2-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u);
-    GenHybTrace_3("hybrid-qurey12-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u);
-    GenHybTrace_4("hybrid-qurey3-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u);
-    GenHybTrace_5("hybrid-qurey5-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u);
-    GenHybTrace_6("hybrid-qurey13-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u);
-    GenHybTrace_7("hybrid-qurey8-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u, 0x8000000u);
-    GenHybTrace_8("hybrid-qurey9-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u, 0x8000000u);
-    GenHybTrace_9("hybrid-qurey10-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u);
-    GenHybTrace_10("hybrid-qurey11-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u);
-//    GenHybTrace_11("hybrid-qurey11-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u,6);
-//    GenHybTrace_12("hybrid-qurey12-layout2.trace", num_tuples, 25, 25, 25, "random_file.trace", "R25_W25_r25_w25");
-   GenHybTrace_13("hybrid-qurey14-1-layout2.trace", num_tuples,sizeof(IMDBOverCLRow), 0x0u,1);
-   GenHybTrace_13("hybrid-qurey14-32-layout2.trace", num_tuples,sizeof(IMDBOverCLRow), 0x0u,32);
-   GenHybTrace_13("hybrid-qurey14-64-layout2.trace", num_tuples,sizeof(IMDBOverCLRow), 0x0u,64);
-   GenHybTrace_13("hybrid-qurey14-96-layout2.trace", num_tuples,sizeof(IMDBOverCLRow), 0x0u,96);
-   GenHybTrace_13("hybrid-qurey14-128-layout2.trace", num_tuples,sizeof(IMDBOverCLRow), 0x0u,128);
-    GenHybTrace_14("hybrid-qurey15-1-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u,1);
-    GenHybTrace_14("hybrid-qurey15-32-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u,32);
-    GenHybTrace_14("hybrid-qurey15-64-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u,64);
-    GenHybTrace_14("hybrid-qurey15-96-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u,96);
-    GenHybTrace_14("hybrid-qurey15-128-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u,128);
-//    GenHybTrace_15("hybrid-qurey15a-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u,1);
-//    GenHybTrace_15("hybrid-qurey15b-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u,128);
-//    GenHybTrace_16("hybrid-qurey16-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u);
-//    GenHybTrace_17("hybrid-qurey17-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u);
-//    GenHybTrace_18("hybrid-qurey18a-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,1);
-//    GenHybTrace_18("hybrid-qurey18b-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,128);
-//    GenHybTrace_19("hybrid-qurey19a-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,1);
-//    GenHybTrace_19("hybrid-qurey19b-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,128);
-//    GenHybTrace_20("hybrid-qurey20a-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,1,0);
-//    GenHybTrace_20("hybrid-qurey20b-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,3,1);
-//    GenHybTrace_20("hybrid-qurey20c-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,1,1);
-//    GenHybTrace_20("hybrid-qurey20d-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,1,3);
-//    GenHybTrace_20("hybrid-qurey20e-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,0,1);
-//    GenHybTrace_21("hybrid-qurey21a-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,1,0);
-//    GenHybTrace_21("hybrid-qurey21b-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,3,1);
-//    GenHybTrace_21("hybrid-qurey21c-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,1,1);
-//    GenHybTrace_21("hybrid-qurey21d-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,1,3);
-//    GenHybTrace_21("hybrid-qurey21e-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,0,1);
-    GenHybTrace_22("hybrid-qurey4-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u);
-    GenHybTrace_23("hybrid-qurey6-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u);
-    GenHybTrace_24("hybrid-qurey7-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_1, "hybrid-qurey1-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_2, "hybrid-qurey2-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_3, "hybrid-qurey12-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_4, "hybrid-qurey3-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_5, "hybrid-qurey5-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_6, "hybrid-qurey13-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_7, JoinTraceName("hybrid-qurey8-layout2.trace", &trace_names), num_tuples,sizeof(IMDBRow), kOLXPTableAAddr, kOLXPTableBAddr);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_8, JoinTraceName("hybrid-qurey9-layout2.trace", &trace_names), num_tuples,sizeof(IMDBRow), kOLXPTableAAddr, kOLXPTableBAddr);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_9, "hybrid-qurey10-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_10, "hybrid-qurey11-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_13, "hybrid-qurey14-1-layout2.trace", num_tuples,sizeof(IMDBOverCLRow), kOLXPTableAAddr,1);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_13, "hybrid-qurey14-32-layout2.trace", num_tuples,sizeof(IMDBOverCLRow), kOLXPTableAAddr,32);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_13, "hybrid-qurey14-64-layout2.trace", num_tuples,sizeof(IMDBOverCLRow), kOLXPTableAAddr,64);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_13, "hybrid-qurey14-96-layout2.trace", num_tuples,sizeof(IMDBOverCLRow), kOLXPTableAAddr,96);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_13, "hybrid-qurey14-128-layout2.trace", num_tuples,sizeof(IMDBOverCLRow), kOLXPTableAAddr,128);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_14, "hybrid-qurey15-1-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr,1);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_14, "hybrid-qurey15-32-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr,32);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_14, "hybrid-qurey15-64-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr,64);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_14, "hybrid-qurey15-96-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr,96);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_14, "hybrid-qurey15-128-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr,128);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_22, "hybrid-qurey4-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_23, "hybrid-qurey6-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_24, "hybrid-qurey7-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
+    QUERY_JOB(jobs, trace_names, GenHybTrace_25, GroupTraceName("hybrid-qurey16-layout2.trace", &trace_names), num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
   } else if (argv[1][0] == 'd') { // generate hybrid trace
     printf("Generate DRAM query trace\n");
-    GenDRAMTrace_1("DRAM-qurey1-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u);
-    GenDRAMTrace_2("DRAM-qurey2-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u);
-    GenDRAMTrace_3("DRAM-qurey12-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u);
-    GenDRAMTrace_4("DRAM-qurey3-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u);
-    GenDRAMTrace_5("DRAM-qurey5-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u);
-    GenDRAMTrace_6("DRAM-qurey13-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u);
-    GenDRAMTrace_7("DRAM-qurey8-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u, 0x8000000u);
-    GenDRAMTrace_8("DRAM-qurey9-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u, 0x8000000u);
-    GenDRAMTrace_9("DRAM-qurey10-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u);
-    GenDRAMTrace_10("DRAM-qurey11-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u);
-//    GenDRAMTrace_11("DRAM-qurey11-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u, 6);
-//    GenDRAMTrace_12("DRAM-qurey12-layout2.trace", num_tuples, 25, 25, 25, "random_file.trace", "R25_W25_r25_w25");
-    GenDRAMTrace_13("DRAM-qurey14-layout2.trace", num_tuples,sizeof(IMDBOverCLRow), 0x0u, 128);
-    GenDRAMTrace_14("DRAM-qurey15-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u, 128);
-//    GenDRAMTrace_15("DRAM-qurey15-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u, 128);
-//    GenDRAMTrace_16("DRAM-qurey16-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u, 128);
-//    GenDRAMTrace_17("DRAM-qurey17-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u, 128);
-//    GenDRAMTrace_18("DRAM-qurey18-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u, 128);
-//    GenDRAMTrace_19("DRAM-qurey19-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u, 128);
-//    GenDRAMTrace_20("DRAM-qurey20a-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,1,0);
-//    GenDRAMTrace_20("DRAM-qurey20b-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,3,1);
-//    GenDRAMTrace_20("DRAM-qurey20c-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,1,1);
-//    GenDRAMTrace_20("DRAM-qurey20d-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,1,3);
-//    GenDRAMTrace_21("DRAM-qurey21a-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,1,0);
-//    GenDRAMTrace_21("DRAM-qurey21b-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,3,1);
-//    GenDRAMTrace_21("DRAM-qurey21c-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,1,1);
-//    GenDRAMTrace_21("DRAM-qurey21d-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,1,3);
-//    GenDRAMTrace_21("DRAM-qurey21e-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,0,1);
-//    GenDRAMTrace_20("DRAM-qurey20e-layout2.trace", num_tuples,sizeof(IMDB_Large), 0x0u,0,1);
-    GenDRAMTrace_22("DRAM-qurey4-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u);
-    GenDRAMTrace_23("DRAM-qurey6-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u);
-    GenDRAMTrace_24("DRAM-qurey7-layout2.trace", num_tuples,sizeof(IMDBRow), 0x0u);
+    QUERY_JOB(jobs, trace_names, GenDRAMTrace_1, "DRAM-qurey1-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
+    QUERY_JOB(jobs, trace_names, GenDRAMTrace_2, "DRAM-qurey2-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
+    QUERY_JOB(jobs, trace_names, GenDRAMTrace_3, "DRAM-qurey12-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
+    QUERY_JOB(jobs, trace_names, GenDRAMTrace_4, "DRAM-qurey3-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
+    QUERY_JOB(jobs, trace_names, GenDRAMTrace_5, "DRAM-qurey5-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
+    QUERY_JOB(jobs, trace_names, GenDRAMTrace_6, "DRAM-qurey13-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
+    QUERY_JOB(jobs, trace_names, GenDRAMTrace_7, JoinTraceName("DRAM-qurey8-layout2.trace", &trace_names), num_tuples,sizeof(IMDBRow), kOLXPTableAAddr, kOLXPTableBAddr);
+    QUERY_JOB(jobs, trace_names, GenDRAMTrace_8, JoinTraceName("DRAM-qurey9-layout2.trace", &trace_names), num_tuples,sizeof(IMDBRow), kOLXPTableAAddr, kOLXPTableBAddr);
+    QUERY_JOB(jobs, trace_names, GenDRAMTrace_9, "DRAM-qurey10-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
+    QUERY_JOB(jobs, trace_names, GenDRAMTrace_10, "DRAM-qurey11-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
+    QUERY_JOB(jobs, trace_names, GenDRAMTrace_13, "DRAM-qurey14-layout2.trace", num_tuples,sizeof(IMDBOverCLRow), kOLXPTableAAddr, 128);
+    QUERY_JOB(jobs, trace_names, GenDRAMTrace_14, "DRAM-qurey15-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr, 128);
+    QUERY_JOB(jobs, trace_names, GenDRAMTrace_22, "DRAM-qurey4-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
+    QUERY_JOB(jobs, trace_names, GenDRAMTrace_23, "DRAM-qurey6-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
+    QUERY_JOB(jobs, trace_names, GenDRAMTrace_24, "DRAM-qurey7-layout2.trace", num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
+    QUERY_JOB(jobs, trace_names, GenDRAMTrace_25, GroupTraceName("DRAM-qurey16-layout2.trace", &trace_names), num_tuples,sizeof(IMDBRow), kOLXPTableAAddr);
   } else if (argv[1][0] == 'm'){ // random pattern
-//    // R15_W15_r35_w35
-//    GenHybTrace_12("hybrid-qurey12_R15_W15_r35_w35-layout2.trace", num_tuples, 15, 15, 35, "random_R15_W15_r35_w35.trace", "R15_W15_r35_w35");
-//    GenDRAMTrace_12("DRAM-qurey12_R15_W15_r35_w35-layout2.trace", num_tuples, 15, 15, 35, "random_R15_W15_r35_w35.trace", "R15_W15_r35_w35");
-//    // R35_W35_r15_w15
-//    GenHybTrace_12("hybrid-qurey12_R35_W35_r15_w15-layout2.trace", num_tuples, 35, 35, 15, "random_R35_W35_r15_w15.trace", "R35_W35_r15_w15");
-//    GenDRAMTrace_12("DRAM-qurey12_R35_W35_r15_w15-layout2.trace", num_tuples, 35, 35, 15, "random_R35_W35_r15_w15.trace", "R35_W35_r15_w15");
-//    // R35_W15_r35_w15
-//    GenHybTrace_12("hybrid-qurey12_R35_W15_r35_w15-layout2.trace", num_tuples, 35, 15, 35, "random_R35_W15_r35_w15.trace", "R35_W15_r35_w15");
-//    GenDRAMTrace_12("DRAM-qurey12_R35_W15_r35_w15-layout2.trace", num_tuples, 35, 15, 35, "random_R35_W15_r35_w15.trace", "R35_W15_r35_w15");
-//    // R15_W35_r15_w35
-//    GenHybTrace_12("hybrid-qurey12_R15_W35_r15_w35-layout2.trace", num_tuples, 15, 35, 15, "random_R15_W35_r15_w35.trace", "R15_W35_r15_w35");
-//    GenDRAMTrace_12("DRAM-qurey12_R15_W35_r15_w35-layout2.trace", num_tuples, 15, 35, 15, "random_R15_W35_r15_w35.trace", "R15_W35_r15_w35");
-
-//    GenHybTrace_12("hybrid-qurey12_R100_W0_r0_w0-layout2.trace", num_tuples, 100, 0, 0, "random_R100_W0_r0_w0.trace", "R100_W0_r0_w0");
-//    GenDRAMTrace_12("DRAM-qurey12_R100_W0_r0_w0-layout2.trace", num_tuples, 100, 0, 0, "random_R100_W0_r0_w0.trace", "R100_W0_r0_w0");
-//    
-//    GenHybTrace_12("hybrid-qurey12_R75_W0_r25_w0-layout2.trace", num_tuples, 75, 0, 25, "random_R75_W0_r25_w0.trace", "R75_W0_r25_w0");
-//    GenDRAMTrace_12("DRAM-qurey12_R75_W0_r25_w0-layout2.trace", num_tuples, 75, 0, 25, "random_R75_W0_r25_w0.trace", "R75_W0_r25_w0");
-//    
-//    GenHybTrace_12("hybrid-qurey12_R50_W0_r50_w0-layout2.trace", num_tuples, 50, 0, 50, "random_R50_W0_r50_w0.trace", "R50_W0_r50_w0");
-//    GenDRAMTrace_12("DRAM-qurey12_R50_W0_r50_w0-layout2.trace", num_tuples, 50, 0, 50, "random_R50_W0_r50_w0.trace", "R50_W0_r50_w0");
-//    
-//    GenHybTrace_12("hybrid-qurey12_R25_W0_r75_w0-layout2.trace", num_tuples, 25, 0, 75, "random_R25_W0_r75_w0.trace", "R25_W0_r75_w0");
-//    GenDRAMTrace_12("DRAM-qurey12_R25_W0_r75_w0-layout2.trace", num_tuples, 25, 0, 75, "random_R25_W0_r75_w0.trace", "R25_W0_r75_w0");
-//    
-//    GenHybTrace_12("hybrid-qurey12_R0_W0_r100_w0-layout2.trace", num_tuples, 0, 0, 100, "random_R0_W0_r100_w0.trace", "R0_W0_r100_w0");
-//    GenDRAMTrace_12("DRAM-qurey12_R0_W0_r100_w0-layout2.trace", num_tuples, 0, 0, 100, "random_R0_W0_r100_w0.trace", "R0_W0_r100_w0");
-//    
-//    GenHybTrace_12("hybrid-qurey12_R0_W100_r0_w0-layout2.trace", num_tuples, 0, 100, 0, "random_R0_W100_r0_w0.trace", "R0_W100_r0_w0");
-//    GenDRAMTrace_12("DRAM-qurey12_R0_W100_r0_w0-layout2.trace", num_tuples, 0, 100, 0, "random_R0_W100_r0_w0.trace", "R0_W100_r0_w0");
-//    
-//    GenHybTrace_12("hybrid-qurey12_R0_W75_r0_w25-layout2.trace", num_tuples, 0, 75, 0, "random_R0_W75_r0_w25.trace", "R0_W75_r0_w25");
-//    GenDRAMTrace_12("DRAM-qurey12_R0_W75_r0_w25-layout2.trace", num_tuples, 0, 75, 0, "random_R0_W75_r0_w25.trace", "R0_W75_r0_w25");
-//    
-//    GenHybTrace_12("hybrid-qurey12_R0_W50_r0_w50-layout2.trace", num_tuples, 0, 50, 0, "random_R0_W50_r0_w50.trace", "R0_W50_r0_w50");
-//    GenDRAMTrace_12("DRAM-qurey12_R0_W50_r0_w50-layout2.trace", num_tuples, 0, 50, 0, "random_R0_W50_r0_w50.trace", "R0_W50_r0_w50");
-//    
-//    GenHybTrace_12("hybrid-qurey12_R0_W25_r0_w75-layout2.trace", num_tuples, 0, 25, 0, "random_R0_W25_r0_w75.trace", "R0_W25_r0_w75");
-//    GenDRAMTrace_12("DRAM-qurey12_R0_W25_r0_w75-layout2.trace", num_tuples, 0, 25, 0, "random_R0_W25_r0_w75.trace", "R0_W25_r0_w75");
-//    
-//    GenHybTrace_12("hybrid-qurey12_R0_W0_r0_w100-layout2.trace", num_tuples, 0, 0, 0, "random_R0_W0_r0_w100.trace", "R0_W0_r0_w100");
-//    GenDRAMTrace_12("DRAM-qurey12_R0_W0_r0_w100-layout2.trace", num_tuples, 0, 0, 0, "random_R0_W0_r0_w100.trace", "R0_W0_r0_w100");
-//    
+    if (num_tuples > INT_MAX) {
+      fprintf(stderr, "A random pattern holds at most %d accesses\n",
+              INT_MAX);
+      return 1;
+    }
+    printf("Generate random pattern traces\n");
+    if (AddRandomPatternJobs((int)num_tuples, &jobs, &trace_names)
+        != kSuccess) {
+      return 1;
+    }
+  } else if (argv[1][0] == 'w') { // wide column and mixed queries
+    printf("Generate wide tuple query trace\n");
+    TRACE_JOB(jobs, GenHybTrace_15, "hybrid-qurey15a-layout2.trace", num_tuples, sizeof(IMDBRow), kOLXPTableAAddr, 1);
+    TRACE_JOB(jobs, GenHybTrace_15, "hybrid-qurey15b-layout2.trace", num_tuples, sizeof(IMDBRow), kOLXPTableAAddr, 128);
+    TRACE_JOB(jobs, GenHybTrace_16, "hybrid-qurey16-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr);
+    TRACE_JOB(jobs, GenHybTrace_17, "hybrid-qurey17-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr);
+    TRACE_JOB(jobs, GenHybTrace_18, "hybrid-qurey18a-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 1);
+    TRACE_JOB(jobs, GenHybTrace_18, "hybrid-qurey18b-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 128);
+    TRACE_JOB(jobs, GenHybTrace_19, "hybrid-qurey19a-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 1);
+    TRACE_JOB(jobs, GenHybTrace_19, "hybrid-qurey19b-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 128);
+    TRACE_JOB(jobs, GenHybTrace_20, "hybrid-qurey20a-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 1, 0);
+    TRACE_JOB(jobs, GenHybTrace_20, "hybrid-qurey20b-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 3, 1);
+    TRACE_JOB(jobs, GenHybTrace_20, "hybrid-qurey20c-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 1, 1);
+    TRACE_JOB(jobs, GenHybTrace_20, "hybrid-qurey20d-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 1, 3);
+    TRACE_JOB(jobs, GenHybTrace_20, "hybrid-qurey20e-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 0, 1);
+    TRACE_JOB(jobs, GenHybTrace_21, "hybrid-qurey21a-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 1, 0);
+    TRACE_JOB(jobs, GenHybTrace_21, "hybrid-qurey21b-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 3, 1);
+    TRACE_JOB(jobs, GenHybTrace_21, "hybrid-qurey21c-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 1, 1);
+    TRACE_JOB(jobs, GenHybTrace_21, "hybrid-qurey21d-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 1, 3);
+    TRACE_JOB(jobs, GenHybTrace_21, "hybrid-qurey21e-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 0, 1);
+    TRACE_JOB(jobs, GenDRAMTrace_15, "DRAM-qurey15-layout2.trace", num_tuples, sizeof(IMDBRow), kOLXPTableAAddr, 128);
+    TRACE_JOB(jobs, GenDRAMTrace_16, "DRAM-qurey16-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 128);
+    TRACE_JOB(jobs, GenDRAMTrace_17, "DRAM-qurey17-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 128);
+    TRACE_JOB(jobs, GenDRAMTrace_18, "DRAM-qurey18-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 128);
+    TRACE_JOB(jobs, GenDRAMTrace_19, "DRAM-qurey19-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 128);
+    TRACE_JOB(jobs, GenDRAMTrace_20, "DRAM-qurey20a-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 1, 0);
+    TRACE_JOB(jobs, GenDRAMTrace_20, "DRAM-qurey20b-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 3, 1);
+    TRACE_JOB(jobs, GenDRAMTrace_20, "DRAM-qurey20c-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 1, 1);
+    TRACE_JOB(jobs, GenDRAMTrace_20, "DRAM-qurey20d-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 1, 3);
+    TRACE_JOB(jobs, GenDRAMTrace_20, "DRAM-qurey20e-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 0, 1);
+    TRACE_JOB(jobs, GenDRAMTrace_21, "DRAM-qurey21a-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 1, 0);
+    TRACE_JOB(jobs, GenDRAMTrace_21, "DRAM-qurey21b-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 3, 1);
+    TRACE_JOB(jobs, GenDRAMTrace_21, "DRAM-qurey21c-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 1, 1);
+    TRACE_JOB(jobs, GenDRAMTrace_21, "DRAM-qurey21d-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 1, 3);
+    TRACE_JOB(jobs, GenDRAMTrace_21, "DRAM-qurey21e-layout2.trace", num_tuples, sizeof(IMDB_Large), kOLXPTableAAddr, 0, 1);
+  } else if (argv[1][0] == 'q') { // OLXP queries over runtime schemas
+    if (num_args < 1) {
+      PrintUsage(argv[0]);
+      exit(EXIT_FAILURE);
+    }
+    printf("Generate query traces over the schemas of %s\n", args[0]);
+    if (AddSchemaJobs(args[0], args + 1, num_args - 1, num_tuples, &jobs,
+                      &trace_names) != kSuccess) {
+      return 1;
+    }
+  } else if (argv[1][0] == 's') { // sweep of a spec file
+    if (num_args != 1) {
+      PrintUsage(argv[0]);
+      exit(EXIT_FAILURE);
+    }
+    SweepSpec spec;
+    if (LoadSweepSpec(args[0], num_tuples, &spec) != kSuccess) return 1;
+    if (mkdir(spec.output.c_str(), 0755) != 0 && errno != EEXIST) {
+      fprintf(stderr, "Cannot create %s\n", spec.output.c_str());
+      return 1;
+    }
+    printf("Generate the sweep of %s into %s\n", args[0],
+           spec.output.c_str());
+    if (AddSweepJobs(spec, &jobs, &trace_names, &sweep_points) != kSuccess) {
+      return 1;
+    }
+    sweep_manifest = spec.manifest;
   } else if (argv[1][0] == 't') { // test functions
     ParsePrintColAddr(0xDEADBEEF);
-    uint32_t temp_col_addr = ColAddr2RowAddr(0xDEADBEEF);
-    printf("Covert column address 0xDEADBEEF to row address: 0x%08x\n",
-           temp_col_addr);
+    uint64_t temp_col_addr = ColAddr2RowAddr(0xDEADBEEF);
+    printf("Covert column address 0xDEADBEEF to row address: 0x%08llx\n",
+           (unsigned long long)temp_col_addr);
     ParsePrintRowAddr(temp_col_addr);
-    uint32_t temp_row_addr = RowAddr2ColAddr(temp_col_addr);
-    printf("Covert row address back to column address: 0x%08x\n",
-           temp_row_addr);
+    uint64_t temp_row_addr = RowAddr2ColAddr(temp_col_addr);
+    printf("Covert row address back to column address: 0x%08llx\n",
+           (unsigned long long)temp_row_addr);
     assert(0xDEADBEEF == temp_row_addr);
+    if (CheckWideGeometry(kCheckAccesses) != kSuccess
+        || CheckBinaryTraces(kCheckAccesses) != kSuccess
+        || CheckCompressedTraces(kCheckAccesses) != kSuccess
+        || CheckDryRun(kCheckAccesses) != kSuccess
+        || CheckHashJoin(kCheckTuples) != kSuccess
+        || CheckMergeJoin(kCheckTuples) != kSuccess
+        || CheckGroupBy(kCheckTuples, kCheckGroups) != kSuccess
+        || CheckCacheFilter() != kSuccess
+        || CheckMemoryTiming() != kSuccess) {
+      return 1;
+    }
+    BenchAddrConversion(1 << 26);
+    BenchPredicates(1 << 24);
+  }
+  int ret = jobs.empty() ? kSuccess : RunTraceJobs(jobs);
+  // The manifest lists the failed points too
+  if (!sweep_points.empty()) {
+    if (WriteSweepManifest(sweep_manifest.c_str(), sweep_points, jobs)
+        != kSuccess) {
+      ret = kFailure;
+    } else {
+      printf("Manifest of %zu traces: %s\n", sweep_points.size(),
+             sweep_manifest.c_str());
+    }
   }
+  if (ret != kSuccess) return 1;
+  if (GetDryRun()) PrintDryRunTotals();
   return 0;
 }
 
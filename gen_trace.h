@@ -9,6 +9,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stddef.h>
+#include "trace_writer.h"
 
 // IMDB row (tuple) format with wide column:
 // The length of the tuple is 128 bytes, or 16 columns.
@@ -181,6 +182,9 @@ struct Address {
   int intrabus;
 };
 
+// Field widths of the default device, a 4 GB, 8-bank, 2-channel RC-NVM part.
+// The address codec works on the geometry selected at runtime, see
+// SetDeviceGeometry in addr_util.h.
 const int kHighRowBit = 5;
 const int kBankBit = 3;
 const int kChannelBit = 1;
@@ -193,137 +197,191 @@ const int kRowBufferSize = 1024;
 const int kColumnBufferSize = 1024;
 const int kCellSize = 8;
 
+// Geometry of an RC-NVM device: the widths of the address fields in bits and
+// the buffer sizes in cells
+struct DeviceGeometry {
+  int high_row_bit;
+  int bank_bit;
+  int channel_bit;
+  int low_row_bit;
+  int column_bit;
+  int intra_bus_bit;
+  int row_buffer_size;     // cells of a row, at most 1 << column_bit
+  int column_buffer_size;  // cells of a column, at most 1 << low_row_bit
+};
+
+const DeviceGeometry kDefaultGeometry = {
+  kHighRowBit, kBankBit, kChannelBit, kLowRowBit, kColumnBit, kIntraBusBit,
+  kRowBufferSize, kColumnBufferSize,
+};
+
+// How the tuple layouts spread a table over the banks and channels. A stripe
+// is a row buffer of a row layout, or column_buffer_size tuples of a column
+// layout; see CalTupleColAddr in addr_util.h.
+enum BankInterleave {
+  kInterleaveNone,        // stripes fill a bank and channel before moving on
+  kInterleaveRoundRobin,  // stripe s goes to bank/channel s mod the units
+  kInterleaveXor,         // the same with the unit XORed with s / the units
+};
+
+// Where the cells of a tuple go; see tuple_layout.h
+enum LayoutKind {
+  kLayoutRowFirst,     // Layout 1: tuples side by side along the rows
+  kLayoutColumnFirst,  // Layout 2: tuples stacked down column stripes
+  kLayoutPax,          // a row buffer is a page of minipages, one per cell
+  kLayoutColumnGroup,  // groups of param cells, each group laid out column-first
+  kLayoutHybridTile,   // param tuples side by side in a row of a stripe
+};
+
+struct TableLayout {
+  LayoutKind kind;
+  int param;  // cells per group, tuples per tile row; 0 for the others
+};
+
+const TableLayout kRowFirstLayout = {kLayoutRowFirst, 0};
+const TableLayout kColumnFirstLayout = {kLayoutColumnFirst, 0};
+
 // Read two columns
-int GenRowTrace_1(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_row_addr);
-int GenRowTrace_2(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_row_addr);
+int GenRowTrace_1(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_row_addr);
+int GenRowTrace_2(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_row_addr);
 // Write two columns
-int GenRowTrace_3(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_row_addr);
-int GenRowTrace_4(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_row_addr);
+int GenRowTrace_3(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_row_addr);
+int GenRowTrace_4(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_row_addr);
 // Read all
-int GenRowTrace_5(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_row_addr);
-int GenRowTrace_6(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_row_addr);
+int GenRowTrace_5(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_row_addr);
+int GenRowTrace_6(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_row_addr);
 // Write trace
-int GenRowTrace_7(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_row_addr);
-int GenRowTrace_8(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_row_addr);
+int GenRowTrace_7(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_row_addr);
+int GenRowTrace_8(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_row_addr);
+
+// Reads (op "R") or writes ("W") every cache line of every tuple by row, in
+// tuple order, with the tuples laid out as layout places them
+int GenRowLineTrace(const char* trace_file_name, int64_t num_tuples,
+                    int tuple_size, uint64_t base_row_addr,
+                    const TableLayout& layout, const char* op);
 
 // Read two columns
-int GenColTrace_1(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr);
-int GenColTrace_2(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr);
+int GenColTrace_1(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr);
+int GenColTrace_2(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr);
 // Write two columns
-int GenColTrace_3(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr);
-int GenColTrace_4(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr);
+int GenColTrace_3(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr);
+int GenColTrace_4(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr);
 
 //int GenHybridTrace_1(const char* trace_file_name, int trace_total,
-//                     uint32_t base_addr);
+//                     uint64_t base_addr);
 
 
-int GenHybTrace_1(const char* trace_file_name, int num_tuples, int tuple_size,
-			                  uint32_t base_col_addr); 
-int GenHybTrace_2(const char* trace_file_name, int num_tuples, int tuple_size,
-                        uint32_t base_col_addr); 
-int GenHybTrace_3(const char* trace_file_name, int num_tuples, int tuple_size,
-                        uint32_t base_col_addr); 
-int GenHybTrace_4(const char* trace_file_name, int num_tuples, int tuple_size,
-                        uint32_t base_col_addr); 
-int GenHybTrace_5(const char* trace_file_name, int num_tuples, int tuple_size,
-                        uint32_t base_col_addr); 
-int GenHybTrace_6(const char* trace_file_name, int num_tuples, int tuple_size,
-                        uint32_t base_col_addr); 
-int GenHybTrace_7(const char* trace_file_name, int num_tuples, int tuple_size,
-                        uint32_t base_col_addr_a, uint32_t base_col_addr_b); 
-int GenHybTrace_8(const char* trace_file_name, int num_tuples, int tuple_size,
-                        uint32_t base_col_addr_a, uint32_t base_col_addr_b); 
-int GenHybTrace_9(const char* trace_file_name, int num_tuples, int tuple_size,
-			uint32_t base_col_addr); 
-int GenHybTrace_10(const char* trace_file_name, int num_tuples, int tuple_size,
-			uint32_t base_col_addr); 
-int GenHybTrace_11(const char* trace_file_name, int num_tuples, int tuple_size,
-			uint32_t base_col_addr,int L3_size); 
+int GenHybTrace_1(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+			                  uint64_t base_col_addr); 
+int GenHybTrace_2(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                        uint64_t base_col_addr); 
+int GenHybTrace_3(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                        uint64_t base_col_addr); 
+int GenHybTrace_4(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                        uint64_t base_col_addr); 
+int GenHybTrace_5(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                        uint64_t base_col_addr); 
+int GenHybTrace_6(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                        uint64_t base_col_addr); 
+int GenHybTrace_7(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                        uint64_t base_col_addr_a, uint64_t base_col_addr_b); 
+int GenHybTrace_8(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                        uint64_t base_col_addr_a, uint64_t base_col_addr_b); 
+int GenHybTrace_9(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+			uint64_t base_col_addr); 
+int GenHybTrace_10(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+			uint64_t base_col_addr); 
+int GenHybTrace_11(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+			uint64_t base_col_addr,int L3_size); 
 int GenHybTrace_12(const char* trace_file_name, int num_query, int r_ratio, int w_ratio, int cr_ratio, const char* random_file, const char* description);
-int GenHybTrace_13(const char* trace_file_name, int num_tuples, int tuple_size,
-			uint32_t base_col_addr, int prefetch_size); 
-int GenHybTrace_14(const char* trace_file_name, int num_tuples, int tuple_size,
-			uint32_t base_col_addr, int prefetch_size); 
-int GenHybTrace_15(const char* trace_file_name, int num_tuples, int tuple_size,
-			uint32_t base_col_addr, int prefetch_size); 
-int GenHybTrace_16(const char* trace_file_name, int num_tuples, int tuple_size,
-			uint32_t base_col_addr); 
-int GenHybTrace_17(const char* trace_file_name, int num_tuples, int tuple_size,
-			uint32_t base_col_addr); 
-int GenHybTrace_18(const char* trace_file_name, int num_tuples, int tuple_size,
-			uint32_t base_col_addr, int prefetch_size); 
-int GenHybTrace_19(const char* trace_file_name, int num_tuples, int tuple_size,
-			uint32_t base_col_addr, int prefetch_size); 
-int GenHybTrace_20(const char* trace_file_name, int num_tuples, int tuple_size,
-			uint32_t base_col_addr, int row_rate,int col_rate); 
-int GenHybTrace_21(const char* trace_file_name, int num_tuples, int tuple_size,
-			uint32_t base_col_addr, int row_rate,int col_rate); 
-int GenHybTrace_22(const char* trace_file_name, int num_tuples, int tuple_size,
-                        uint32_t base_col_addr); 
-int GenHybTrace_23(const char* trace_file_name, int num_tuples, int tuple_size,
-                        uint32_t base_col_addr); 
-int GenHybTrace_24(const char* trace_file_name, int num_tuples, int tuple_size,
-                        uint32_t base_col_addr); 
+int GenHybTrace_13(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+			uint64_t base_col_addr, int prefetch_size); 
+int GenHybTrace_14(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+			uint64_t base_col_addr, int prefetch_size); 
+int GenHybTrace_15(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+			uint64_t base_col_addr, int prefetch_size); 
+int GenHybTrace_16(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+			uint64_t base_col_addr); 
+int GenHybTrace_17(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+			uint64_t base_col_addr); 
+int GenHybTrace_18(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+			uint64_t base_col_addr, int prefetch_size); 
+int GenHybTrace_19(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+			uint64_t base_col_addr, int prefetch_size); 
+int GenHybTrace_20(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+			uint64_t base_col_addr, int row_rate,int col_rate); 
+int GenHybTrace_21(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+			uint64_t base_col_addr, int row_rate,int col_rate); 
+int GenHybTrace_22(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                        uint64_t base_col_addr); 
+int GenHybTrace_23(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                        uint64_t base_col_addr); 
+int GenHybTrace_24(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                        uint64_t base_col_addr); 
+int GenHybTrace_25(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                        uint64_t base_col_addr);
 
-int GenDRAMTrace_1(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr); 
-int GenDRAMTrace_2(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr); 
-int GenDRAMTrace_3(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr); 
-int GenDRAMTrace_4(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr); 
-int GenDRAMTrace_5(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr); 
-int GenDRAMTrace_6(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr); 
-int GenDRAMTrace_7(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr_a, uint32_t base_col_addr_b); 
-int GenDRAMTrace_8(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr_a, uint32_t base_col_addr_b); 
-int GenDRAMTrace_9(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr); 
-int GenDRAMTrace_10(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr); 
-int GenDRAMTrace_11(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr, int L3_size); 
+int GenDRAMTrace_1(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr); 
+int GenDRAMTrace_2(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr); 
+int GenDRAMTrace_3(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr); 
+int GenDRAMTrace_4(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr); 
+int GenDRAMTrace_5(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr); 
+int GenDRAMTrace_6(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr); 
+int GenDRAMTrace_7(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr_a, uint64_t base_col_addr_b); 
+int GenDRAMTrace_8(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr_a, uint64_t base_col_addr_b); 
+int GenDRAMTrace_9(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr); 
+int GenDRAMTrace_10(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr); 
+int GenDRAMTrace_11(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr, int L3_size); 
 int GenDRAMTrace_12(const char* trace_file_name, int num_query, int r_ratio, int w_ratio, int cr_ratio, const char* random_file, const char* description);
-int GenDRAMTrace_13(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr_a, int prefetch_size); 
-int GenDRAMTrace_14(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr_a, int prefetch_size); 
-int GenDRAMTrace_15(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr_a, int prefetch_size); 
-int GenDRAMTrace_16(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr_a, int prefetch_size); 
-int GenDRAMTrace_17(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr_a, int prefetch_size); 
-int GenDRAMTrace_18(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr_a, int prefetch_size); 
-int GenDRAMTrace_19(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr_a, int prefetch_size); 
-int GenDRAMTrace_20(const char* trace_file_name, int num_tuples, int tuple_size,
-			uint32_t base_col_addr, int row_rate,int col_rate); 
-int GenDRAMTrace_21(const char* trace_file_name, int num_tuples, int tuple_size,
-			uint32_t base_col_addr, int row_rate,int col_rate); 
-int GenDRAMTrace_22(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr); 
-int GenDRAMTrace_23(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr); 
-int GenDRAMTrace_24(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr); 
+int GenDRAMTrace_13(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr_a, int prefetch_size); 
+int GenDRAMTrace_14(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr_a, int prefetch_size); 
+int GenDRAMTrace_15(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr_a, int prefetch_size); 
+int GenDRAMTrace_16(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr_a, int prefetch_size); 
+int GenDRAMTrace_17(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr_a, int prefetch_size); 
+int GenDRAMTrace_18(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr_a, int prefetch_size); 
+int GenDRAMTrace_19(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr_a, int prefetch_size); 
+int GenDRAMTrace_20(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+			uint64_t base_col_addr, int row_rate,int col_rate); 
+int GenDRAMTrace_21(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+			uint64_t base_col_addr, int row_rate,int col_rate); 
+int GenDRAMTrace_22(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr); 
+int GenDRAMTrace_23(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr); 
+int GenDRAMTrace_24(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr); 
+int GenDRAMTrace_25(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr);
 
 // TODO: Add functions use number of tuples as an input.
 
@@ -341,11 +399,15 @@ __attribute_used__ static inline uint64_t gettimestamp_ns() {
 int random_pattern(int num_query, int r_ratio, int w_ratio, int cr_ratio, const char* random_file);
 
 // Cache print
-void dprintf(FILE* fp, const char* format, int n, const char* op, unsigned addr,
-            int highrow, int bank, int channel, int lowrow, int column,
-            int intrabus);
+// The annotation is for reading short traces, so format gets n as int and
+// the addresses as unsigned
+void dprintf(TraceWriter* fp, const char* format, int64_t n, const char* op,
+             uint64_t addr, int highrow, int bank, int channel, int lowrow,
+             int column, int intrabus);
 
-void cprintf(FILE* fp, const char* format, int n,
-		const char* op, unsigned addr);
+// Emits the cache line at addr as access n.
+// Op_Width: 0 for row access; 1, 2, 3 ... for column access
+void cprintf(TraceWriter* fp, int64_t n, const char* op, uint64_t addr,
+             int op_width = 0);
 
 #endif /* GEN_TRACE_H_ */
@@ -6,6 +6,8 @@
 #include <stdio.h>
 #include <stddef.h>
 #include "addr_util.h"
+#include "trace_shard.h"
+#include "query_plan.h"
 
 // Generates hybrid query trace in hybrid addressing, begin with a base address.
 // The acces pattern of the following SQL query:
@@ -26,71 +28,17 @@
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenHybTrace_1(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
+int GenHybTrace_1(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenHybTrace_1 is running, Select f3,f4 from table-a where f10 > x .\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_C = "r";
-  const char *op_R = "R";
-
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
-  //base_row_addr = GetCacheLineAddr(base_row_addr);
-
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f10_addr = {};
-
-  int stride =  kCachelineSize / kCellSize;
-
-  // col read f10 first
-  for(int i = 0; i < num_tuples; i += stride) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of the f3 and f10 elements
-    f10_addr = addr;
-    f10_addr.column += offsetof(IMDBRow, f10) / kCellSize;
-#ifdef DEBUG
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-            GenColAddr(f10_addr), f10_addr.highrow, f10_addr.bank,
-            f10_addr.channel, f10_addr.lowrow, f10_addr.column,
-            f10_addr.intrabus);
-#else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f10_addr));
-#endif
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-    // for each line in of the data in this cacheline, compare f10 first, if success, then row_read the f3,f4
-    for(int j = 0; j < stride; j++)
-    {
-    	if((i + j) % 10 < THRESHOLD)
-    	{
-    		continue;
-    	}
-    	uint32_t temp_col = CalTupleColAddrLayout2(i + j, tuple_size, base_col_addr);
-    	uint32_t curr_row_addr = ColAddr2RowAddr(temp_col);
-	curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-      	ParseRowAddr(curr_row_addr, addr);
-      	dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-      	cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-      	++num_traces;
-    } 
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 1);
+  return GenPlanTrace(trace_file_name, plan, kRCNVM);
 }
 
 
@@ -113,83 +61,17 @@ int GenHybTrace_1(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenHybTrace_2(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
+int GenHybTrace_2(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenHybTrace_2 is running, Select * from table-a where f10 > x .\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_C = "r";
-  const char *op_R = "R";
-
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
-  //base_row_addr = GetCacheLineAddr(base_row_addr);
-
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f10_addr = {};
-
-  int stride =  kCachelineSize / kCellSize;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-  // col read f10 first
-  for(int i = 0; i < num_tuples; i += stride) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of the f3 and f10 elements
-    f10_addr = addr;
-    f10_addr.column += offsetof(IMDBRow, f10) / kCellSize;
-#ifdef DEBUG
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-            GenColAddr(f10_addr), f10_addr.highrow, f10_addr.bank,
-            f10_addr.channel, f10_addr.lowrow, f10_addr.column,
-            f10_addr.intrabus);
-#else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f10_addr));
-#endif
-
-    // for each line in of the data in this cacheline, compare f10 first, if success, then row_read the f3,f4
-    for(int j = 0; j < stride; j++)
-    {
-      if((i + j) % 10 < THRESHOLD)
-      {
-        continue;
-      }
-      uint32_t temp_col = CalTupleColAddrLayout2(i + j, tuple_size, base_col_addr);
-      uint32_t curr_row_addr = ColAddr2RowAddr(temp_col);
-      curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-        ++num_traces;
-        
-        curr_row_addr = curr_row_addr + kCachelineSize;
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-        ++num_traces;
-    } 
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 2);
+  return GenPlanTrace(trace_file_name, plan, kRCNVM);
 }
 
 
@@ -212,83 +94,17 @@ int GenHybTrace_2(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenHybTrace_3(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
+int GenHybTrace_3(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenHybTrace_3 is running, update table-a set f3 = xx, f4 = xx where f10 = xx .\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_C = "r";
-  const char *op_R = "R";
-  const char *op_W = "W";
-
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
-  //base_row_addr = GetCacheLineAddr(base_row_addr);
-
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f10_addr = {};
-
-  int stride =  kCachelineSize / kCellSize;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-  // col read f10 first
-  for(int i = 0; i < num_tuples; i += stride) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of the f3 and f10 elements
-    f10_addr = addr;
-    f10_addr.column += offsetof(IMDBRow, f10) / kCellSize;
-#ifdef DEBUG
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-            GenColAddr(f10_addr), f10_addr.highrow, f10_addr.bank,
-            f10_addr.channel, f10_addr.lowrow, f10_addr.column,
-            f10_addr.intrabus);
-#else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f10_addr));
-#endif
-
-    // for each line in of the data in this cacheline, compare f10 first, if success, then row_read the f3,f4
-    for(int j = 0; j < stride; j++)
-    {
-      if((i + j) % 10 < THRESHOLD)
-      {
-        continue;
-      }
-      uint32_t temp_col = CalTupleColAddrLayout2(i + j, tuple_size, base_col_addr);
-      uint32_t curr_row_addr = ColAddr2RowAddr(temp_col);
-      curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-        ++num_traces;
-        
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_W,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_W,
-              curr_row_addr);
-#endif
-        ++num_traces;
-    } 
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 12);
+  return GenPlanTrace(trace_file_name, plan, kRCNVM);
 }
 
 
@@ -312,68 +128,15 @@ int GenHybTrace_3(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenHybTrace_4(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
-
+int GenHybTrace_4(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenHybTrace_4 is running, Select * from table-a where f10 > x | most of f10 is > x .\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_R = "R";
 
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
-
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f10_addr = {};
-  Address f3_addr = {};
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-  // row read f10 first
-  for(int i = 0; i < num_tuples; i++) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of the f3 and f10 elements
-    f3_addr = addr;
-    f10_addr = addr;
-    f3_addr.column += offsetof(IMDBRow, f3) / kCellSize;
-    f10_addr.column += offsetof(IMDBRow, f10) / kCellSize;
-    uint32_t curr_row_addr = ColAddr2RowAddr(GenColAddr(f10_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-    num_traces++;
-
-    // if f10 match row read f1, f2, f3, f4
-    if(i % 10 < THRESHOLD_LOW)
-    {
-      continue;
-    }
-    curr_row_addr = ColAddr2RowAddr(GenColAddr(f3_addr));
-    curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-    num_traces++;
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 3);
+  return GenPlanTrace(trace_file_name, plan, kRCNVM);
 }
 
 
@@ -397,53 +160,17 @@ int GenHybTrace_4(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenHybTrace_5(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
+int GenHybTrace_5(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenHybTrace_5 is running, Select f9 from table-a where f10 > x | most f10 is > x.\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_C = "r";
-
-  int num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f10_addr = {};
-  Address f9_addr = {};
-
-  int stride =  kCachelineSize / kCellSize;
-
-  for(int i = 0; i < num_tuples; i += stride) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of the f3 and f10 elements
-    f10_addr = addr;
-    f9_addr = addr;
-    f10_addr.column += offsetof(IMDBRow, f10) / kCellSize;
-    f9_addr.column += offsetof(IMDBRow, f9) / kCellSize;
-#ifdef DEBUG
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-            GenColAddr(f10_addr), f10_addr.highrow, f10_addr.bank,
-            f10_addr.channel, f10_addr.lowrow, f10_addr.column,
-            f10_addr.intrabus);
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-            GenColAddr(f9_addr), f9_addr.highrow, f9_addr.bank,
-            f9_addr.channel, f9_addr.lowrow, f9_addr.column,
-            f9_addr.intrabus);
-#else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f10_addr));
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f9_addr));
-#endif
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 5);
+  return GenPlanTrace(trace_file_name, plan, kRCNVM);
 }
 
 
@@ -466,83 +193,17 @@ int GenHybTrace_5(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenHybTrace_6(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
+int GenHybTrace_6(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenHybTrace_6 is running, update table-a set f9 = xx where f10 = xx .| few f10 = xx\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_C = "r";
-  const char *op_R = "R";
-  const char *op_W = "W";
-
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
-  //base_row_addr = GetCacheLineAddr(base_row_addr);
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f10_addr = {};
-
-  int stride =  kCachelineSize / kCellSize;
-
-  // col read f10 first
-  for(int i = 0; i < num_tuples; i += stride) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of the f3 and f10 elements
-    f10_addr = addr;
-    f10_addr.column += offsetof(IMDBRow, f10) / kCellSize;
-#ifdef DEBUG
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-            GenColAddr(f10_addr), f10_addr.highrow, f10_addr.bank,
-            f10_addr.channel, f10_addr.lowrow, f10_addr.column,
-            f10_addr.intrabus);
-#else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f10_addr));
-#endif
-
-    // for each line in of the data in this cacheline, compare f10 first, if success, then row_read the f3,f4
-    for(int j = 0; j < stride; j++)
-    {
-      if((i + j) % 10 < THRESHOLD)
-      {
-        continue;
-      }
-      uint32_t temp_col = CalTupleColAddrLayout2(i + j, tuple_size, base_col_addr);
-      uint32_t curr_row_addr = ColAddr2RowAddr(temp_col);
-      curr_row_addr = GetCacheLineAddr(curr_row_addr);
-      curr_row_addr = curr_row_addr + kCachelineSize;
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-        ++num_traces;
-#ifdef DEBUG
-        ParseRowAddr(curr_row_addr, addr);
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_W,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_W,
-              curr_row_addr);
-#endif
-        ++num_traces;
-    } 
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 13);
+  return GenPlanTrace(trace_file_name, plan, kRCNVM);
 }
 
 // Generates hybrid query trace in hybrid addressing, begin with a base address.
@@ -564,116 +225,27 @@ int GenHybTrace_6(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenHybTrace_7(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr_a, uint32_t base_col_addr_b) {
+int GenHybTrace_7(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr_a, uint64_t base_col_addr_b) {
   printf("GenHybTrace_7 is running, Select table-a.f3, table-b.f4 from table-a, table-b where table-a.f1 > table-b.f1 table-a.f9 = table-b.f9.\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_C = "r";
-  const char *op_R = "R";
-
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr_a = GetCacheLineAddr(base_col_addr_a);
   base_col_addr_b = GetCacheLineAddr(base_col_addr_b);
-  //base_row_addr = GetCacheLineAddr(base_row_addr);
-
-  printf("Base column address for table-a: 0x%08x\n", base_col_addr_a);
-  printf("Base column address for table-b: 0x%08x\n", base_col_addr_b);
-  uint32_t curr_col_addr_a = base_col_addr_a;
-  uint32_t curr_col_addr_b = base_col_addr_b;
-  Address addr_a = {};
-  Address addr_b = {};
-  Address f1_addr_a = {};
-  Address f1_addr_b = {};
-  Address f9_addr_a = {};
-  Address f9_addr_b = {};
-
-  int stride =  kCachelineSize / kCellSize;
-
-  // col read f1, f9 first
-  for(int i = 0; i < num_tuples; i += stride) {
-    curr_col_addr_a = CalTupleColAddrLayout2(i, tuple_size, base_col_addr_a);
-    ParseColAddr(curr_col_addr_a, addr_a);
-    // Calculate the column address of the table-a.f9 and table-b.f9
-    f1_addr_a = addr_a;
-    f1_addr_a.column += offsetof(IMDBRow, f1) / kCellSize;
-    f9_addr_a = addr_a;
-    f9_addr_a.column += offsetof(IMDBRow, f9) / kCellSize;
-#ifdef DEBUG
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-            GenColAddr(f1_addr_a), f1_addr_a.highrow, f1_addr_a.bank,
-            f1_addr_a.channel, f1_addr_a.lowrow, f1_addr_a.column,
-            f1_addr_a.intrabus);
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-            GenColAddr(f9_addr_a), f9_addr_a.highrow, f9_addr_a.bank,
-            f9_addr_a.channel, f9_addr_a.lowrow, f9_addr_a.column,
-            f9_addr_a.intrabus);
-#else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f1_addr_a));
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f9_addr_a));
-#endif
-  }
-  for(int i = 0; i < num_tuples; i += stride) {
-    curr_col_addr_b = CalTupleColAddrLayout2(i, tuple_size, base_col_addr_b);
-    ParseColAddr(curr_col_addr_b, addr_b);
-    // Calculate the column address of the table-a.f9 and table-b.f9
-    f1_addr_b = addr_b;
-    f1_addr_b.column += offsetof(IMDBRow, f1) / kCellSize;
-    f9_addr_b = addr_b;
-    f9_addr_b.column += offsetof(IMDBRow, f9) / kCellSize;
-#ifdef DEBUG
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-            GenColAddr(f1_addr_b), f1_addr_b.highrow, f1_addr_b.bank,
-            f1_addr_b.channel, f1_addr_b.lowrow, f1_addr_b.column,
-            f1_addr_b.intrabus);
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-            GenColAddr(f9_addr_b), f9_addr_b.highrow, f9_addr_b.bank,
-            f9_addr_b.channel, f9_addr_b.lowrow, f9_addr_b.column,
-            f9_addr_b.intrabus);
-#else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f1_addr_b));
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f9_addr_b));
-#endif
+  printf("Base column address for table-a: 0x%08llx\n",
+         (unsigned long long)base_col_addr_a);
+  printf("Base column address for table-b: 0x%08llx\n",
+         (unsigned long long)base_col_addr_b);
+  if (GetJoinMethod().kind != kJoinByTuple) {
+    printf("Base column address for the %s: 0x%08llx\n",
+           GetJoinMethod().kind == kJoinHash ? "hash table" : "sorted runs",
+           (unsigned long long)kOLXPJoinAddr);
   }
 
-  // compare first; if success, then row_read the table-a.f3, and table-b.f4
-  for(int i = 0; i < num_tuples; i++)
-  {
-    if(i % 10 < THRESHOLD)
-    {
-      continue;
-    }
-    uint32_t temp_col_a = CalTupleColAddrLayout2(i, tuple_size, base_col_addr_a);
-    uint32_t curr_row_addr_a = ColAddr2RowAddr(temp_col_a);
-    curr_row_addr_a = GetCacheLineAddr(curr_row_addr_a);
-    uint32_t temp_col_b = CalTupleColAddrLayout2(i, tuple_size, base_col_addr_b);
-    uint32_t curr_row_addr_b = ColAddr2RowAddr(temp_col_b);
-    curr_row_addr_b = GetCacheLineAddr(curr_row_addr_b);
-#ifdef DEBUG
-    //Address addr;
-    ParseRowAddr(curr_row_addr_a, addr_a);
-    ParseRowAddr(curr_row_addr_b, addr_b);
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_R,
-           curr_row_addr_a, addr_a.highrow, addr_a.bank,
-           addr_a.channel, addr_a.lowrow, addr_a.column, addr_a.intrabus);
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_R,
-           curr_row_addr_b, addr_b.highrow, addr_b.bank,
-           addr_b.channel, addr_b.lowrow, addr_b.column, addr_b.intrabus);
-#else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_R,
-           curr_row_addr_a);
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_R,
-           curr_row_addr_b);
-#endif
-  } 
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr_a);
+  AddPlanTable(&plan, base_col_addr_b);
+  AddOLXPQuery(&plan, 8);
+  return GenPlanTrace(trace_file_name, plan, kRCNVM);
 }
 
 // Generates hybrid query trace in hybrid addressing, begin with a base address.
@@ -695,100 +267,27 @@ int GenHybTrace_7(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenHybTrace_8(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr_a, uint32_t base_col_addr_b) {
+int GenHybTrace_8(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr_a, uint64_t base_col_addr_b) {
   printf("GenHybTrace_8 is running, Select table-a.f3, table-b.f4 from table-a, table-b where table-a.f9 = table-b.f9.\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_C = "r";
-  const char *op_R = "R";
-
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr_a = GetCacheLineAddr(base_col_addr_a);
-  base_col_addr_b = GetCacheLineAddr(base_col_addr_b);
-  //base_row_addr = GetCacheLineAddr(base_row_addr);
-
-  printf("Base column address for table-a: 0x%08x\n", base_col_addr_a);
-  printf("Base column address for table-b: 0x%08x\n", base_col_addr_b);
-  uint32_t curr_col_addr_a = base_col_addr_a;
-  uint32_t curr_col_addr_b = base_col_addr_b;
-  Address addr_a = {};
-  Address addr_b = {};
-  Address f9_addr_a = {};
-  Address f9_addr_b = {};
-
-  int stride =  kCachelineSize / kCellSize;
-
-  // col read table-a.f9, table-b.f9 first
-  for(int i = 0; i < num_tuples; i += stride) {
-    curr_col_addr_a = CalTupleColAddrLayout2(i, tuple_size, base_col_addr_a);
-    ParseColAddr(curr_col_addr_a, addr_a);
-    // Calculate the column address of the table-a.f9 and table-b.f9
-    f9_addr_a = addr_a;
-    f9_addr_a.column += offsetof(IMDBRow, f9) / kCellSize;
-#ifdef DEBUG
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-            GenColAddr(f9_addr_a), f9_addr_a.highrow, f9_addr_a.bank,
-            f9_addr_a.channel, f9_addr_a.lowrow, f9_addr_a.column,
-            f9_addr_a.intrabus);
-#else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f9_addr_a));
-#endif
-  }
-  for(int i = 0; i < num_tuples; i += stride) {
-    curr_col_addr_b = CalTupleColAddrLayout2(i, tuple_size, base_col_addr_b);
-    ParseColAddr(curr_col_addr_b, addr_b);
-    // Calculate the column address of the table-a.f9 and table-b.f9
-    f9_addr_b = addr_b;
-    f9_addr_b.column += offsetof(IMDBRow, f9) / kCellSize;
-#ifdef DEBUG
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-            GenColAddr(f9_addr_b), f9_addr_b.highrow, f9_addr_b.bank,
-            f9_addr_b.channel, f9_addr_b.lowrow, f9_addr_b.column,
-            f9_addr_b.intrabus);
-#else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f9_addr_b));
-#endif
-  }
-
-  // compare table-a.f9 and table-b.f9 first, if success, then row_read the table-a.f3, and table-b.f4
-  for(int i = 0; i < num_tuples; i++)
-  {
-    if(i % 10 < THRESHOLD)
-    {
-      continue;
-    }
-    uint32_t temp_col_a = CalTupleColAddrLayout2(i, tuple_size, base_col_addr_a);
-    uint32_t curr_row_addr_a = ColAddr2RowAddr(temp_col_a);
-    curr_row_addr_a = GetCacheLineAddr(curr_row_addr_a);
-    uint32_t temp_col_b = CalTupleColAddrLayout2(i, tuple_size, base_col_addr_b);
-    uint32_t curr_row_addr_b = ColAddr2RowAddr(temp_col_b);
-    curr_row_addr_b = GetCacheLineAddr(curr_row_addr_b);
-#ifdef DEBUG
-    //Address addr;
-    ParseRowAddr(curr_row_addr_a, addr_a);
-    ParseRowAddr(curr_row_addr_b, addr_b);
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_R,
-           curr_row_addr_a, addr_a.highrow, addr_a.bank,
-           addr_a.channel, addr_a.lowrow, addr_a.column, addr_a.intrabus);
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_R,
-           curr_row_addr_b, addr_b.highrow, addr_b.bank,
-           addr_b.channel, addr_b.lowrow, addr_b.column, addr_b.intrabus);
-#else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_R,
-           curr_row_addr_a);
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_R,
-           curr_row_addr_b);
-#endif
-  } 
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  base_col_addr_b = GetCacheLineAddr(base_col_addr_b);
+  printf("Base column address for table-a: 0x%08llx\n",
+         (unsigned long long)base_col_addr_a);
+  printf("Base column address for table-b: 0x%08llx\n",
+         (unsigned long long)base_col_addr_b);
+  if (GetJoinMethod().kind != kJoinByTuple) {
+    printf("Base column address for the %s: 0x%08llx\n",
+           GetJoinMethod().kind == kJoinHash ? "hash table" : "sorted runs",
+           (unsigned long long)kOLXPJoinAddr);
+  }
+
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr_a);
+  AddPlanTable(&plan, base_col_addr_b);
+  AddOLXPQuery(&plan, 9);
+  return GenPlanTrace(trace_file_name, plan, kRCNVM);
 }
 
 
@@ -811,80 +310,17 @@ int GenHybTrace_8(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenHybTrace_9(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
+int GenHybTrace_9(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenHybTrace_9 is running, Select f3,f4 from table-a where f1 > x and f9 < y.\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_C = "r";
-  const char *op_R = "R";
-
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
-  //base_row_addr = GetCacheLineAddr(base_row_addr);
-
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f1_addr = {};
-  Address f9_addr = {};
-
-  int stride =  kCachelineSize / kCellSize;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-  // col read f1, f9 first
-  for(int i = 0; i < num_tuples; i += stride) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of the f1 and f9 elements
-    f1_addr = addr;
-    f9_addr = addr;
-    f1_addr.column += offsetof(IMDBRow, f1) / kCellSize;
-    f9_addr.column += offsetof(IMDBRow, f9) / kCellSize;
-#ifdef DEBUG
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-            GenColAddr(f1_addr), f1_addr.highrow, f1_addr.bank,
-            f1_addr.channel, f1_addr.lowrow, f1_addr.column,
-            f1_addr.intrabus);
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-            GenColAddr(f9_addr), f9_addr.highrow, f9_addr.bank,
-            f9_addr.channel, f9_addr.lowrow, f9_addr.column,
-            f9_addr.intrabus);
-#else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f1_addr));
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f9_addr));
-#endif
-
-    // for each line in of the data in this cacheline, compare f1 and f9 first, if success, then row_read the f3,f4
-    for(int j = 0; j < stride; j++)
-    {
-    	if((i + j) % 10 < THRESHOLD)
-    	{
-    		continue;
-    	}
-    	uint32_t temp_col = CalTupleColAddrLayout2(i + j, tuple_size, base_col_addr);
-    	uint32_t curr_row_addr = ColAddr2RowAddr(temp_col);
-        curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-      	//Address addr;
-      	ParseRowAddr(curr_row_addr, addr);
-      	dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-      	cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-      	++num_traces;
-    } 
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 10);
+  return GenPlanTrace(trace_file_name, plan, kRCNVM);
 }
 
 
@@ -908,80 +344,17 @@ int GenHybTrace_9(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenHybTrace_10(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
+int GenHybTrace_10(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenHybTrace_10 is running, Select f3,f4 from table-a where f1 > x and f2 < y.\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_C = "r";
-  const char *op_R = "R";
-
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
-  //base_row_addr = GetCacheLineAddr(base_row_addr);
-
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f1_addr = {};
-  Address f2_addr = {};
-
-  int stride =  kCachelineSize / kCellSize;
-
-  // col read f1, f2 first
-  for(int i = 0; i < num_tuples; i += stride) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of the f1 and f2 elements
-    f1_addr = addr;
-    f2_addr = addr;
-    f1_addr.column += offsetof(IMDBRow, f1) / kCellSize;
-    f2_addr.column += offsetof(IMDBRow, f2) / kCellSize;
-#ifdef DEBUG
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-            GenColAddr(f1_addr), f1_addr.highrow, f1_addr.bank,
-            f1_addr.channel, f1_addr.lowrow, f1_addr.column,
-            f1_addr.intrabus);
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-            GenColAddr(f2_addr), f2_addr.highrow, f2_addr.bank,
-            f2_addr.channel, f2_addr.lowrow, f2_addr.column,
-            f2_addr.intrabus);
-#else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f1_addr));
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f2_addr));
-#endif
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-    // for each line in of the data in this cacheline, compare f1 and f2 first, if success, then row_read the f3,f4
-    for(int j = 0; j < stride; j++)
-    {
-    	if((i + j) % 10 < THRESHOLD)
-    	{
-    		continue;
-    	}
-    	uint32_t temp_col = CalTupleColAddrLayout2(i + j, tuple_size, base_col_addr);
-    	uint32_t curr_row_addr = ColAddr2RowAddr(temp_col);
-	curr_row_addr = GetCacheLineAddr(curr_row_addr);
-#ifdef DEBUG
-      	//Address addr;
-      	ParseRowAddr(curr_row_addr, addr);
-      	dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op_R,
-              curr_row_addr, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
-#else
-      	cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
-              curr_row_addr);
-#endif
-      	++num_traces;
-    } 
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 11);
+  return GenPlanTrace(trace_file_name, plan, kRCNVM);
 }
 
 
@@ -1004,11 +377,11 @@ int GenHybTrace_10(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenHybTrace_11(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr, int L3_size) {
+int GenHybTrace_11(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr, int L3_size) {
   printf("GenHybTrace_11 is running, Select f3,f4 from table-a where f10 > x | use L3 cache to speed up.\n");
   // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
+  TraceWriter *fp = OpenTraceWriter(trace_file_name);
   if (fp == NULL) return kFailure;
 
   // how many cache lines can stored in L3  
@@ -1018,14 +391,14 @@ int GenHybTrace_11(const char* trace_file_name, int num_tuples, int tuple_size,
   const char *op_R = "R";
 
   //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
+  int64_t num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
   //base_row_addr = GetCacheLineAddr(base_row_addr);
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
+  uint64_t curr_col_addr = base_col_addr;
   Address addr = {};
   Address f10_addr = {};
 
@@ -1034,7 +407,7 @@ int GenHybTrace_11(const char* trace_file_name, int num_tuples, int tuple_size,
   num_cacheline = (int) (num_cacheline / (1 + stride * THRESHOLD / 10));
 
   // col read f10 first
-  for(int i = 0; i < num_tuples; i += stride * num_cacheline) {
+  for(int64_t i = 0; i < num_tuples; i += stride * num_cacheline) {
     for(int k = 0; k < num_cacheline; k++)
     {
     curr_col_addr = CalTupleColAddrLayout2(i + k * stride, tuple_size, base_col_addr);
@@ -1048,7 +421,7 @@ int GenHybTrace_11(const char* trace_file_name, int num_tuples, int tuple_size,
             f10_addr.channel, f10_addr.lowrow, f10_addr.column,
             f10_addr.intrabus);
 #else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f10_addr));
+    cprintf(fp, num_traces++, op_C, GenColAddr(f10_addr));
 #endif
     }
     // for each line in of the data in this cacheline, compare f10 first, if success, then row_read the f3,f4
@@ -1060,8 +433,8 @@ int GenHybTrace_11(const char* trace_file_name, int num_tuples, int tuple_size,
     		{	
     			continue;
     		}
-    		uint32_t temp_col = CalTupleColAddrLayout2(i + k * stride + j, tuple_size, base_col_addr);
-    		uint32_t curr_row_addr = ColAddr2RowAddr(temp_col);
+    		uint64_t temp_col = CalTupleColAddrLayout2(i + k * stride + j, tuple_size, base_col_addr);
+    		uint64_t curr_row_addr = ColAddr2RowAddr(temp_col);
 		curr_row_addr = GetCacheLineAddr(curr_row_addr);
 #ifdef DEBUG
       		ParseRowAddr(curr_row_addr, addr);
@@ -1069,16 +442,15 @@ int GenHybTrace_11(const char* trace_file_name, int num_tuples, int tuple_size,
               	curr_row_addr, addr.highrow, addr.bank,
               	addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-      		cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
+      		cprintf(fp, num_traces, op_R,
      	        curr_row_addr);
 #endif
       		++num_traces;
     	}
     } 
   }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  printf("Total number of traces: %lld\n", (long long)num_traces);
+  return CloseTraceWriter(fp);
 }
 
 // Generates hybrid query trace in hybrid addressing, begin with a base address.
@@ -1111,14 +483,14 @@ int GenHybTrace_12(const char* trace_file_name, int num_query, int r_ratio, int
   }
 
   // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
+  TraceWriter *fp = OpenTraceWriter(trace_file_name);
   if (fp == NULL){
     fclose(data);
     return kFailure;
   }
 
   int op, pos;
-  int num_traces = 0;
+  int64_t num_traces = 0;
   while (fscanf(data, "%d %d", &op, &pos) > 0){
     pos = GetCacheLineAddr(pos);
     Address addr = {};
@@ -1131,7 +503,7 @@ int GenHybTrace_12(const char* trace_file_name, int num_query, int r_ratio, int
               pos, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-      	cprintf(fp, "%d %s 0x%08x 0 0\n", ++num_traces, "R", pos);
+      	cprintf(fp, ++num_traces, "R", pos);
 #endif
         break;
       case 1:
@@ -1141,7 +513,7 @@ int GenHybTrace_12(const char* trace_file_name, int num_query, int r_ratio, int
               pos, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-      	cprintf(fp, "%d %s 0x%08x 0 0\n", ++num_traces, "W", pos);
+      	cprintf(fp, ++num_traces, "W", pos);
 #endif
         break;
       case 2:
@@ -1152,7 +524,7 @@ int GenHybTrace_12(const char* trace_file_name, int num_query, int r_ratio, int
                 addr.channel, addr.lowrow, addr.column,
                 addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, "r", GenColAddr(addr));
+        cprintf(fp, num_traces++, "r", GenColAddr(addr));
 #endif
             break;
       case 3:
@@ -1163,16 +535,15 @@ int GenHybTrace_12(const char* trace_file_name, int num_query, int r_ratio, int
                 addr.channel, addr.lowrow, addr.column,
                 addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, "w", GenColAddr(addr));
+        cprintf(fp, num_traces++, "w", GenColAddr(addr));
 #endif
         break;
     } 
   }
-  printf("Total number of traces: %d\n", num_traces);
+  printf("Total number of traces: %lld\n", (long long)num_traces);
 
   fclose(data);
-  fclose(fp);
-  return kSuccess;
+  return CloseTraceWriter(fp);
 }
 
 // Generates hybrid query trace in hybrid addressing, begin with a base address.
@@ -1196,53 +567,18 @@ int GenHybTrace_12(const char* trace_file_name, int num_query, int r_ratio, int
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenHybTrace_13(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr, int prefetch_size) {
+int GenHybTrace_13(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr, int prefetch_size) {
   printf("GenHybTrace_13 is running, Select f3 from table-a (f3 is a wide column).\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_C = "r";
-
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
-  //base_row_addr = GetCacheLineAddr(base_row_addr);
-
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f3_addr = {};
-
-  int stride =  kCachelineSize / kCellSize;
-  int column_num = (offsetof(IMDBOverCLRow, f4) - offsetof(IMDBOverCLRow, f3)) / kCellSize;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-  // col read f3a and f3b
-  for(int i = 0; i < num_tuples; i += stride * prefetch_size) {
-    for (int k = 0; k < column_num; k ++){
-      for (int j = 0; j < prefetch_size; j ++){
-        curr_col_addr = CalTupleColAddrLayout2(i + j * stride, tuple_size, base_col_addr);
-        ParseColAddr(curr_col_addr, addr);
-        // Calculate the column address of f3a and f3b
-        f3_addr = addr;
-        f3_addr.column += offsetof(IMDBOverCLRow, f3) / kCellSize + k;
-#ifdef DEBUG
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-                GenColAddr(f3_addr), f3_addr.highrow, f3_addr.bank,
-                f3_addr.channel, f3_addr.lowrow, f3_addr.column,
-                f3_addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f3_addr));
-#endif
-      }
-    }
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  plan.prefetch_size = prefetch_size;
+  AddOLXPQuery(&plan, 14);
+  return GenPlanTrace(trace_file_name, plan, kRCNVM);
 }
 
 
@@ -1266,82 +602,18 @@ int GenHybTrace_13(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenHybTrace_14(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr, int prefetch_size) {
+int GenHybTrace_14(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr, int prefetch_size) {
   printf("GenHybTrace_14 is running, Select f3, f6, f10 from table-a.\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_C = "r";
-
-  //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
-  //base_row_addr = GetCacheLineAddr(base_row_addr);
-
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f3_addr = {};
-  Address f6_addr = {};
-  Address f10_addr = {};
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-  int stride =  kCachelineSize / kCellSize;
-
-  // col read f3a and f3b
-  for(int i = 0; i < num_tuples; i += stride * prefetch_size) {
-      for (int j = 0; j < prefetch_size; j ++){
-        curr_col_addr = CalTupleColAddrLayout2(i + j * stride, tuple_size, base_col_addr);
-        ParseColAddr(curr_col_addr, addr);
-        // Calculate the column address of f3a and f3b
-        f3_addr = addr;
-        f3_addr.column += offsetof(IMDBRow, f3) / kCellSize;
-#ifdef DEBUG
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-                GenColAddr(f3_addr), f3_addr.highrow, f3_addr.bank,
-                f3_addr.channel, f3_addr.lowrow, f3_addr.column,
-                f3_addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f3_addr));
-#endif
-      }
-      for (int j = 0; j < prefetch_size; j ++){
-        curr_col_addr = CalTupleColAddrLayout2(i + j * stride, tuple_size, base_col_addr);
-        ParseColAddr(curr_col_addr, addr);
-        // Calculate the column address of f3a and f3b
-        f6_addr = addr;
-        f6_addr.column += offsetof(IMDBRow, f6) / kCellSize;
-#ifdef DEBUG
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-                GenColAddr(f6_addr), f6_addr.highrow, f6_addr.bank,
-                f6_addr.channel, f6_addr.lowrow, f6_addr.column,
-                f6_addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f6_addr));
-#endif
-      }
-      for (int j = 0; j < prefetch_size; j ++){
-        curr_col_addr = CalTupleColAddrLayout2(i + j * stride, tuple_size, base_col_addr);
-        ParseColAddr(curr_col_addr, addr);
-        // Calculate the column address of f3a and f3b
-        f10_addr = addr;
-        f10_addr.column += offsetof(IMDBRow, f10) / kCellSize;
-#ifdef DEBUG
-        dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-                GenColAddr(f10_addr), f10_addr.highrow, f10_addr.bank,
-                f10_addr.channel, f10_addr.lowrow, f10_addr.column,
-                f10_addr.intrabus);
-#else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f10_addr));
-#endif
-      }
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  plan.prefetch_size = prefetch_size;
+  AddOLXPQuery(&plan, 15);
+  return GenPlanTrace(trace_file_name, plan, kRCNVM);
 }
 
 // Generates hybrid query trace in hybrid addressing, begin with a base address.
@@ -1365,40 +637,40 @@ int GenHybTrace_14(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenHybTrace_15(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr, int prefetch_size) {
+int GenHybTrace_15(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr, int prefetch_size) {
 
   printf("GenHybTrace_15 is running, Select f1,f9 from table a, where f1 is a 64B wide col .\n");
   // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
+  TraceWriter *fp = OpenTraceWriter(trace_file_name);
   if (fp == NULL) return kFailure;
 
   const char *op_C = "r";
   const char *op_R = "R";
 
   //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
+  int64_t num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
   //base_row_addr = GetCacheLineAddr(base_row_addr);
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
+  uint64_t curr_col_addr = base_col_addr;
   Address addr = {};
   Address f9_addr = {};
 
   int stride =  kCachelineSize / kCellSize;
 
   // col read f10 first
-  for(int i = 0; i < num_tuples; i += stride * prefetch_size) {
+  for(int64_t i = 0; i < num_tuples; i += stride * prefetch_size) {
     // for each line in of the data in this cacheline, compare f10 first, if success, then row_read the f3,f4
     for(int k = 0; k < prefetch_size; k++)
     {
     	for(int j = 0; j < stride; j++)
     	{
-    		uint32_t temp_col = CalTupleColAddrLayout2(i + k * stride + j, tuple_size, base_col_addr);
-    		uint32_t curr_row_addr = ColAddr2RowAddr(temp_col);
+    		uint64_t temp_col = CalTupleColAddrLayout2(i + k * stride + j, tuple_size, base_col_addr);
+    		uint64_t curr_row_addr = ColAddr2RowAddr(temp_col);
 		curr_row_addr = GetCacheLineAddr(curr_row_addr);
 #ifdef DEBUG
       		ParseRowAddr(curr_row_addr, addr);
@@ -1406,7 +678,7 @@ int GenHybTrace_15(const char* trace_file_name, int num_tuples, int tuple_size,
               	curr_row_addr, addr.highrow, addr.bank,
               	addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-      		cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
+      		cprintf(fp, num_traces, op_R,
      	        curr_row_addr);
 #endif
       		++num_traces;
@@ -1425,13 +697,12 @@ int GenHybTrace_15(const char* trace_file_name, int num_tuples, int tuple_size,
             f9_addr.channel, f9_addr.lowrow, f9_addr.column,
             f9_addr.intrabus);
 #else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f9_addr));
+    cprintf(fp, num_traces++, op_C, GenColAddr(f9_addr));
 #endif
     }
   }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  printf("Total number of traces: %lld\n", (long long)num_traces);
+  return CloseTraceWriter(fp);
 }
 
 
@@ -1456,32 +727,32 @@ int GenHybTrace_15(const char* trace_file_name, int num_tuples, int tuple_size,
 // Assume Tuple 1 is in Column 0
 // 
 // More complex version for Trace 1
-int GenHybTrace_16(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
+int GenHybTrace_16(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenHybTrace_16 is running, Select  f1,f2,f3,f4,f5,f6,f7,f8,f9f3,f10,f11,f12,f13,f14,f15,f16,  from table-a where f19 > x .\n");
   // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
+  TraceWriter *fp = OpenTraceWriter(trace_file_name);
   if (fp == NULL) return kFailure;
 
   const char *op_C = "r";
   const char *op_R = "R";
 
   //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
+  int64_t num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
   //base_row_addr = GetCacheLineAddr(base_row_addr);
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
+  uint64_t curr_col_addr = base_col_addr;
   Address addr = {};
   Address f19_addr = {};
 
   int stride =  kCachelineSize / kCellSize;
 
   // col read f10 first
-  for(int i = 0; i < num_tuples; i += stride) {
+  for(int64_t i = 0; i < num_tuples; i += stride) {
     curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
     ParseColAddr(curr_col_addr, addr);
     // Calculate the column address of the f3 and f10 elements
@@ -1493,7 +764,7 @@ int GenHybTrace_16(const char* trace_file_name, int num_tuples, int tuple_size,
             f19_addr.channel, f19_addr.lowrow, f19_addr.column,
             f19_addr.intrabus);
 #else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f19_addr));
+    cprintf(fp, num_traces++, op_C, GenColAddr(f19_addr));
 #endif
 
     // for each line in of the data in this cacheline, compare f10 first, if success, then row_read the f3,f4
@@ -1503,8 +774,8 @@ int GenHybTrace_16(const char* trace_file_name, int num_tuples, int tuple_size,
     	{
     		continue;
     	}
-    	uint32_t temp_col = CalTupleColAddrLayout2(i + j, tuple_size, base_col_addr);
-    	uint32_t curr_row_addr = ColAddr2RowAddr(temp_col);
+    	uint64_t temp_col = CalTupleColAddrLayout2(i + j, tuple_size, base_col_addr);
+    	uint64_t curr_row_addr = ColAddr2RowAddr(temp_col);
 	curr_row_addr = GetCacheLineAddr(curr_row_addr);
 #ifdef DEBUG
       	ParseRowAddr(curr_row_addr, addr);
@@ -1512,7 +783,7 @@ int GenHybTrace_16(const char* trace_file_name, int num_tuples, int tuple_size,
               curr_row_addr, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-      	cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
+      	cprintf(fp, num_traces, op_R,
               curr_row_addr);
 #endif
       	++num_traces;
@@ -1523,15 +794,14 @@ int GenHybTrace_16(const char* trace_file_name, int num_tuples, int tuple_size,
               curr_row_addr, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-      	cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
+      	cprintf(fp, num_traces, op_R,
               curr_row_addr);
 #endif
       	++num_traces;
     } 
   }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  printf("Total number of traces: %lld\n", (long long)num_traces);
+  return CloseTraceWriter(fp);
 }
 
 // Generates hybrid query trace in hybrid addressing, begin with a base address.
@@ -1555,32 +825,32 @@ int GenHybTrace_16(const char* trace_file_name, int num_tuples, int tuple_size,
 // Assume Tuple 1 is in Column 0
 //
 // More complex version for trace 2
-int GenHybTrace_17(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
+int GenHybTrace_17(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenHybTrace_17 is running, Select * from table-a where f10 > x .\n");
   // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
+  TraceWriter *fp = OpenTraceWriter(trace_file_name);
   if (fp == NULL) return kFailure;
 
   const char *op_C = "r";
   const char *op_R = "R";
 
   //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
+  int64_t num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
   //base_row_addr = GetCacheLineAddr(base_row_addr);
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
+  uint64_t curr_col_addr = base_col_addr;
   Address addr = {};
   Address f10_addr = {};
 
   int stride =  kCachelineSize / kCellSize;
 
   // col read f10 first
-  for(int i = 0; i < num_tuples; i += stride) {
+  for(int64_t i = 0; i < num_tuples; i += stride) {
     curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
     ParseColAddr(curr_col_addr, addr);
     // Calculate the column address of the f3 and f10 elements
@@ -1592,7 +862,7 @@ int GenHybTrace_17(const char* trace_file_name, int num_tuples, int tuple_size,
             f10_addr.channel, f10_addr.lowrow, f10_addr.column,
             f10_addr.intrabus);
 #else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f10_addr));
+    cprintf(fp, num_traces++, op_C, GenColAddr(f10_addr));
 #endif
 
     // for each line in of the data in this cacheline, compare f10 first, if success, then row_read the f3,f4
@@ -1602,8 +872,8 @@ int GenHybTrace_17(const char* trace_file_name, int num_tuples, int tuple_size,
       {
         continue;
       }
-      uint32_t temp_col = CalTupleColAddrLayout2(i + j, tuple_size, base_col_addr);
-      uint32_t curr_row_addr = ColAddr2RowAddr(temp_col);
+      uint64_t temp_col = CalTupleColAddrLayout2(i + j, tuple_size, base_col_addr);
+      uint64_t curr_row_addr = ColAddr2RowAddr(temp_col);
       curr_row_addr = GetCacheLineAddr(curr_row_addr);
  	for(int k = 0; k < tuple_size / kCachelineSize; k++)
 	{
@@ -1613,7 +883,7 @@ int GenHybTrace_17(const char* trace_file_name, int num_tuples, int tuple_size,
               curr_row_addr, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
+        cprintf(fp, num_traces, op_R,
               curr_row_addr);
 #endif
         ++num_traces;
@@ -1621,9 +891,8 @@ int GenHybTrace_17(const char* trace_file_name, int num_tuples, int tuple_size,
 	}
     } 
   }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  printf("Total number of traces: %lld\n", (long long)num_traces);
+  return CloseTraceWriter(fp);
 }
 
 // Generates hybrid query trace in hybrid addressing, begin with a base address.
@@ -1648,24 +917,24 @@ int GenHybTrace_17(const char* trace_file_name, int num_tuples, int tuple_size,
 // Assume Tuple 1 is in Column 0
 //
 // More complex version for trace 14
-int GenHybTrace_18(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr, int prefetch_size) {
+int GenHybTrace_18(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr, int prefetch_size) {
   printf("GenHybTrace_18 is running, Select f3, f10, f19, f29 from table-a.\n");
   // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
+  TraceWriter *fp = OpenTraceWriter(trace_file_name);
   if (fp == NULL) return kFailure;
 
   const char *op_C = "r";
 
   //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
+  int64_t num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
   //base_row_addr = GetCacheLineAddr(base_row_addr);
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
+  uint64_t curr_col_addr = base_col_addr;
   Address addr = {};
   Address f3_addr = {};
   Address f9_addr = {};
@@ -1674,7 +943,7 @@ int GenHybTrace_18(const char* trace_file_name, int num_tuples, int tuple_size,
 
   int stride =  kCachelineSize / kCellSize;
 
-  for(int i = 0; i < num_tuples; i += stride * prefetch_size) {
+  for(int64_t i = 0; i < num_tuples; i += stride * prefetch_size) {
       for (int j = 0; j < prefetch_size; j ++){
         curr_col_addr = CalTupleColAddrLayout2(i + j * stride, tuple_size, base_col_addr);
         ParseColAddr(curr_col_addr, addr);
@@ -1686,7 +955,7 @@ int GenHybTrace_18(const char* trace_file_name, int num_tuples, int tuple_size,
                 f3_addr.channel, f3_addr.lowrow, f3_addr.column,
                 f3_addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f3_addr));
+        cprintf(fp, num_traces++, op_C, GenColAddr(f3_addr));
 #endif
       }
       for (int j = 0; j < prefetch_size; j ++){
@@ -1700,7 +969,7 @@ int GenHybTrace_18(const char* trace_file_name, int num_tuples, int tuple_size,
                 f9_addr.channel, f9_addr.lowrow, f9_addr.column,
                 f9_addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f9_addr));
+        cprintf(fp, num_traces++, op_C, GenColAddr(f9_addr));
 #endif
       }
       for (int j = 0; j < prefetch_size; j ++){
@@ -1714,7 +983,7 @@ int GenHybTrace_18(const char* trace_file_name, int num_tuples, int tuple_size,
                 f19_addr.channel, f19_addr.lowrow, f19_addr.column,
                 f19_addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f19_addr));
+        cprintf(fp, num_traces++, op_C, GenColAddr(f19_addr));
 #endif
       }
       for (int j = 0; j < prefetch_size; j ++){
@@ -1728,13 +997,12 @@ int GenHybTrace_18(const char* trace_file_name, int num_tuples, int tuple_size,
                 f29_addr.channel, f29_addr.lowrow, f29_addr.column,
                 f29_addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f29_addr));
+        cprintf(fp, num_traces++, op_C, GenColAddr(f29_addr));
 #endif
       }
   }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  printf("Total number of traces: %lld\n", (long long)num_traces);
+  return CloseTraceWriter(fp);
 }
 
 // Generates hybrid query trace in hybrid addressing, begin with a base address.
@@ -1760,25 +1028,25 @@ int GenHybTrace_18(const char* trace_file_name, int num_tuples, int tuple_size,
 // Assume Tuple 1 is in Column 0
 //
 // More complex version for trace 15
-int GenHybTrace_19(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr, int prefetch_size) {
+int GenHybTrace_19(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr, int prefetch_size) {
 
   printf("GenHybTrace_19 is running, Select f1,f9, f19, f29, f39 from table a.\n");
   // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
+  TraceWriter *fp = OpenTraceWriter(trace_file_name);
   if (fp == NULL) return kFailure;
 
   const char *op_C = "r";
 
   //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
+  int64_t num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
   //base_row_addr = GetCacheLineAddr(base_row_addr);
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
+  uint64_t curr_col_addr = base_col_addr;
   Address addr = {};
   Address f3_addr = {};
   Address f9_addr = {};
@@ -1788,7 +1056,7 @@ int GenHybTrace_19(const char* trace_file_name, int num_tuples, int tuple_size,
 
   int stride =  kCachelineSize / kCellSize;
 
-  for(int i = 0; i < num_tuples; i += stride * prefetch_size) {
+  for(int64_t i = 0; i < num_tuples; i += stride * prefetch_size) {
       for (int j = 0; j < prefetch_size; j ++){
         curr_col_addr = CalTupleColAddrLayout2(i + j * stride, tuple_size, base_col_addr);
         ParseColAddr(curr_col_addr, addr);
@@ -1800,7 +1068,7 @@ int GenHybTrace_19(const char* trace_file_name, int num_tuples, int tuple_size,
                 f3_addr.channel, f3_addr.lowrow, f3_addr.column,
                 f3_addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f3_addr));
+        cprintf(fp, num_traces++, op_C, GenColAddr(f3_addr));
 #endif
       }
       for (int j = 0; j < prefetch_size; j ++){
@@ -1814,7 +1082,7 @@ int GenHybTrace_19(const char* trace_file_name, int num_tuples, int tuple_size,
                 f9_addr.channel, f9_addr.lowrow, f9_addr.column,
                 f9_addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f9_addr));
+        cprintf(fp, num_traces++, op_C, GenColAddr(f9_addr));
 #endif
       }
       for (int j = 0; j < prefetch_size; j ++){
@@ -1828,7 +1096,7 @@ int GenHybTrace_19(const char* trace_file_name, int num_tuples, int tuple_size,
                 f19_addr.channel, f19_addr.lowrow, f19_addr.column,
                 f19_addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f19_addr));
+        cprintf(fp, num_traces++, op_C, GenColAddr(f19_addr));
 #endif
       }
       for (int j = 0; j < prefetch_size; j ++){
@@ -1842,7 +1110,7 @@ int GenHybTrace_19(const char* trace_file_name, int num_tuples, int tuple_size,
                 f29_addr.channel, f29_addr.lowrow, f29_addr.column,
                 f29_addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f29_addr));
+        cprintf(fp, num_traces++, op_C, GenColAddr(f29_addr));
 #endif
       }
       for (int j = 0; j < prefetch_size; j ++){
@@ -1856,13 +1124,12 @@ int GenHybTrace_19(const char* trace_file_name, int num_tuples, int tuple_size,
                 f39_addr.channel, f39_addr.lowrow, f39_addr.column,
                 f39_addr.intrabus);
 #else
-        cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f39_addr));
+        cprintf(fp, num_traces++, op_C, GenColAddr(f39_addr));
 #endif
       }
   }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  printf("Total number of traces: %lld\n", (long long)num_traces);
+  return CloseTraceWriter(fp);
 }
 
 // Generates hybrid query trace in hybrid addressing, begin with a base address.
@@ -1883,25 +1150,25 @@ int GenHybTrace_19(const char* trace_file_name, int num_tuples, int tuple_size,
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
 // mix of col read and row read
-int GenHybTrace_20(const char* trace_file_name, int num_tuples, int tuple_size,
-		  uint32_t base_col_addr, int row_rate, int col_rate) {
+int GenHybTrace_20(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+		  uint64_t base_col_addr, int row_rate, int col_rate) {
   printf("GenHybTrace_20 is running, Mix col read with row read Row Select f1 from table a, Col Select f10 from table a. The rate is Row:Col =  %d : %d.\n",row_rate,col_rate);
 
-  FILE *fp = fopen(trace_file_name, "w");
+  TraceWriter *fp = OpenTraceWriter(trace_file_name);
   if (fp == NULL) return kFailure;
 
   const char *op_C = "r";
   const char *op_R = "R";
 
   //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
+  int64_t num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  uint32_t curr_col_addr2 = base_col_addr;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
+  uint64_t curr_col_addr = base_col_addr;
+  uint64_t curr_col_addr2 = base_col_addr;
   Address addr = {};
   Address f10_addr = {};
 
@@ -1910,7 +1177,7 @@ int GenHybTrace_20(const char* trace_file_name, int num_tuples, int tuple_size,
   int col_tuple_count = 0;
   // col read f10 first
 
-  for(int i = 0; i < num_tuples; i ++) {
+  for(int64_t i = 0; i < num_tuples; i ++) {
    if((i % (row_rate + col_rate)) < col_rate)
 {
     curr_col_addr = CalTupleColAddrLayout2(col_tuple_count, tuple_size, base_col_addr);
@@ -1925,13 +1192,13 @@ int GenHybTrace_20(const char* trace_file_name, int num_tuples, int tuple_size,
             f10_addr.channel, f10_addr.lowrow, f10_addr.column,
             f10_addr.intrabus);
 #else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f10_addr));
+    cprintf(fp, num_traces++, op_C, GenColAddr(f10_addr));
 #endif
 }
 else
 {	// for each line in of the data in this cacheline, compare f10 first, if success, then row_read the f3,f4
 	curr_col_addr2 = CalTupleColAddrLayout2(row_tuple_count++, tuple_size, base_col_addr);
-    	uint32_t curr_row_addr = ColAddr2RowAddr(curr_col_addr2);
+    	uint64_t curr_row_addr = ColAddr2RowAddr(curr_col_addr2);
 	curr_row_addr = GetCacheLineAddr(curr_row_addr);
 	
 #ifdef DEBUG
@@ -1940,15 +1207,14 @@ else
               curr_row_addr, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-      	cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
+      	cprintf(fp, num_traces, op_R,
               curr_row_addr);
 #endif
       	++num_traces;
 	}
 } 
-printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+printf("Total number of traces: %lld\n", (long long)num_traces);
+  return CloseTraceWriter(fp);
 }
 
 // Generates hybrid query trace in hybrid addressing, begin with a base address.
@@ -1969,25 +1235,25 @@ printf("Total number of traces: %d\n", num_traces);
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
 // mix of col read and row read
-int GenHybTrace_21(const char* trace_file_name, int num_tuples, int tuple_size,
-		  uint32_t base_col_addr, int row_rate, int col_rate) {
+int GenHybTrace_21(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+		  uint64_t base_col_addr, int row_rate, int col_rate) {
   printf("GenHybTrace_21 is running, Mix col read with row read Row Set f1 from table a, Col Set f10 from table a. The rate is Row:Col =  %d : %d.\n",row_rate,col_rate);
 
-  FILE *fp = fopen(trace_file_name, "w");
+  TraceWriter *fp = OpenTraceWriter(trace_file_name);
   if (fp == NULL) return kFailure;
 
   const char *op_C = "w";
   const char *op_R = "W";
 
   //int tuples_in_one_col = kCachelineSize
-  int num_traces = 0;
+  int64_t num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  uint32_t curr_col_addr2 = base_col_addr;
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
+  uint64_t curr_col_addr = base_col_addr;
+  uint64_t curr_col_addr2 = base_col_addr;
   Address addr = {};
   Address f10_addr = {};
 
@@ -1996,7 +1262,7 @@ int GenHybTrace_21(const char* trace_file_name, int num_tuples, int tuple_size,
   int col_tuple_count = 0;
   // col read f10 first
 
-  for(int i = 0; i < num_tuples; i ++) {
+  for(int64_t i = 0; i < num_tuples; i ++) {
    if((i % (row_rate + col_rate)) < col_rate)
 {
     curr_col_addr = CalTupleColAddrLayout2(col_tuple_count, tuple_size, base_col_addr);
@@ -2011,13 +1277,13 @@ int GenHybTrace_21(const char* trace_file_name, int num_tuples, int tuple_size,
             f10_addr.channel, f10_addr.lowrow, f10_addr.column,
             f10_addr.intrabus);
 #else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f10_addr));
+    cprintf(fp, num_traces++, op_C, GenColAddr(f10_addr));
 #endif
 }
 else
 {	// for each line in of the data in this cacheline, compare f10 first, if success, then row_read the f3,f4
 	curr_col_addr2 = CalTupleColAddrLayout2(row_tuple_count++, tuple_size, base_col_addr);
-    	uint32_t curr_row_addr = ColAddr2RowAddr(curr_col_addr2);
+    	uint64_t curr_row_addr = ColAddr2RowAddr(curr_col_addr2);
 	curr_row_addr = GetCacheLineAddr(curr_row_addr);
 	
 #ifdef DEBUG
@@ -2026,15 +1292,14 @@ else
               curr_row_addr, addr.highrow, addr.bank,
               addr.channel, addr.lowrow, addr.column, addr.intrabus);
 #else
-      	cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op_R,
+      	cprintf(fp, num_traces, op_R,
               curr_row_addr);
 #endif
       	++num_traces;
 	}
 } 
-printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+printf("Total number of traces: %lld\n", (long long)num_traces);
+  return CloseTraceWriter(fp);
 }
 
 // Generates hybrid query trace in hybrid addressing, begin with a base address.
@@ -2057,61 +1322,17 @@ printf("Total number of traces: %d\n", num_traces);
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenHybTrace_22(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
+int GenHybTrace_22(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenHybTrace_22 is running, Select f9 from table-a where f10 > x\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_C = "r";
-
-  int num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f10_addr = {};
-  Address f9_addr = {};
-
-  int stride =  kCachelineSize / kCellSize;
-
-  for(int i = 0; i < num_tuples; i += stride) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of the f3 and f10 elements
-    f10_addr = addr;
-    f9_addr = addr;
-    f10_addr.column += offsetof(IMDBRow, f10) / kCellSize;
-    f9_addr.column += offsetof(IMDBRow, f9) / kCellSize;
-#ifdef DEBUG
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-            GenColAddr(f10_addr), f10_addr.highrow, f10_addr.bank,
-            f10_addr.channel, f10_addr.lowrow, f10_addr.column,
-            f10_addr.intrabus);
-#else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f10_addr));
-#endif
-
-  if(i % 10 < THRESHOLD)
-  {
-  	continue;
-  }
-#ifdef DEBUG
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-            GenColAddr(f9_addr), f9_addr.highrow, f9_addr.bank,
-            f9_addr.channel, f9_addr.lowrow, f9_addr.column,
-            f9_addr.intrabus);
-#else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f9_addr));
-#endif
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 4);
+  return GenPlanTrace(trace_file_name, plan, kRCNVM);
 }
 
 // Generates hybrid query trace in hybrid addressing, begin with a base address.
@@ -2134,61 +1355,17 @@ int GenHybTrace_22(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenHybTrace_23(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
+int GenHybTrace_23(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenHybTrace_23 is running, Select f1 from table-a where f10 > x | most of f10 is > x\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_C = "r";
-
-  int num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f10_addr = {};
-  Address f9_addr = {};
-
-  int stride =  kCachelineSize / kCellSize;
-
-  for(int i = 0; i < num_tuples; i += stride) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of the f3 and f10 elements
-    f10_addr = addr;
-    f9_addr = addr;
-    f10_addr.column += offsetof(IMDBRow, f10) / kCellSize;
-    f9_addr.column += offsetof(IMDBRow, f1) / kCellSize;
-#ifdef DEBUG
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-            GenColAddr(f10_addr), f10_addr.highrow, f10_addr.bank,
-            f10_addr.channel, f10_addr.lowrow, f10_addr.column,
-            f10_addr.intrabus);
-#else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f10_addr));
-#endif
-
-  if(i % 10 < THRESHOLD)
-  {
-  	continue;
-  }
-#ifdef DEBUG
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-            GenColAddr(f9_addr), f9_addr.highrow, f9_addr.bank,
-            f9_addr.channel, f9_addr.lowrow, f9_addr.column,
-            f9_addr.intrabus);
-#else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f9_addr));
-#endif
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 6);
+  return GenPlanTrace(trace_file_name, plan, kRCNVM);
 }
 
 
@@ -2212,60 +1389,37 @@ int GenHybTrace_23(const char* trace_file_name, int num_tuples, int tuple_size,
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
 // Assume Tuple 1 is in Column 0
-int GenHybTrace_24(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_col_addr) {
+int GenHybTrace_24(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
   printf("GenHybTrace_24 is running, Select f1 from table-a where f10 > x\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *op_C = "r";
-
-  int num_traces = 0;
 
   // 2 cache lines in 1 RAM row
   base_col_addr = GetCacheLineAddr(base_col_addr);
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
 
-  printf("Base column address: 0x%08x\n", base_col_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  Address addr = {};
-  Address f10_addr = {};
-  Address f9_addr = {};
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 7);
+  return GenPlanTrace(trace_file_name, plan, kRCNVM);
+}
 
-  int stride =  kCachelineSize / kCellSize;
+// Generates hybrid query trace in hybrid addressing, begin with a base address.
+// The acces pattern of the following SQL query:
+// Select f1, SUM(f9) from table-a group by f1
+//
+// The groups are summed up in a hash table at kOLXPGroupAddr, see
+// PlanGroupBy.
+int GenHybTrace_25(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_col_addr) {
+  printf("GenHybTrace_25 is running, Select f1, SUM(f9) from table-a group by f1\n");
 
-  for(int i = 0; i < num_tuples; i += stride) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    ParseColAddr(curr_col_addr, addr);
-    // Calculate the column address of the f3 and f10 elements
-    f10_addr = addr;
-    f9_addr = addr;
-    f10_addr.column += offsetof(IMDBRow, f10) / kCellSize;
-    f9_addr.column += offsetof(IMDBRow, f1) / kCellSize;
-#ifdef DEBUG
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-            GenColAddr(f10_addr), f10_addr.highrow, f10_addr.bank,
-            f10_addr.channel, f10_addr.lowrow, f10_addr.column,
-            f10_addr.intrabus);
-#else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f10_addr));
-#endif
+  // 2 cache lines in 1 RAM row
+  base_col_addr = GetCacheLineAddr(base_col_addr);
+  printf("Base column address: 0x%08llx\n", (unsigned long long)base_col_addr);
+  printf("Base column address for the hash table: 0x%08llx\n",
+         (unsigned long long)kOLXPGroupAddr);
 
-  if(i % 10 < THRESHOLD_LOW)
-  {
-  	continue;
-  }
-#ifdef DEBUG
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces++, op_C,
-            GenColAddr(f9_addr), f9_addr.highrow, f9_addr.bank,
-            f9_addr.channel, f9_addr.lowrow, f9_addr.column,
-            f9_addr.intrabus);
-#else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces++, op_C, GenColAddr(f9_addr));
-#endif
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  QueryPlan plan(num_tuples, tuple_size, base_col_addr);
+  AddOLXPQuery(&plan, 16);
+  return GenPlanTrace(trace_file_name, plan, kRCNVM);
 }
 
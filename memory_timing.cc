@@ -0,0 +1,194 @@
+/*
+ * memory_timing.cc
+ */
+
+#include "memory_timing.h"
+#include "addr_util.h"
+#include "gen_trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+static TimingModel g_timing_model = kRCNVMTiming;
+static bool g_timed_traces = false;
+
+void SetTimingModel(const TimingModel& model) {
+  g_timing_model = model;
+  g_timed_traces = true;
+}
+
+const TimingModel* GetTimingModel() {
+  return g_timed_traces ? &g_timing_model : NULL;
+}
+
+// Moves *p past preset if the name starts with it
+static bool SkipPreset(const char** p, const char* preset) {
+  size_t length = strlen(preset);
+  if (strncmp(*p, preset, length) != 0
+      || ((*p)[length] != '\0' && (*p)[length] != ',')) {
+    return false;
+  }
+  *p += length;
+  return true;
+}
+
+int ParseTimingModel(const char* name, TimingModel* model) {
+  TimingModel result = kRCNVMTiming;
+  const char* p = name;
+  if (SkipPreset(&p, "dram")) result = kDRAMTiming;
+  if (p != name || SkipPreset(&p, "default") || SkipPreset(&p, "rcnvm")) {
+    if (*p == '\0') {
+      *model = result;
+      return kSuccess;
+    }
+    p++;  // the ','
+  }
+  while (true) {
+    const char* eq = strchr(p, '=');
+    if (eq == NULL) return kFailure;
+    std::string key(p, eq - p);
+    char* end;
+    long value = strtol(eq + 1, &end, 10);
+    if (end == eq + 1 || value < 0 || value > 1 << 20) return kFailure;
+    if (key == "rcd") {
+      result.rcd[kRowBuffer] = (int)value;
+    } else if (key == "cl") {
+      result.cl[kRowBuffer] = (int)value;
+    } else if (key == "rp") {
+      result.rp[kRowBuffer] = (int)value;
+    } else if (key == "wr") {
+      result.wr[kRowBuffer] = (int)value;
+    } else if (key == "crcd") {
+      result.rcd[kColumnBuffer] = (int)value;
+    } else if (key == "ccl") {
+      result.cl[kColumnBuffer] = (int)value;
+    } else if (key == "crp") {
+      result.rp[kColumnBuffer] = (int)value;
+    } else if (key == "cwr") {
+      result.wr[kColumnBuffer] = (int)value;
+    } else if (key == "burst" && value >= 1) {
+      result.burst = (int)value;
+    } else if (key == "queue" && value >= 1) {
+      result.queue_depth = (int)value;
+    } else if (key == "ratio" && value >= 1) {
+      result.cpu_ratio = (int)value;
+    } else {
+      return kFailure;
+    }
+    p = end;
+    if (*p == '\0') break;
+    if (*p++ != ',') return kFailure;
+  }
+  *model = result;
+  return kSuccess;
+}
+
+std::string TimingModelName(const TimingModel& model) {
+  char name[192];
+  snprintf(name, sizeof(name),
+           "rcd=%d,cl=%d,rp=%d,wr=%d,crcd=%d,ccl=%d,crp=%d,cwr=%d,burst=%d,"
+           "queue=%d,ratio=%d",
+           model.rcd[kRowBuffer], model.cl[kRowBuffer], model.rp[kRowBuffer],
+           model.wr[kRowBuffer], model.rcd[kColumnBuffer],
+           model.cl[kColumnBuffer], model.rp[kColumnBuffer],
+           model.wr[kColumnBuffer], model.burst, model.queue_depth,
+           model.cpu_ratio);
+  return name;
+}
+
+MemoryTimer::MemoryTimer(const TimingModel& model)
+    : model_(model), cycles_(0), num_accesses_(0) {
+  int num_units = NumBufferUnits();
+  Bank closed = {kNumBufferKinds, 0, 0, 0, 0};
+  banks_.assign(num_units, closed);
+  BankTiming zero = {0, 0, 0};
+  timings_.assign(num_units, zero);
+  bus_free_.assign(1ull << GetDeviceGeometry().channel_bit, 0);
+  queue_.reserve(model_.queue_depth);
+}
+
+void MemoryTimer::Access(char op, uint64_t addr, int64_t arrival) {
+  Request request;
+  request.kind = DecodeBufferAccess(op, addr, &request.unit, &request.buffer);
+  request.write = op == 'W' || op == 'w';
+  request.arrival = arrival / model_.cpu_ratio;
+  queue_.push_back(request);
+  if ((int)queue_.size() >= model_.queue_depth) Serve();
+}
+
+void MemoryTimer::Finish() {
+  while (!queue_.empty()) Serve();
+}
+
+void MemoryTimer::Serve() {
+  // The oldest access to an open buffer that has arrived by the time the
+  // oldest access can be served goes first
+  size_t pick = 0;
+  int64_t now = std::max(queue_[0].arrival, banks_[queue_[0].unit].ready);
+  for (size_t i = 0; i < queue_.size(); i++) {
+    const Request& r = queue_[i];
+    const Bank& bank = banks_[r.unit];
+    if (r.arrival <= now && bank.kind == r.kind && bank.buffer == r.buffer) {
+      pick = i;
+      break;
+    }
+  }
+  Request r = queue_[pick];
+  queue_.erase(queue_.begin() + pick);
+
+  Bank& bank = banks_[r.unit];
+  BankTiming& timing = timings_[r.unit];
+  int64_t start = std::max(r.arrival, bank.ready);
+  int64_t command = start;
+  if (bank.kind == r.kind && bank.buffer == r.buffer) {
+    ++timing.hits;
+  } else {
+    if (bank.kind != kNumBufferKinds) {
+      command = std::max(command, bank.write_done + model_.wr[bank.kind]);
+      command += model_.rp[bank.kind];
+    }
+    command += model_.rcd[r.kind];
+    bank.kind = r.kind;
+    bank.buffer = r.buffer;
+  }
+  int64_t& bus_free = bus_free_[r.unit >> GetDeviceGeometry().bank_bit];
+  int64_t done = std::max(command + model_.cl[r.kind], bus_free)
+                 + model_.burst;
+  bus_free = done;
+  bank.ready = command + model_.burst;
+  if (r.write) bank.write_done = done;
+
+  // Accesses of a bank overlap; its busy time is their union
+  int64_t from = std::max(start, bank.busy_until);
+  if (done > from) timing.busy += done - from;
+  bank.busy_until = std::max(bank.busy_until, done);
+  ++timing.accesses;
+  ++num_accesses_;
+  cycles_ = std::max(cycles_, done);
+}
+
+std::string MemoryTimer::Report(const char* name) const {
+  uint64_t hits = 0;
+  for (size_t u = 0; u < timings_.size(); u++) hits += timings_[u].hits;
+  char line[256];
+  snprintf(line, sizeof(line),
+           "%s: %llu accesses in %lld memory cycles (%.2f per access, "
+           "%.1f%% buffer hits)\n", name,
+           (unsigned long long)num_accesses_, (long long)cycles_,
+           num_accesses_ > 0 ? (double)cycles_ / num_accesses_ : 0.0,
+           num_accesses_ > 0 ? 100.0 * hits / num_accesses_ : 0.0);
+  std::string report = line;
+  int bank_bit = GetDeviceGeometry().bank_bit;
+  for (size_t u = 0; u < timings_.size(); u++) {
+    const BankTiming& timing = timings_[u];
+    if (timing.accesses == 0) continue;
+    snprintf(line, sizeof(line),
+             "  channel %d bank %d: %llu accesses, busy %lld cycles (%.1f%%)"
+             "\n", (int)(u >> bank_bit), (int)(u & ((1 << bank_bit) - 1)),
+             (unsigned long long)timing.accesses, (long long)timing.busy,
+             100.0 * timing.busy / cycles_);
+    report += line;
+  }
+  return report;
+}
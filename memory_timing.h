@@ -0,0 +1,121 @@
+/*
+ * memory_timing.h
+ *
+ * Timing of the accesses of a trace in an RC-NVM or DRAM device, as a quick
+ * stand-in for a simulator run when layouts or prefetch sizes are compared.
+ * It is event-driven but far from cycle accurate: every bank keeps the buffer
+ * it opened last (open page, with the buffers of buffer_locality.h), a
+ * controller queue of queue_depth accesses is scheduled FR-FCFS, the oldest
+ * access that hits an open buffer first and the oldest access otherwise, and
+ * an access takes
+ *
+ *   hit:               tCL
+ *   closed bank:       tRCD + tCL
+ *   conflict, switch:  tRP + tRCD + tCL, and the precharge waits tWR after
+ *                      the last write of the bank
+ *
+ * with the timings of the kind of buffer it needs, then burst cycles on the
+ * data bus of its channel. Column commands to an open buffer are a burst
+ * apart. There is no refresh, no command bus and no limit on activations.
+ *
+ * The accesses arrive at the issue cycles of the CPU model when the writer
+ * has one (see cpu_model.h), scaled by cpu_ratio, and all at once otherwise.
+ */
+
+#ifndef MEMORY_TIMING_H_
+#define MEMORY_TIMING_H_
+
+#include "buffer_locality.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Memory cycles, per kind of buffer (BufferKind)
+struct TimingModel {
+  int rcd[kNumBufferKinds];  // activation to column command
+  int cl[kNumBufferKinds];   // column command to data
+  int rp[kNumBufferKinds];   // precharge
+  int wr[kNumBufferKinds];   // end of a write to precharge
+  int burst;                 // data bus cycles of a cache line
+  int queue_depth;           // accesses the scheduler picks from
+  int cpu_ratio;             // CPU cycles per memory cycle
+};
+
+// RC-NVM: cheap precharges, slow writes, and column activations slower than
+// row ones
+const TimingModel kRCNVMTiming = {
+  {18, 24}, {10, 10}, {3, 3}, {40, 40}, 4, 32, 4,
+};
+// DDR-like DRAM, for the DRAM traces; it has no column mode and the column
+// timings are the row ones
+const TimingModel kDRAMTiming = {
+  {14, 14}, {14, 14}, {14, 14}, {15, 15}, 4, 32, 4,
+};
+
+// Timing model of the traces, selected once from main; without one the
+// accesses are not timed
+void SetTimingModel(const TimingModel& model);
+const TimingModel* GetTimingModel();
+// "default" (kRCNVMTiming), "rcnvm" or "dram", optionally followed by a
+// comma-separated list of "<key>=<cycles>" with the keys rcd, cl, rp and wr
+// for row buffers, crcd, ccl, crp and cwr for column buffers, burst, queue
+// and ratio; or that list alone, which changes kRCNVMTiming. Returns
+// kFailure for anything else.
+int ParseTimingModel(const char* name, TimingModel* model);
+std::string TimingModelName(const TimingModel& model);
+
+// Busy time of a bank and channel unit (channel << bank_bit | bank)
+struct BankTiming {
+  uint64_t accesses;
+  uint64_t hits;
+  int64_t busy;  // cycles with an access of the bank in service
+};
+
+// The banks of the selected geometry, timed over the accesses of one trace
+class MemoryTimer {
+ public:
+  explicit MemoryTimer(const TimingModel& model);
+
+  // Queues an access that arrives at CPU cycle arrival and serves the queue
+  // down to queue_depth - 1 accesses
+  void Access(char op, uint64_t addr, int64_t arrival);
+  // Serves the accesses left in the queue
+  void Finish();
+
+  // Memory cycle the last access completed
+  int64_t cycles() const { return cycles_; }
+  uint64_t num_accesses() const { return num_accesses_; }
+  const std::vector<BankTiming>& banks() const { return timings_; }
+  // Total cycles, the hit rate and the busy time of every unit that has
+  // accesses, a line each
+  std::string Report(const char* name) const;
+
+ private:
+  struct Request {
+    BufferKind kind;
+    bool write;
+    int unit;
+    uint64_t buffer;
+    int64_t arrival;
+  };
+
+  struct Bank {
+    BufferKind kind;      // kNumBufferKinds while closed
+    uint64_t buffer;
+    int64_t ready;        // the next column command may start
+    int64_t write_done;   // the data of the last write is in
+    int64_t busy_until;
+  };
+
+  void Serve();
+
+  TimingModel model_;
+  std::vector<Request> queue_;
+  std::vector<Bank> banks_;
+  std::vector<BankTiming> timings_;
+  std::vector<int64_t> bus_free_;  // per channel
+  int64_t cycles_;
+  uint64_t num_accesses_;
+};
+
+#endif /* MEMORY_TIMING_H_ */
@@ -0,0 +1,160 @@
+/*
+ * olxp_query.cc
+ *
+ * The OLXP workloads of README.md as query plans. A query over one table
+ * reads table 0 of the plan; the joins read table-a as table 0 and table-b as
+ * table 1, and hash joins build on table-a. Fields are looked up by name in
+ * the schema of the tables.
+ */
+
+#include "gen_trace.h"
+#include "query_plan.h"
+#include "addr_util.h"
+
+// Plan fields of the named fields of a schema; remembers whether one of them
+// is missing
+class SchemaFields {
+ public:
+  explicit SchemaFields(const TableSchema& schema)
+      : missing(false), schema_(schema) {}
+
+  PlanField operator()(const char* name) {
+    const SchemaField* field = FindSchemaField(schema_, name);
+    if (field == NULL) {
+      missing = true;
+      return PlanField{0, 0};
+    }
+    return PlanField{field->cell, field->num_cells};
+  }
+
+  PlanField All() const {
+    return PlanField{0, schema_.tuple_size / kCellSize};
+  }
+
+  bool missing;
+
+ private:
+  const TableSchema& schema_;
+};
+
+// The join of table-a and table-b as plan->join selects; the hash table
+// entries or sort records hold fields
+static void AddOLXPJoin(QueryPlan* plan,
+                        std::initializer_list<PlanField> fields) {
+  const JoinMethod& join = plan->join;
+  switch (join.kind) {
+    case kJoinByTuple:
+      PlanJoin(plan, THRESHOLD);
+      break;
+    case kJoinHash:
+      PlanHashJoin(plan, THRESHOLD, fields, kOLXPJoinAddr);
+      break;
+    case kJoinSortMerge:
+      PlanMergeJoin(plan, THRESHOLD, fields, kOLXPJoinAddr, join.run_tuples,
+                    join.fan_in);
+      break;
+  }
+}
+
+int AddOLXPQuery(QueryPlan* plan, int query, const TableSchema& schema) {
+  SchemaFields f(schema);
+  const int a = 0;
+  const int b = 1;
+  switch (query) {
+    case 1:  // SELECT f3, f4 FROM table-a WHERE f10 > x
+      PlanScan(plan, a, {f("f10")});
+      PlanFilter(plan, THRESHOLD, {f("f10")});
+      PlanFetch(plan, a, {f("f3"), f("f4")});
+      break;
+    case 2:  // SELECT * FROM table-b WHERE f10 > x | few f10 > x
+      PlanScan(plan, a, {f("f10")});
+      PlanFilter(plan, THRESHOLD, {f("f10")});
+      PlanFetch(plan, a, {f.All()});
+      break;
+    case 3:  // SELECT * FROM table-b WHERE f10 > x | most f10 > x
+      // Most rows are fetched anyway, so f10 is read by row as well
+      PlanScan(plan, a, {f("f10")}, kRowPath);
+      PlanFilter(plan, THRESHOLD_LOW, {f("f10")});
+      PlanFetch(plan, a, {f.All()});
+      break;
+    case 4:  // SELECT SUM(f9) FROM table-a WHERE f10 > x
+      PlanScan(plan, a, {f("f10")});
+      PlanFilter(plan, THRESHOLD, {f("f10")});
+      PlanAggregate(plan, a, {f("f9")});
+      break;
+    case 5:  // SELECT SUM(f9) FROM table-b WHERE f10 > x | most f10 > x
+      // Most f9 are summed, so the whole column is scanned
+      PlanScan(plan, a, {f("f10"), f("f9")});
+      PlanFilter(plan, THRESHOLD_LOW, {f("f10")});
+      PlanAggregate(plan, a, {f("f9")});
+      break;
+    case 6:  // SELECT AVG(f1) FROM table-a WHERE f10 > x
+      PlanScan(plan, a, {f("f10")});
+      PlanFilter(plan, THRESHOLD, {f("f10")});
+      PlanAggregate(plan, a, {f("f1")});
+      break;
+    case 7:  // SELECT AVG(f1) FROM table-b WHERE f10 > x | most f10 > x
+      PlanScan(plan, a, {f("f10")});
+      PlanFilter(plan, THRESHOLD_LOW, {f("f10")});
+      PlanAggregate(plan, a, {f("f1")});
+      break;
+    case 8:  // SELECT table-a.f3, table-b.f4 FROM table-a, table-b
+             // WHERE table-a.f1 > table-b.f1 AND table-a.f9 = table-b.f9
+      PlanScan(plan, a, {f("f1"), f("f9")});
+      PlanScan(plan, b, {f("f1"), f("f9")});
+      // The entries and records hold f1 too, for the join to compare
+      AddOLXPJoin(plan, {f("f1"), f("f9")});
+      PlanFetch(plan, a, {f("f3")});
+      PlanFetch(plan, b, {f("f4")});
+      break;
+    case 9:  // SELECT table-a.f3, table-b.f4 FROM table-a, table-b
+             // WHERE table-a.f9 = table-b.f9
+      PlanScan(plan, a, {f("f9")});
+      PlanScan(plan, b, {f("f9")});
+      AddOLXPJoin(plan, {f("f9")});
+      PlanFetch(plan, a, {f("f3")});
+      PlanFetch(plan, b, {f("f4")});
+      break;
+    case 10:  // SELECT f3, f4 FROM table-a WHERE f1 > x AND f9 < y
+      PlanScan(plan, a, {f("f1"), f("f9")});
+      PlanFilter(plan, THRESHOLD, {f("f1"), f("f9")});
+      PlanFetch(plan, a, {f("f3"), f("f4")});
+      break;
+    case 11:  // SELECT f3, f4 FROM table-a WHERE f1 > x AND f2 < y
+      PlanScan(plan, a, {f("f1"), f("f2")});
+      PlanFilter(plan, THRESHOLD, {f("f1"), f("f2")});
+      PlanFetch(plan, a, {f("f3"), f("f4")});
+      break;
+    case 12:  // UPDATE table-b SET f3 = x, f4 = y WHERE f10 = z
+      PlanScan(plan, a, {f("f10")});
+      PlanFilter(plan, THRESHOLD, {f("f10")});
+      PlanUpdate(plan, a, {f("f3"), f("f4")});
+      break;
+    case 13:  // UPDATE table-b SET f9 = x WHERE f10 = y
+      PlanScan(plan, a, {f("f10")});
+      PlanFilter(plan, THRESHOLD, {f("f10")});
+      PlanUpdate(plan, a, {f("f9")});
+      break;
+    case 14:  // SELECT SUM(f2_wide) FROM table-c
+      // The wide column is f3, as in IMDBOverCLRow
+      PlanScan(plan, a, {f("f3")});
+      break;
+    case 15:  // SELECT f3, f6, f10 FROM table-a
+      PlanScan(plan, a, {f("f3"), f("f6"),
+                         f("f10")});
+      break;
+    case 16:  // SELECT f1, SUM(f9) FROM table-a GROUP BY f1
+      PlanScan(plan, a, {f("f1"), f("f9")});
+      PlanGroupBy(plan, a, f("f1"), {f("f9")}, plan->group_by,
+                  kOLXPGroupAddr);
+      break;
+    default:
+      return kFailure;
+  }
+  return f.missing ? kFailure : kSuccess;
+}
+
+int AddOLXPQuery(QueryPlan* plan, int query) {
+  return AddOLXPQuery(plan, query,
+                      query == 14 ? IMDBOverCLRowSchema() : IMDBRowSchema());
+}
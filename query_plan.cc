@@ -0,0 +1,1068 @@
+/*
+ * query_plan.cc
+ */
+
+#include "query_plan.h"
+#include "gen_trace.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include "addr_util.h"
+#include "cpu_model.h"
+#include "external_sort.h"
+#include "trace_shard.h"
+#include "tuple_layout.h"
+
+QueryPlan::QueryPlan(int64_t num_tuples, int tuple_size,
+                     uint64_t base_col_addr)
+    : num_tuples(num_tuples), tuple_size(tuple_size),
+      layout(GetTableLayout()), values(GetValueDistribution()),
+      join(GetJoinMethod()), group_by(GetGroupBy()),
+      threads(GetTraceThreads()), prefetch_size(1),
+      tables(1, PlanTable{base_col_addr, GetBankInterleave()}) {
+}
+
+void AddPlanTable(QueryPlan* plan, uint64_t base_col_addr,
+                  BankInterleave interleave) {
+  plan->tables.push_back(PlanTable{base_col_addr, interleave});
+}
+
+void AddPlanTable(QueryPlan* plan, uint64_t base_col_addr) {
+  AddPlanTable(plan, base_col_addr, GetBankInterleave());
+}
+
+static void AddNode(QueryPlan* plan, PlanOp op, int table,
+                    std::initializer_list<PlanField> fields, int threshold,
+                    AccessPath path) {
+  PlanNode node;
+  node.op = op;
+  node.table = table;
+  node.fields.assign(fields.begin(), fields.end());
+  node.threshold = threshold;
+  node.path = path;
+  node.base_col_addr = 0;
+  node.run_tuples = 0;
+  node.fan_in = 0;
+  node.group_by = GroupBy{0, kPeriodicValues};
+  plan->nodes.push_back(node);
+}
+
+void PlanScan(QueryPlan* plan, int table,
+              std::initializer_list<PlanField> fields, AccessPath path) {
+  AddNode(plan, kPlanScan, table, fields, kPlanKeepAll, path);
+}
+
+void PlanFilter(QueryPlan* plan, int threshold,
+                std::initializer_list<PlanField> fields) {
+  AddNode(plan, kPlanFilter, 0, fields, threshold, kColumnPath);
+}
+
+void PlanJoin(QueryPlan* plan, int threshold) {
+  AddNode(plan, kPlanJoin, 0, {}, threshold, kColumnPath);
+}
+
+void PlanHashJoin(QueryPlan* plan, int threshold,
+                  std::initializer_list<PlanField> fields,
+                  uint64_t base_col_addr) {
+  AddNode(plan, kPlanHashJoin, 0, fields, threshold, kColumnPath);
+  plan->nodes.back().base_col_addr = base_col_addr;
+}
+
+void PlanMergeJoin(QueryPlan* plan, int threshold,
+                   std::initializer_list<PlanField> fields,
+                   uint64_t base_col_addr, int64_t run_tuples, int fan_in) {
+  AddNode(plan, kPlanMergeJoin, 0, fields, threshold, kColumnPath);
+  plan->nodes.back().base_col_addr = base_col_addr;
+  plan->nodes.back().run_tuples = run_tuples;
+  plan->nodes.back().fan_in = fan_in;
+}
+
+void PlanFetch(QueryPlan* plan, int table,
+               std::initializer_list<PlanField> fields) {
+  AddNode(plan, kPlanFetch, table, fields, kPlanKeepAll, kColumnPath);
+}
+
+void PlanUpdate(QueryPlan* plan, int table,
+                std::initializer_list<PlanField> fields) {
+  AddNode(plan, kPlanUpdate, table, fields, kPlanKeepAll, kColumnPath);
+}
+
+void PlanAggregate(QueryPlan* plan, int table,
+                   std::initializer_list<PlanField> fields) {
+  AddNode(plan, kPlanAggregate, table, fields, kPlanKeepAll, kColumnPath);
+}
+
+void PlanGroupBy(QueryPlan* plan, int table, PlanField key,
+                 std::initializer_list<PlanField> fields,
+                 const GroupBy& group_by, uint64_t base_col_addr) {
+  AddNode(plan, kPlanGroupBy, table, fields, kPlanKeepAll, kColumnPath);
+  PlanNode& node = plan->nodes.back();
+  node.fields.insert(node.fields.begin(), key);
+  node.base_col_addr = base_col_addr;
+  node.group_by = group_by;
+}
+
+static JoinMethod g_join_method = kJoinByTupleMethod;
+
+void SetJoinMethod(JoinMethod join) {
+  g_join_method = join;
+}
+
+JoinMethod GetJoinMethod() {
+  return g_join_method;
+}
+
+// Tuples of a sorted run and runs a merge reads unless the name says
+static const int64_t kDefaultRunTuples = 8192;
+static const int kDefaultFanIn = 8;
+
+int ParseJoinMethod(const char* name, JoinMethod* join) {
+  if (strcmp(name, "tuple") == 0) {
+    *join = kJoinByTupleMethod;
+  } else if (strcmp(name, "hash") == 0) {
+    *join = JoinMethod{kJoinHash, 0, 0};
+  } else if (strncmp(name, "merge", 5) == 0) {
+    long long run_tuples = kDefaultRunTuples;
+    long long fan_in = kDefaultFanIn;
+    const char* p = name + 5;
+    char* end;
+    if (*p != '\0' && *p != 'x') {
+      run_tuples = strtoll(p, &end, 10);
+      p = end;
+    }
+    if (*p == 'x') {
+      fan_in = strtoll(p + 1, &end, 10);
+      p = end;
+    }
+    if (*p != '\0' || run_tuples < 1 || fan_in < 2 || fan_in > 1 << 16) {
+      return kFailure;
+    }
+    *join = JoinMethod{kJoinSortMerge, run_tuples, (int)fan_in};
+  } else {
+    return kFailure;
+  }
+  return kSuccess;
+}
+
+std::string JoinMethodName(const JoinMethod& join) {
+  switch (join.kind) {
+    case kJoinByTuple: return "tuple";
+    case kJoinHash: return "hash";
+    case kJoinSortMerge:
+      return "merge" + std::to_string(join.run_tuples) + "x"
+          + std::to_string(join.fan_in);
+  }
+  return "?";
+}
+
+static GroupBy g_group_by = kDefaultGroupBy;
+
+void SetGroupBy(const GroupBy& group_by) {
+  g_group_by = group_by;
+}
+
+const GroupBy& GetGroupBy() {
+  return g_group_by;
+}
+
+int ParseGroupBy(const char* name, GroupBy* group_by) {
+  char* end;
+  long long groups = strtoll(name, &end, 10);
+  if (end == name || groups < 1 || groups > 1ll << 30) return kFailure;
+  ValueDistribution keys = kDefaultGroupBy.keys;
+  if (*end == ':') {
+    if (ParseValueDistribution(end + 1, &keys) != kSuccess) return kFailure;
+  } else if (*end != '\0') {
+    return kFailure;
+  }
+  *group_by = GroupBy{groups, keys};
+  return kSuccess;
+}
+
+std::string GroupByName(const GroupBy& group_by) {
+  return "g" + std::to_string(group_by.num_groups) + "-"
+      + ValueDistributionName(group_by.keys);
+}
+
+// One cache line access of a tuple: the line holding cell of the tuple, in
+// column (op 'r') or row addressing
+struct PlanAccess {
+  int table;
+  int cell;
+  char op;
+};
+
+// What a pass does for a hash or merge join
+enum JoinPhase {
+  kPhaseNone,
+  kPhaseBuild,      // inserts every tuple into the hash table
+  kPhaseProbe,      // looks every tuple up, fetches for the matches
+  kPhaseSortRuns,   // writes the sorted runs of the tuples
+  kPhaseMergeJoin,  // merges the runs, fetches for the matches
+};
+
+// A loop over the tuples of the plan, the lowered form of its operators
+struct PlanPass {
+  bool column;                     // blocks of a column scan, else tuples
+  int table;                       // scanned, or -1 for a join
+  JoinPhase phase;
+  std::vector<PlanAccess> scan;    // every block or tuple
+  std::vector<PlanAccess> gated;   // blocks whose first tuple is kept
+  int threshold;                   // tuples kept for the fetches
+  std::vector<int> predicate;      // cells of table the filter compares
+  std::vector<PlanAccess> fetch;   // every kept tuple
+  bool group_by;                   // every kept tuple updates its group
+  int aggregates;                  // fields aggregated per kept tuple
+  bool materializes;               // kept tuples are fetched or updated
+};
+
+// Whether the tuples of pass are filtered or joined
+static inline bool Filters(const PlanPass& pass) {
+  return pass.threshold != kPlanKeepAll;
+}
+
+// Predicate terms evaluated per tuple of pass, a join counting as one
+static inline int PredicateTerms(const PlanPass& pass) {
+  return std::max(1, (int)pass.predicate.size());
+}
+
+// Whether pass does anything per kept tuple
+static inline bool VisitsKept(const PlanPass& pass) {
+  return !pass.fetch.empty() || pass.group_by;
+}
+
+// Cells and row lines a table already has in the processor
+struct TableState {
+  std::vector<int> col_cells;
+  std::vector<int> row_lines;
+};
+
+static bool Contains(const std::vector<int>& v, int x) {
+  return std::find(v.begin(), v.end(), x) != v.end();
+}
+
+// Row reads of the lines of fields that are not loaded yet, plus a write of
+// every line for updates. A line is line_cells cells of the tuple.
+static void LowerRowAccess(const std::vector<PlanField>& fields, int table,
+                           bool write, int line_cells, TableState* state,
+                           std::vector<PlanAccess>* out) {
+  std::vector<int> lines;
+  for (size_t f = 0; f < fields.size(); f++) {
+    const PlanField& field = fields[f];
+    for (int cell = field.cell; cell < field.cell + field.num_cells; cell++) {
+      int line = cell / line_cells;
+      if (Contains(lines, line)) continue;
+      lines.push_back(line);
+      if (!Contains(state->row_lines, line)) {
+        state->row_lines.push_back(line);
+        out->push_back(PlanAccess{table, cell, 'R'});
+      }
+      if (write) out->push_back(PlanAccess{table, cell, 'W'});
+    }
+  }
+}
+
+static void LowerColumnAccess(const std::vector<PlanField>& fields, int table,
+                              TableState* state,
+                              std::vector<PlanAccess>* out) {
+  for (size_t f = 0; f < fields.size(); f++) {
+    const PlanField& field = fields[f];
+    for (int cell = field.cell; cell < field.cell + field.num_cells; cell++) {
+      if (Contains(state->col_cells, cell)) continue;
+      state->col_cells.push_back(cell);
+      out->push_back(PlanAccess{table, cell, 'r'});
+    }
+  }
+}
+
+// Hash table or runs of a hash or merge join as lowered: where they are and
+// what an entry or record holds
+struct JoinDesc {
+  int threshold;           // of the join, kept probe tuples have a match
+  uint64_t base_col_addr;
+  int entry_cells;         // a power of two, the link or tuple and the fields
+  int64_t run_tuples;      // of a merge join
+  int fan_in;              // of a merge join
+};
+
+// Hash table of a GROUP BY as lowered
+struct GroupDesc {
+  int table;
+  int key_cell;            // first cell of the key
+  uint64_t base_col_addr;
+  int entry_cells;         // a power of two, the key and the aggregates
+  GroupBy group_by;        // num_groups 0 for a plan without GROUP BY
+};
+
+// Lowers plan into passes: one per table scanned before a join and one for
+// the join itself, or a single pass for a plan without join. A hash join
+// makes the scan of table 0 its build and the scan of table 1 its probe,
+// which gets the operators after it. A merge join makes the scans of both
+// tables write their runs and adds a pass for the merges. *join describes
+// the hash table or runs, *group the hash table of a GROUP BY.
+static int LowerPlan(const QueryPlan& plan, MemoryType memory,
+                     std::vector<PlanPass>* passes, JoinDesc* join,
+                     GroupDesc* group) {
+  std::vector<TableState> state(plan.tables.size());
+  int line_cells = RowLineCells(plan.layout);
+  std::vector<int> scan_pass(plan.tables.size(), -1);
+  int pass = -1;  // pass the operators after the scans go to
+  for (size_t k = 0; k < plan.nodes.size(); k++) {
+    const PlanNode& node = plan.nodes[k];
+    if (node.table < 0 || node.table >= (int)plan.tables.size()) {
+      return kFailure;
+    }
+    TableState* table = &state[node.table];
+    switch (node.op) {
+      case kPlanScan: {
+        bool column = memory == kRCNVM && node.path == kColumnPath;
+        if (scan_pass[node.table] < 0) {
+          scan_pass[node.table] = (int)passes->size();
+          passes->push_back(PlanPass());
+          passes->back().column = column;
+          passes->back().table = node.table;
+          passes->back().phase = kPhaseNone;
+          passes->back().threshold = kPlanKeepAll;
+          passes->back().group_by = false;
+          passes->back().aggregates = 0;
+          passes->back().materializes = false;
+          pass = scan_pass[node.table];
+        }
+        PlanPass& p = (*passes)[scan_pass[node.table]];
+        if (p.column != column) return kFailure;
+        if (column) {
+          LowerColumnAccess(node.fields, node.table, table, &p.scan);
+        } else {
+          LowerRowAccess(node.fields, node.table, false, line_cells, table,
+                         &p.scan);
+        }
+        break;
+      }
+      case kPlanFilter: {
+        if (pass < 0 || (*passes)[pass].table < 0
+            || (*passes)[pass].phase != kPhaseNone) {
+          return kFailure;
+        }
+        PlanPass& p = (*passes)[pass];
+        p.threshold = node.threshold;
+        for (size_t f = 0; f < node.fields.size(); f++) {
+          const PlanField& field = node.fields[f];
+          for (int cell = field.cell; cell < field.cell + field.num_cells;
+               cell++) {
+            if (!Contains(p.predicate, cell)) p.predicate.push_back(cell);
+          }
+        }
+        break;
+      }
+      case kPlanJoin:
+        pass = (int)passes->size();
+        passes->push_back(PlanPass());
+        passes->back().column = false;
+        passes->back().table = -1;
+        passes->back().phase = kPhaseNone;
+        passes->back().threshold = node.threshold;
+        passes->back().group_by = false;
+        passes->back().aggregates = 0;
+        passes->back().materializes = false;
+        break;
+      case kPlanHashJoin:
+      case kPlanMergeJoin: {
+        if (plan.tables.size() != 2 || scan_pass[0] < 0 || scan_pass[1] < 0) {
+          return kFailure;
+        }
+        // Every tuple goes into the hash table or runs, so neither side may
+        // be filtered or joined already
+        for (int k = 0; k < 2; k++) {
+          const PlanPass& p = (*passes)[scan_pass[k]];
+          if (p.phase != kPhaseNone || p.threshold != kPlanKeepAll
+              || VisitsKept(p) || !p.gated.empty()) {
+            return kFailure;
+          }
+        }
+        if (node.op == kPlanHashJoin) {
+          (*passes)[scan_pass[0]].phase = kPhaseBuild;
+          pass = scan_pass[1];
+          (*passes)[pass].phase = kPhaseProbe;
+        } else {
+          if (node.run_tuples < 1 || node.fan_in < 2) return kFailure;
+          (*passes)[scan_pass[0]].phase = kPhaseSortRuns;
+          (*passes)[scan_pass[1]].phase = kPhaseSortRuns;
+          pass = (int)passes->size();
+          passes->push_back(PlanPass());
+          passes->back().column = false;
+          passes->back().table = -1;
+          passes->back().phase = kPhaseMergeJoin;
+          passes->back().threshold = kPlanKeepAll;
+          passes->back().group_by = false;
+          passes->back().aggregates = 0;
+          passes->back().materializes = false;
+          // The tuples of both tables come in key order
+          state[1].row_lines.clear();
+        }
+        // The build tuples matched are long gone from the processor
+        state[0].row_lines.clear();
+        int cells = 1;
+        for (size_t f = 0; f < node.fields.size(); f++) {
+          cells += node.fields[f].num_cells;
+        }
+        join->threshold = node.threshold;
+        join->base_col_addr = node.base_col_addr;
+        join->entry_cells = 1;
+        while (join->entry_cells < cells) join->entry_cells <<= 1;
+        if (join->entry_cells > kCachelineSize / kCellSize) return kFailure;
+        join->run_tuples = node.run_tuples;
+        join->fan_in = node.fan_in;
+        break;
+      }
+      case kPlanFetch:
+      case kPlanUpdate:
+      case kPlanAggregate:
+      case kPlanGroupBy: {
+        if (pass < 0) return kFailure;
+        PlanPass& p = (*passes)[pass];
+        bool aggregate = node.op == kPlanAggregate || node.op == kPlanGroupBy;
+        if (aggregate && p.column && p.phase == kPhaseNone) {
+          LowerColumnAccess(node.fields, node.table, table, &p.gated);
+        } else {
+          LowerRowAccess(node.fields, node.table, node.op == kPlanUpdate,
+                         line_cells, table, &p.fetch);
+        }
+        if (aggregate) {
+          p.aggregates += (int)node.fields.size();
+        } else {
+          p.materializes = true;
+        }
+        if (node.op != kPlanGroupBy) break;
+        // The groups are updated per kept tuple of a plain pass, once
+        if (p.phase != kPhaseNone || group->group_by.num_groups > 0
+            || node.group_by.num_groups < 1) {
+          return kFailure;
+        }
+        int cells = 0;
+        for (size_t f = 0; f < node.fields.size(); f++) {
+          cells += node.fields[f].num_cells;
+        }
+        p.group_by = true;
+        group->table = node.table;
+        group->key_cell = node.fields[0].cell;
+        group->base_col_addr = node.base_col_addr;
+        group->entry_cells = 1;
+        while (group->entry_cells < cells) group->entry_cells <<= 1;
+        if (group->entry_cells > kCachelineSize / kCellSize) return kFailure;
+        group->group_by = node.group_by;
+        break;
+      }
+    }
+  }
+  return kSuccess;
+}
+
+// Column of ColumnValues that the probe keys are drawn from
+static const int kProbeKeyColumn = -2;
+
+// Key of tuple t of table 0 or 1 of a join. Build tuple t has key t; a probe
+// tuple kept by threshold has the key of a random build tuple, the others a
+// key past them.
+static inline uint64_t JoinKey(int threshold, int64_t num_tuples, int table,
+                               int64_t t) {
+  if (table == 0) return (uint64_t)t;
+  if (t % 10 < threshold) return (uint64_t)(num_tuples + t);
+  return ValueHash(kProbeKeyColumn, t) % (uint64_t)num_tuples;
+}
+
+// The hash table of a hash join with the chains of its buckets. The bucket
+// heads come first, kCellSize bytes each, and the entries follow from the
+// next cache line on, entry t for build tuple t.
+struct JoinHashTable {
+  JoinHashTable(const JoinDesc& desc, BankInterleave interleave,
+                int64_t num_tuples)
+      : base_row_addr(ColAddr2RowAddr(desc.base_col_addr)),
+        interleave(interleave), num_tuples(num_tuples),
+        threshold(desc.threshold), entry_size(desc.entry_cells * kCellSize) {
+    uint64_t buckets = 1;
+    while (buckets < (uint64_t)num_tuples) buckets <<= 1;
+    bucket_mask = buckets - 1;
+    entries_offset = ALIGN_SIZE(buckets * kCellSize, kCachelineSize);
+    // Entries go in at the head of their chain in tuple order
+    head.assign(buckets, -1);
+    next.resize(num_tuples);
+    for (int64_t t = 0; t < num_tuples; t++) {
+      uint64_t bucket = Bucket((uint64_t)t);
+      next[t] = head[bucket];
+      head[bucket] = t;
+    }
+  }
+
+  uint64_t Bucket(uint64_t key) const {
+    return MixBits(key) & bucket_mask;
+  }
+
+  // Row cache line of byte offset of the hash table
+  uint64_t LineAddr(uint64_t offset) const {
+    return GetCacheLineAddr(CalTupleRowAddr((int64_t)offset, 1, base_row_addr,
+                                            interleave));
+  }
+
+  uint64_t BucketAddr(uint64_t bucket) const {
+    return LineAddr(bucket * kCellSize);
+  }
+
+  uint64_t EntryAddr(int64_t t) const {
+    return LineAddr(entries_offset + (uint64_t)t * entry_size);
+  }
+
+  // Whether entry t fills the last slot of its line, or is the last one
+  bool EndsEntryLine(int64_t t) const {
+    return (t + 1) % (kCachelineSize / entry_size) == 0
+        || t + 1 == num_tuples;
+  }
+
+  uint64_t base_row_addr;
+  BankInterleave interleave;
+  int64_t num_tuples;
+  int threshold;
+  int entry_size;           // bytes
+  uint64_t bucket_mask;
+  uint64_t entries_offset;  // bytes
+  std::vector<int64_t> head;  // entry of every bucket, -1 for none
+  std::vector<int64_t> next;  // entry after every entry in its chain
+};
+
+// External sorts of the two tables of a merge join. The records sort by the
+// join key scrambled, so that the key order is not the tuple order. The runs
+// of table 1 follow those of table 0.
+static std::vector<ExternalSort> SortJoinTables(const QueryPlan& plan,
+                                                const JoinDesc& desc) {
+  std::vector<ExternalSort> sorts;
+  SortRegion region = {ColAddr2RowAddr(desc.base_col_addr), 0,
+                       plan.tables[0].interleave, desc.entry_cells * kCellSize,
+                       plan.num_tuples};
+  for (int table = 0; table < 2; table++) {
+    std::vector<SortRecord> records(plan.num_tuples);
+    for (int64_t t = 0; t < plan.num_tuples; t++) {
+      uint64_t key = JoinKey(desc.threshold, plan.num_tuples, table, t);
+      records[t] = SortRecord{MixBits(key), t};
+    }
+    sorts.push_back(ExternalSort(region, records, desc.run_tuples,
+                                 desc.fan_in));
+    region.offset += region.Size();
+  }
+  return sorts;
+}
+
+// Column of ColumnValues of cell of table
+static inline int ValueColumn(int table, int cell) {
+  return table << 16 | cell;
+}
+
+// The hash table of a GROUP BY, open addressing with linear probing. A slot
+// is an entry of the table, and there is a slot per two groups, rounded up
+// to a power of two. The groups go in in order when the first tuple of each
+// arrives, so every group has its slot from the start.
+struct GroupHashTable {
+  GroupHashTable(const GroupDesc& desc, BankInterleave interleave,
+                 int64_t num_tuples)
+      : base_row_addr(ColAddr2RowAddr(desc.base_col_addr)),
+        interleave(interleave), key_column(ValueColumn(desc.table,
+                                                       desc.key_cell)),
+        entry_size(desc.entry_cells * kCellSize),
+        keys(desc.group_by.keys, num_tuples, desc.group_by.num_groups) {
+    uint64_t slots = 2;
+    while (slots < 2 * (uint64_t)desc.group_by.num_groups) slots <<= 1;
+    slot_mask = slots - 1;
+    std::vector<bool> used(slots, false);
+    slot.resize(desc.group_by.num_groups);
+    for (int64_t g = 0; g < desc.group_by.num_groups; g++) {
+      uint64_t s = Home(g);
+      while (used[s]) s = (s + 1) & slot_mask;
+      used[s] = true;
+      slot[g] = s;
+    }
+  }
+
+  uint64_t Home(int64_t group) const {
+    return MixBits((uint64_t)group) & slot_mask;
+  }
+
+  uint64_t SlotAddr(uint64_t s) const {
+    return GetCacheLineAddr(CalTupleRowAddr((int64_t)(s * entry_size), 1,
+                                            base_row_addr, interleave));
+  }
+
+  // Probe of the group of tuple t: reads of the lines of the slots from its
+  // home to its own, each after the key compare of the last, then the write
+  // of its aggregates
+  int64_t Update(TraceWriter* fp, const CpuModel* cpu, int64_t t,
+                 int64_t num_traces) const;
+
+  uint64_t base_row_addr;
+  BankInterleave interleave;
+  int key_column;
+  int entry_size;             // bytes
+  ColumnValues keys;          // group of every tuple
+  uint64_t slot_mask;
+  std::vector<uint64_t> slot;  // of every group
+};
+
+// What the passes of a plan run over: where the tuples of the tables are,
+// the values of their fields, the hash table or sorts of a join and the hash
+// table of a GROUP BY
+template <typename Layout>
+struct PlanData {
+  const Layout* layouts;
+  const ColumnValues* values;
+  const JoinHashTable* hash_table;
+  const ExternalSort* sorts;  // of tables 0 and 1
+  const GroupHashTable* group_table;
+  const CpuModel* cpu;        // of the issue cycles, NULL without
+};
+
+static const int kKeepBlock = 64;
+
+// Bitmap of the tuples [t, t + n), n <= kKeepBlock, that pass the filter of
+// pass, or the join of a join pass, which matches t when t % 10 >= threshold
+static uint64_t KeepBits(const ColumnValues& values, const PlanPass& pass,
+                         int64_t t, int n) {
+  uint64_t bits = n == kKeepBlock ? ~0ull : (1ull << n) - 1;
+  if (pass.threshold == kPlanKeepAll) return bits;
+  int32_t block[kKeepBlock];
+  int32_t constant = (int32_t)(pass.threshold * kValueDomain / 10);
+  if (pass.predicate.empty()) {
+    for (int i = 0; i < n; i++) {
+      block[i] = (int32_t)((t + i) % 10 * (kValueDomain / 10));
+    }
+    return bits & MatchAtLeast(block, n, constant);
+  }
+  for (size_t k = 0; k < pass.predicate.size() && bits != 0; k++) {
+    values.Fill(ValueColumn(pass.table, pass.predicate[k]), t, n, block);
+    bits &= MatchAtLeast(block, n, constant);
+  }
+  return bits;
+}
+
+static inline bool TestBit(const uint64_t* bits, int64_t i) {
+  return (bits[i / kKeepBlock] >> (i % kKeepBlock)) & 1;
+}
+
+static inline void EmitLine(TraceWriter* fp, char access_op, uint64_t addr,
+                            int64_t num_traces) {
+  const char op[2] = {access_op, '\0'};
+#ifdef DEBUG
+  dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op,
+          addr, 0, 0, 0, 0, 0, 0);
+#else
+  cprintf(fp, num_traces, op, addr);
+#endif
+}
+
+// What the core does between the accesses of a plan, see cpu_model.h
+enum PlanWork {
+  kWorkWait,         // nothing but wait for the data of the last access
+  kWorkPredicate,
+  kWorkAggregate,
+  kWorkMaterialize,
+};
+
+// count times work before the next access, for cycle traces; with wait it
+// needs the data of the last access
+static inline void EmitWork(TraceWriter* fp, const CpuModel* cpu,
+                            PlanWork work, int64_t count, bool wait) {
+  if (cpu == NULL) return;
+  int cycles = 0;
+  switch (work) {
+    case kWorkWait: break;
+    case kWorkPredicate: cycles = cpu->predicate_cycles; break;
+    case kWorkAggregate: cycles = cpu->aggregate_cycles; break;
+    case kWorkMaterialize: cycles = cpu->materialize_cycles; break;
+  }
+  fp->Compute(count * cycles, wait, 0);
+}
+
+int64_t GroupHashTable::Update(TraceWriter* fp, const CpuModel* cpu,
+                               int64_t t, int64_t num_traces) const {
+  int64_t group = keys.Value(key_column, t);
+  uint64_t s = Home(group);
+  uint64_t line = SlotAddr(s);
+  // Hashing the group needs the key fetched
+  EmitWork(fp, cpu, kWorkPredicate, 1, true);
+  EmitLine(fp, 'R', line, num_traces++);
+  while (s != slot[group]) {
+    s = (s + 1) & slot_mask;
+    uint64_t addr = SlotAddr(s);
+    if (addr == line) continue;
+    line = addr;
+    EmitWork(fp, cpu, kWorkPredicate, 1, true);
+    EmitLine(fp, 'R', line, num_traces++);
+  }
+  EmitWork(fp, cpu, kWorkWait, 0, true);
+  EmitLine(fp, 'W', line, num_traces++);
+  return num_traces;
+}
+
+// Row cache line access of cell of tuple t
+template <typename Layout>
+static inline void EmitAccess(TraceWriter* fp, const PlanData<Layout>& data,
+                              const PlanAccess& access, int64_t t,
+                              int64_t num_traces) {
+  uint64_t addr = data.layouts[access.table].CellAddr(t, access.cell);
+  EmitLine(fp, access.op, GetCacheLineAddr(ColAddr2RowAddr(addr)),
+           num_traces);
+}
+
+template <typename Layout>
+static inline int64_t RunFetches(TraceWriter* fp,
+                                 const PlanData<Layout>& data,
+                                 const PlanPass& pass, int64_t t,
+                                 int64_t num_traces) {
+  for (size_t a = 0; a < pass.fetch.size(); a++) {
+    EmitAccess(fp, data, pass.fetch[a], t, num_traces++);
+  }
+  // Nothing else waits for the fetched lines, the next tuple is on its way
+  if (pass.materializes) {
+    EmitWork(fp, data.cpu, kWorkMaterialize, 1, false);
+  }
+  // A column scan aggregates the lines it reads field by field instead
+  if (!pass.column && pass.aggregates > 0) {
+    EmitWork(fp, data.cpu, kWorkAggregate, pass.aggregates, false);
+  }
+  if (pass.group_by) {
+    num_traces = data.group_table->Update(fp, data.cpu, t, num_traces);
+  }
+  return num_traces;
+}
+
+// Fetches of a join for build tuple build (table 0) and probe tuple probe
+template <typename Layout>
+static int64_t RunJoinFetches(TraceWriter* fp, const PlanData<Layout>& data,
+                              const PlanPass& pass, int64_t build,
+                              int64_t probe, int64_t num_traces) {
+  for (size_t a = 0; a < pass.fetch.size(); a++) {
+    const PlanAccess& access = pass.fetch[a];
+    EmitAccess(fp, data, access, access.table == 0 ? build : probe,
+               num_traces++);
+  }
+  if (pass.materializes) {
+    EmitWork(fp, data.cpu, kWorkMaterialize, 1, false);
+  }
+  return num_traces;
+}
+
+// Join accesses of tuple t of a build, probe or sort pass: the hash table
+// accesses and the fetches of the matches of a probe, or the writes of the
+// run that t ends
+template <typename Layout>
+static int64_t RunJoinTuple(TraceWriter* fp, const PlanData<Layout>& data,
+                            const PlanPass& pass, int64_t t,
+                            int64_t num_traces) {
+  if (pass.phase == kPhaseSortRuns) {
+    const ExternalSort& sort = data.sorts[pass.table];
+    return sort.EndsRun(t) ? sort.WriteRun(fp, t, num_traces) : num_traces;
+  }
+  const JoinHashTable& table = *data.hash_table;
+  // Hashing the key needs the key read by the scan
+  EmitWork(fp, data.cpu, kWorkPredicate, 1, true);
+  if (pass.phase == kPhaseBuild) {
+    uint64_t bucket_addr = table.BucketAddr(table.Bucket((uint64_t)t));
+    EmitLine(fp, 'R', bucket_addr, num_traces++);
+    EmitWork(fp, data.cpu, kWorkWait, 0, true);
+    EmitLine(fp, 'W', bucket_addr, num_traces++);
+    if (table.EndsEntryLine(t)) {
+      EmitLine(fp, 'W', table.EntryAddr(t), num_traces++);
+    }
+    return num_traces;
+  }
+  uint64_t key = JoinKey(table.threshold, table.num_tuples, 1, t);
+  uint64_t bucket = table.Bucket(key);
+  EmitLine(fp, 'R', table.BucketAddr(bucket), num_traces++);
+  for (int64_t e = table.head[bucket]; e >= 0; e = table.next[e]) {
+    // The link to the entry is in the line read last
+    EmitWork(fp, data.cpu, kWorkWait, 0, true);
+    EmitLine(fp, 'R', table.EntryAddr(e), num_traces++);
+    EmitWork(fp, data.cpu, kWorkPredicate, 1, true);
+    if ((uint64_t)e == key) {
+      num_traces = RunJoinFetches(fp, data, pass, e, t, num_traces);
+    }
+  }
+  return num_traces;
+}
+
+// Merge join of the runs left of both tables, with the fetches of every
+// match. The build keys are distinct, so a match moves on to the next probe
+// record only.
+template <typename Layout>
+static int64_t RunMergeJoin(TraceWriter* fp, const PlanData<Layout>& data,
+                            const PlanPass& pass, int64_t num_traces) {
+  MergeCursor build(data.sorts[0], 0, data.sorts[0].num_runs());
+  MergeCursor probe(data.sorts[1], 0, data.sorts[1].num_runs());
+  SortRecord a, b;
+  bool has_a = build.Next(fp, &num_traces, &a);
+  bool has_b = probe.Next(fp, &num_traces, &b);
+  while (has_a && has_b) {
+    EmitWork(fp, data.cpu, kWorkPredicate, 1, true);
+    if (a.key < b.key) {
+      has_a = build.Next(fp, &num_traces, &a);
+    } else if (a.key > b.key) {
+      has_b = probe.Next(fp, &num_traces, &b);
+    } else {
+      num_traces = RunJoinFetches(fp, data, pass, a.tuple, b.tuple,
+                                  num_traces);
+      has_b = probe.Next(fp, &num_traces, &b);
+    }
+  }
+  return num_traces;
+}
+
+// Fetches of the tuples t + i of the bits i set in keep
+template <typename Layout>
+static int64_t RunKeptFetches(TraceWriter* fp, const PlanData<Layout>& data,
+                              const PlanPass& pass, int64_t t, uint64_t keep,
+                              int64_t num_traces) {
+  while (keep != 0) {
+    int i = __builtin_ctzll(keep);
+    keep &= keep - 1;
+    num_traces = RunFetches(fp, data, pass, t + i, num_traces);
+  }
+  return num_traces;
+}
+
+// Column reads of the lines holding the cell of access that tuples [i, i +
+// group) are at the top of; with keep, the bitmap of the group, of the lines
+// whose top tuple is kept
+template <typename Layout>
+static int64_t ReadColumnLines(TraceWriter* fp, const PlanData<Layout>& data,
+                               const PlanAccess& access, int64_t i, int group,
+                               const uint64_t* keep, int64_t num_traces) {
+  const Layout& layout = data.layouts[access.table];
+  for (int64_t t = i; t < i + group; t += Layout::kScanStep) {
+    uint64_t addr = layout.CellAddr(t, access.cell);
+    if (Layout::kScanStep == 1 && GetColumnLineAddr(addr) != addr) continue;
+    if (keep != NULL && !TestBit(keep, t - i)) continue;
+    EmitLine(fp, access.op, addr, num_traces++);
+  }
+  return num_traces;
+}
+
+template <typename Layout>
+static int64_t RunColumnPass(TraceWriter* fp, const QueryPlan& plan,
+                             const PlanData<Layout>& data,
+                             const PlanPass& pass, int64_t begin, int64_t end,
+                             int64_t num_traces) {
+  int group = kCachelineSize / kCellSize * plan.prefetch_size;
+  int blocks = (group - 1) / kKeepBlock + 1;
+  std::vector<uint64_t> keep(blocks);
+  for (int64_t i = begin; i < end; i += group) {
+    for (size_t a = 0; a < pass.scan.size(); a++) {
+      num_traces = ReadColumnLines(fp, data, pass.scan[a], i, group, NULL,
+                                   num_traces);
+    }
+    if (pass.phase != kPhaseNone) {
+      for (int64_t t = i; t < i + group && t < plan.num_tuples; t++) {
+        num_traces = RunJoinTuple(fp, data, pass, t, num_traces);
+      }
+      continue;
+    }
+    if (pass.gated.empty() && !VisitsKept(pass)) continue;
+    for (int b = 0; b < blocks; b++) {
+      keep[b] = KeepBits(*data.values, pass, i + b * kKeepBlock,
+                         std::min(kKeepBlock, group - b * kKeepBlock));
+    }
+    if (Filters(pass) && data.cpu != NULL) {
+      // Only the accesses of kept tuples wait for the predicates, the scan of
+      // the next group runs ahead
+      int64_t tuples = std::min((int64_t)group, plan.num_tuples - i);
+      bool any = false;
+      for (int b = 0; b < blocks; b++) any = any || keep[b] != 0;
+      EmitWork(fp, data.cpu, kWorkPredicate, PredicateTerms(pass) * tuples,
+               any);
+    }
+    for (size_t a = 0; a < pass.gated.size(); a++) {
+      num_traces = ReadColumnLines(fp, data, pass.gated[a], i, group,
+                                   keep.data(), num_traces);
+    }
+    if (!pass.gated.empty() && data.cpu != NULL) {
+      int64_t kept = 0;
+      for (int b = 0; b < blocks; b++) kept += __builtin_popcountll(keep[b]);
+      EmitWork(fp, data.cpu, kWorkAggregate, kept * pass.aggregates, false);
+    }
+    if (!VisitsKept(pass)) continue;
+    for (int b = 0; b < blocks; b++) {
+      num_traces = RunKeptFetches(fp, data, pass, i + b * kKeepBlock, keep[b],
+                                  num_traces);
+    }
+  }
+  return num_traces;
+}
+
+template <typename Layout>
+static int64_t RunRowPass(TraceWriter* fp, const PlanData<Layout>& data,
+                          const PlanPass& pass, int64_t begin, int64_t end,
+                          int64_t num_traces) {
+  if (pass.phase != kPhaseNone) {
+    for (int64_t t = begin; t < end; t++) {
+      for (size_t a = 0; a < pass.scan.size(); a++) {
+        EmitAccess(fp, data, pass.scan[a], t, num_traces++);
+      }
+      num_traces = RunJoinTuple(fp, data, pass, t, num_traces);
+    }
+    return num_traces;
+  }
+  for (int64_t i = begin; i < end; i += kKeepBlock) {
+    int n = (int)std::min((int64_t)kKeepBlock, end - i);
+    uint64_t keep = VisitsKept(pass) ? KeepBits(*data.values, pass, i, n) : 0;
+    if (pass.scan.empty()) {
+      if (!Filters(pass) || data.cpu == NULL) {
+        num_traces = RunKeptFetches(fp, data, pass, i, keep, num_traces);
+        continue;
+      }
+      // The predicates up to a kept tuple come before its fetches, whatever
+      // block they are in
+      int done = 0;
+      for (uint64_t bits = keep; bits != 0; bits &= bits - 1) {
+        int k = __builtin_ctzll(bits);
+        EmitWork(fp, data.cpu, kWorkPredicate,
+                 PredicateTerms(pass) * (k + 1 - done), false);
+        num_traces = RunFetches(fp, data, pass, i + k, num_traces);
+        done = k + 1;
+      }
+      EmitWork(fp, data.cpu, kWorkPredicate, PredicateTerms(pass) * (n - done),
+               false);
+      continue;
+    }
+    for (int k = 0; k < n; k++) {
+      for (size_t a = 0; a < pass.scan.size(); a++) {
+        EmitAccess(fp, data, pass.scan[a], i + k, num_traces++);
+      }
+      if (Filters(pass)) {
+        EmitWork(fp, data.cpu, kWorkPredicate, PredicateTerms(pass),
+                 (keep >> k) & 1);
+      }
+      if ((keep >> k) & 1) {
+        num_traces = RunFetches(fp, data, pass, i + k, num_traces);
+      }
+    }
+  }
+  return num_traces;
+}
+
+template <typename Layout>
+static int64_t RunPasses(TraceWriter* fp, const QueryPlan& plan,
+                         const std::vector<PlanPass>& passes,
+                         const JoinDesc& join, const GroupDesc& group,
+                         int64_t num_traces) {
+  std::vector<Layout> layouts;
+  for (size_t k = 0; k < plan.tables.size(); k++) {
+    layouts.push_back(Layout(plan.layout, plan.tables[k].base_col_addr,
+                             plan.tables[k].interleave, plan.tuple_size,
+                             plan.num_tuples));
+  }
+  ColumnValues values(plan.values, plan.num_tuples);
+  std::vector<JoinHashTable> hash_table;
+  std::vector<ExternalSort> sorts;
+  for (size_t k = 0; k < passes.size(); k++) {
+    if (passes[k].phase == kPhaseBuild) {
+      hash_table.push_back(JoinHashTable(join, plan.tables[0].interleave,
+                                         plan.num_tuples));
+    } else if (passes[k].phase == kPhaseMergeJoin) {
+      sorts = SortJoinTables(plan, join);
+    }
+  }
+  std::vector<GroupHashTable> group_table;
+  if (group.group_by.num_groups > 0) {
+    group_table.push_back(GroupHashTable(group,
+                                         plan.tables[group.table].interleave,
+                                         plan.num_tuples));
+  }
+  PlanData<Layout> data = {layouts.data(), &values,
+                           hash_table.empty() ? NULL : &hash_table[0],
+                           sorts.data(),
+                           group_table.empty() ? NULL : &group_table[0],
+                           GetCpuModel()};
+  for (size_t k = 0; k < passes.size(); k++) {
+    const PlanPass* pass = &passes[k];
+    // The merges run one after the other, each on the output of the last
+    if (pass->phase == kPhaseMergeJoin) {
+      for (size_t t = 0; t < sorts.size(); t++) {
+        num_traces = sorts[t].Merge(fp, num_traces);
+      }
+      num_traces = RunMergeJoin(fp, data, *pass, num_traces);
+      continue;
+    }
+    const QueryPlan* p = &plan;
+    const PlanData<Layout>* d = &data;
+    int step = pass->column ? kCachelineSize / kCellSize * plan.prefetch_size
+                            : 1;
+    ShardBody body =
+        [=](TraceWriter* fp, int64_t begin, int64_t end, int64_t num_traces) {
+      return pass->column
+          ? RunColumnPass(fp, *p, *d, *pass, begin, end, num_traces)
+          : RunRowPass(fp, *d, *pass, begin, end, num_traces);
+    };
+    if (plan.threads.num_threads <= 1) {
+      num_traces = ShardTuples(fp, plan.num_tuples, step, num_traces, body);
+    } else if (InterleaveThreads(fp, plan.threads, plan.num_tuples, step,
+                                 &num_traces, body) != kSuccess) {
+      fprintf(stderr, "Failed to generate the threads of %s\n",
+              fp->name().c_str());
+      fp->Fail();
+      break;
+    }
+  }
+  return num_traces;
+}
+
+int64_t ExecutePlan(TraceWriter* fp, const QueryPlan& plan, MemoryType memory,
+                    int64_t num_traces) {
+  std::vector<PlanPass> passes;
+  JoinDesc join = {kPlanKeepAll, 0, 1, 0, 0};
+  GroupDesc group = {0, 0, 0, 1, GroupBy{0, kPeriodicValues}};
+  if (LowerPlan(plan, memory, &passes, &join, &group) != kSuccess) {
+    fprintf(stderr, "Invalid query plan\n");
+    return num_traces;
+  }
+  if (!LayoutFits(plan.layout, plan.tuple_size)) {
+    fprintf(stderr, "Tuples of %d bytes do not fit layout %s\n",
+            plan.tuple_size, TableLayoutName(plan.layout).c_str());
+    return num_traces;
+  }
+  switch (plan.layout.kind) {
+    case kLayoutRowFirst:
+      return RunPasses<RowFirstLayout>(fp, plan, passes, join, group,
+                                       num_traces);
+    case kLayoutColumnFirst:
+      return RunPasses<ColumnFirstLayout>(fp, plan, passes, join, group,
+                                          num_traces);
+    case kLayoutPax:
+      return RunPasses<PaxLayout>(fp, plan, passes, join, group,
+                                  num_traces);
+    case kLayoutColumnGroup:
+      return RunPasses<ColumnGroupLayout>(fp, plan, passes, join, group,
+                                          num_traces);
+    case kLayoutHybridTile:
+      return RunPasses<HybridTileLayout>(fp, plan, passes, join, group,
+                                         num_traces);
+  }
+  return num_traces;
+}
+
+int GenPlanTrace(const char* trace_file_name, const QueryPlan& plan,
+                 MemoryType memory) {
+  if (!LayoutFits(plan.layout, plan.tuple_size)) {
+    fprintf(stderr, "Tuples of %d bytes do not fit layout %s\n",
+            plan.tuple_size, TableLayoutName(plan.layout).c_str());
+    return kFailure;
+  }
+  // ExecutePlan lowers it again; an invalid plan must not leave an empty
+  // trace behind as if it had succeeded
+  std::vector<PlanPass> passes;
+  JoinDesc join = {kPlanKeepAll, 0, 1, 0, 0};
+  GroupDesc group = {0, 0, 0, 1, GroupBy{0, kPeriodicValues}};
+  if (LowerPlan(plan, memory, &passes, &join, &group) != kSuccess) {
+    fprintf(stderr, "Invalid query plan for %s\n", trace_file_name);
+    return kFailure;
+  }
+  TraceWriter *fp = OpenTraceWriter(trace_file_name);
+  if (fp == NULL) return kFailure;
+  int64_t num_traces = ExecutePlan(fp, plan, memory, 0);
+  printf("Total number of traces: %lld\n", (long long)num_traces);
+  return CloseTraceWriter(fp);
+}
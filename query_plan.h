@@ -0,0 +1,252 @@
+/*
+ * query_plan.h
+ *
+ * Declarative query plans. A plan lists the operators of a query (scan,
+ * filter, join, row fetch, update, aggregate) over one or two tables, and
+ * ExecutePlan lowers it into the cache line accesses of either RC-NVM or a
+ * DRAM-only memory.
+ */
+
+#ifndef QUERY_PLAN_H_
+#define QUERY_PLAN_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <initializer_list>
+#include <string>
+#include <vector>
+#include "gen_trace.h"
+#include "column_values.h"
+#include "table_schema.h"
+#include "trace_threads.h"
+#include "trace_writer.h"
+
+enum MemoryType {
+  kRCNVM,  // column reads 'r' for column scans, row accesses 'R'/'W'
+  kDRAM,   // row accesses 'R'/'W' only
+};
+
+enum PlanOp {
+  kPlanScan,       // read fields of every tuple
+  kPlanFilter,     // keep the tuples that pass the predicate
+  kPlanJoin,       // match the scanned tables tuple by tuple
+  kPlanHashJoin,   // match the scanned tables through a hash table
+  kPlanMergeJoin,  // sort the scanned tables, then merge them
+  kPlanFetch,      // read fields of the kept tuples
+  kPlanUpdate,     // read and write back fields of the kept tuples
+  kPlanAggregate,  // read fields of the kept tuples into an aggregate
+  kPlanGroupBy,    // aggregate the kept tuples per group in a hash table
+};
+
+// How the OLXP join queries match their tables
+enum JoinKind {
+  kJoinByTuple,    // tuple t of table-a against tuple t of table-b (kPlanJoin)
+  kJoinHash,       // build a hash table on table-a, probe it with table-b
+  kJoinSortMerge,  // external sort of both tables, then a merge join
+};
+
+struct JoinMethod {
+  JoinKind kind;
+  int64_t run_tuples;  // of the sorted runs of kJoinSortMerge
+  int fan_in;          // runs a merge of kJoinSortMerge reads at once
+};
+
+const JoinMethod kJoinByTupleMethod = {kJoinByTuple, 0, 0};
+
+// Groups of a GROUP BY and how the group keys of the tuples spread over them
+struct GroupBy {
+  int64_t num_groups;
+  ValueDistribution keys;
+};
+
+const GroupBy kDefaultGroupBy = {4096, {kValuesUniform, 0}};
+
+enum AccessPath {
+  kColumnPath,  // on RC-NVM a scan reads columns, one cache line per block
+  kRowPath,     // the scan reads the rows of the tuples
+};
+
+// A field of a tuple in cells (kCellSize bytes)
+struct PlanField {
+  int cell;
+  int num_cells;
+};
+
+#define PLAN_FIELD(type, field) \
+  PlanField{(int)(offsetof(type, field) / kCellSize), \
+            (int)(sizeof(((type*)0)->field) / kCellSize)}
+#define PLAN_ALL_FIELDS(type) PlanField{0, (int)(sizeof(type) / kCellSize)}
+
+// A filter keeps tuple t when the value of t in each of its predicate
+// fields is at least threshold tenths of kValueDomain, i.e. (10 - threshold)
+// of every 10 tuples for uniform values; see THRESHOLD and THRESHOLD_LOW.
+// The values come from the ColumnValues of the plan. A join keeps tuple t
+// when t % 10 >= threshold.
+const int kPlanKeepAll = 0;
+
+// Where the OLXP queries put table-a and table-b
+const uint64_t kOLXPTableAAddr = 0x0u;
+const uint64_t kOLXPTableBAddr = 0x8000000u;
+// Where the OLXP joins put their hash table or sorted runs, past both tables
+const uint64_t kOLXPJoinAddr = 0x10000000u;
+// Where the OLXP aggregations put their hash table, the same place
+const uint64_t kOLXPGroupAddr = kOLXPJoinAddr;
+
+struct PlanNode {
+  PlanOp op;
+  int table;
+  std::vector<PlanField> fields;  // predicate fields of kPlanFilter
+  int threshold;    // kPlanFilter, kPlanJoin, kPlanHashJoin
+  AccessPath path;  // kPlanScan
+  uint64_t base_col_addr;  // of the hash table or runs of a join
+  int64_t run_tuples;      // kPlanMergeJoin
+  int fan_in;              // kPlanMergeJoin
+  GroupBy group_by;        // kPlanGroupBy, whose key is fields[0]
+};
+
+// Where a table of a plan lives: its tuples are laid out from base_col_addr
+// as the layout of the plan places them, see tuple_layout.h
+struct PlanTable {
+  uint64_t base_col_addr;
+  BankInterleave interleave;
+};
+
+struct QueryPlan {
+  // Table 0 is interleaved as GetBankInterleave() selects, the layout is
+  // GetTableLayout(), the values GetValueDistribution(), the join
+  // GetJoinMethod(), the groups GetGroupBy() and the threads
+  // GetTraceThreads()
+  QueryPlan(int64_t num_tuples, int tuple_size, uint64_t base_col_addr);
+
+  int64_t num_tuples;
+  int tuple_size;
+  TableLayout layout;         // of all tables
+  ValueDistribution values;   // of all fields of all tables
+  JoinMethod join;            // of AddOLXPQuery
+  GroupBy group_by;           // of AddOLXPQuery
+  // Logical threads every pass splits its tuples over, see trace_threads.h;
+  // the merges of a sort-merge join run on thread 0
+  TraceThreads threads;
+  // Cache line blocks a column scan reads field by field before moving on
+  int prefetch_size;
+  std::vector<PlanTable> tables;
+  std::vector<PlanNode> nodes;
+};
+
+// Adds a table to plan for joins, by default interleaved as
+// GetBankInterleave() selects
+void AddPlanTable(QueryPlan* plan, uint64_t base_col_addr,
+                  BankInterleave interleave);
+void AddPlanTable(QueryPlan* plan, uint64_t base_col_addr);
+
+void PlanScan(QueryPlan* plan, int table,
+              std::initializer_list<PlanField> fields,
+              AccessPath path = kColumnPath);
+// Filters the tuples of the table scanned last on the values of fields
+void PlanFilter(QueryPlan* plan, int threshold,
+                std::initializer_list<PlanField> fields);
+void PlanJoin(QueryPlan* plan, int threshold);
+// Hash join of table 0, the build side, and table 1, the probe side. The hash
+// table at base_col_addr has a bucket per build tuple, rounded up to a power
+// of two, and an entry per build tuple that holds fields of it and a link to
+// the next entry of its bucket. The build tuples have distinct keys; probe
+// tuple t has the key of a random build tuple when t % 10 >= threshold and a
+// key no build tuple has otherwise.
+void PlanHashJoin(QueryPlan* plan, int threshold,
+                  std::initializer_list<PlanField> fields,
+                  uint64_t base_col_addr);
+// Sort-merge join of table 0 and table 1, with the keys of PlanHashJoin. Both
+// tables are sorted into runs of run_tuples records, a record holding fields
+// and the tuple, which merges of fan_in runs at a time reduce to at most
+// fan_in runs per table; the merge join then reads them all. The runs of
+// table 0 and then those of table 1 go from base_col_addr on.
+void PlanMergeJoin(QueryPlan* plan, int threshold,
+                   std::initializer_list<PlanField> fields,
+                   uint64_t base_col_addr, int64_t run_tuples, int fan_in);
+void PlanFetch(QueryPlan* plan, int table,
+               std::initializer_list<PlanField> fields);
+void PlanUpdate(QueryPlan* plan, int table,
+                std::initializer_list<PlanField> fields);
+void PlanAggregate(QueryPlan* plan, int table,
+                   std::initializer_list<PlanField> fields);
+// Aggregates fields of the kept tuples of the table scanned last per group
+// of key, in a hash table at base_col_addr with linear probing. The table has
+// a slot per two groups, rounded up to a power of two, and an entry holds the
+// key and the aggregates. The group of tuple t is its value of key drawn from
+// group_by.keys over the group_by.num_groups groups.
+void PlanGroupBy(QueryPlan* plan, int table, PlanField key,
+                 std::initializer_list<PlanField> fields,
+                 const GroupBy& group_by, uint64_t base_col_addr);
+
+// Join method of query plans, selected once from main
+void SetJoinMethod(JoinMethod join);
+JoinMethod GetJoinMethod();
+// "tuple", "hash" or "merge[run_tuples[xfan_in]]"; returns kFailure for
+// anything else
+int ParseJoinMethod(const char* name, JoinMethod* join);
+// "tuple", "hash" or "merge<run_tuples>x<fan_in>"
+std::string JoinMethodName(const JoinMethod& join);
+
+// Groups of the OLXP GROUP BY query, selected once from main
+void SetGroupBy(const GroupBy& group_by);
+const GroupBy& GetGroupBy();
+// "<groups>[:<values>]", values as ParseValueDistribution takes them, by
+// default uniform; returns kFailure for anything else
+int ParseGroupBy(const char* name, GroupBy* group_by);
+// "g<groups>-<values>", as used in trace file names
+std::string GroupByName(const GroupBy& group_by);
+
+// Number of the OLXP queries in README.md
+const int kNumOLXPQueries = 16;
+
+// Appends the operators of query Q<query> of the OLXP workloads in README.md
+// to plan, with the fields looked up by name in schema, the joins made with
+// plan->join and the groups of a GROUP BY plan->group_by. Returns kFailure for
+// a query that has no plan or reads a field schema does not have, in which
+// case plan is left incomplete.
+int AddOLXPQuery(QueryPlan* plan, int query, const TableSchema& schema);
+// Same over the compiled-in IMDBRow, or IMDBOverCLRow for Q14
+int AddOLXPQuery(QueryPlan* plan, int query);
+
+// Emits the accesses of plan to fp, starting the access counter at
+// num_traces, and returns the counter after the last access.
+//
+// Lowering, per table:
+// - A column scan on RC-NVM reads a column cache line ('r') per block of
+//   kCachelineSize / kCellSize tuples and scanned cell. The rest of the
+//   plan then runs on the tuples of the block. Under layouts that do not
+//   stack consecutive tuples down columns, a block reads the column lines
+//   its tuples are at the top of instead.
+// - Any other scan reads ('R') the row cache lines holding the fields.
+// - Fetches read the row cache lines of their fields that the scan did not
+//   load. Updates also write ('W') them back.
+// - Aggregates over a column scan read the column cache lines of their
+//   fields for the blocks (lines) whose first tuple is kept. Otherwise they
+//   fetch.
+// - A join first scans every table in full. It then runs the fetches of all
+//   tables on every matching tuple.
+// - A hash join inserts every tuple of the build table as it is scanned: it
+//   reads and writes the row cache line of the bucket head, and writes an
+//   entry line once its last entry is filled. Every tuple of the probe table
+//   then reads its bucket head and the entry lines of the chain, and runs the
+//   fetches of both tables on the build tuple it matches.
+// - A merge join writes the sorted runs of a table as it is scanned, the
+//   lines of a run once its last tuple is in. After the scans it runs the
+//   merge passes of table 0, then those of table 1, and finally merges the
+//   runs of both tables, running the fetches of both tables on every match.
+//   The merges read a line of a run when they take its first record and
+//   write a line of their output once it is full; see external_sort.h.
+// - A GROUP BY reads the key and aggregate fields like an aggregate. Every
+//   kept tuple then reads the lines of the slots from the home slot of its
+//   group to the group's slot, and writes the group's line back.
+// Every scan loop is generated through ShardTuples. A plan whose tuples do
+// not fit its layout (see LayoutFits) emits nothing.
+int64_t ExecutePlan(TraceWriter* fp, const QueryPlan& plan, MemoryType memory,
+                    int64_t num_traces);
+
+// Opens trace_file_name, executes plan into it, and reports the number of
+// accesses like the hand-written generators do
+int GenPlanTrace(const char* trace_file_name, const QueryPlan& plan,
+                 MemoryType memory);
+
+#endif /* QUERY_PLAN_H_ */
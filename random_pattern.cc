@@ -54,7 +54,8 @@ int random_pattern(int num_query, int r_ratio, int w_ratio, int cr_ratio, const
       pos = pos << 12;
       pos = pos | rand() & 0xfff;
     }
-    fprintf(fp, "%d %d\n", op, GetCacheLineAddr(pos));
+    fprintf(fp, "%d %llu\n", op,
+            (unsigned long long)GetCacheLineAddr(pos));
   }
   fclose(fp);
   return kSuccess;
@@ -5,6 +5,7 @@
 #include "gen_trace.h"
 #include <stdio.h>
 #include "addr_util.h"
+#include "tuple_layout.h"
 
 // Generates row scan trace in row addressing, begin with a base address
 // The access pattern is read a row from base address sequentially.
@@ -22,43 +23,11 @@
 //+---------+---------+---------+---------+
 //|         |         |         | Tuple N |
 //+---------+---------+---------+---------+
-int GenRowTrace_5(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_row_addr) {
+int GenRowTrace_5(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_row_addr) {
   printf("GenRowTrace_5 is running\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *read_op = "R";
-  const char *op = read_op;
-
-  // Row access by cache line
-  // read num_traces cache lines
-  // Assume that kRowBufferSize is divisible by tuple_size, and tuple_size is
-  // larger than kCachelineSize
-  int num_traces = tuple_size * num_tuples / kCachelineSize;
-
-  uint32_t curr_addr = GetCacheLineAddr(base_row_addr);
-  printf("Base row address: 0x%08x\n", curr_addr);
-
-  for (int i = 0; i < num_traces; i++) {
-    // trace format needed by NVMain
-    // Op_Width: 0 for row access; 1, 2, 3 ... for column access
-    // Index Op Addr ThreadID Op_Width
-#ifdef DEBUG
-    Address addr;
-    ParseRowAddr(curr_addr, addr);
-    dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", i, op, curr_addr,
-            addr.highrow, addr.bank, addr.channel, addr.lowrow, addr.column,
-            addr.intrabus);
-#else
-    cprintf(fp, "%d %s 0x%08x 0 0\n", i, op, curr_addr);
-#endif
-    curr_addr += kCachelineSize; // increment by one cache line
-  }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  return GenRowLineTrace(trace_file_name, num_tuples, tuple_size,
+                         base_row_addr, kRowFirstLayout, "R");
 }
 
 // Layout 2, column-first:
@@ -73,46 +42,89 @@ int GenRowTrace_5(const char* trace_file_name, int num_tuples, int tuple_size,
 //+---------+---------+--+---------+
 //| Tuple 4 | Tuple 8 |  | Tuple N |
 //+---------+---------+--+---------+
-int GenRowTrace_6(const char* trace_file_name, int num_tuples, int tuple_size,
-                  uint32_t base_row_addr) {
+int GenRowTrace_6(const char* trace_file_name, int64_t num_tuples, int tuple_size,
+                  uint64_t base_row_addr) {
   printf("GenRowTrace_6 is running\n");
-  // TODO: Check the range of num_tuples
-  FILE *fp = fopen(trace_file_name, "w");
-  if (fp == NULL) return kFailure;
-
-  const char *read_op = "R";
-  const char *op = read_op;
-
-  int num_traces = 0;
-
-  // Count how many cache lines in one tuple
-  int cacheline_in_one_tuple = (tuple_size - 1) / kCachelineSize + 1;
-
-  base_row_addr = GetCacheLineAddr(base_row_addr);
-  uint32_t curr_row_addr = base_row_addr;
-  printf("Base row address: 0x%08x\n", base_row_addr);
+  return GenRowLineTrace(trace_file_name, num_tuples, tuple_size,
+                         base_row_addr, kColumnFirstLayout, "R");
+}
 
-  uint32_t base_col_addr = RowAddr2ColAddr(base_row_addr);
-  uint32_t curr_col_addr = base_col_addr;
-  
-  for(int i = 0; i < num_tuples; ++i) {
-    curr_col_addr = CalTupleColAddrLayout2(i, tuple_size, base_col_addr);
-    curr_row_addr = ColAddr2RowAddr(curr_col_addr);
-    for (int j = 0; j < cacheline_in_one_tuple; j++) {
+// Row lines of the tuples [0, num_tuples): a line per line_cells cells
+template <typename Layout>
+static int64_t TraceRowLines(TraceWriter* fp, const Layout& layout,
+                             int64_t num_tuples, int tuple_cells,
+                             int line_cells, const char* op) {
+  int64_t num_traces = 0;
+  for (int64_t i = 0; i < num_tuples; ++i) {
+    for (int cell = 0; cell < tuple_cells; cell += line_cells) {
+      uint64_t curr_row_addr =
+          GetCacheLineAddr(ColAddr2RowAddr(layout.CellAddr(i, cell)));
 #ifdef DEBUG
       Address addr;
-      ParseRowAddr(curr_row_addr + j * kCachelineSize, addr);
+      ParseRowAddr(curr_row_addr, addr);
       dprintf(fp, "%d %s 0x%08x 0 0, [%d %d %d %d %d %d]\n", num_traces, op,
-              curr_row_addr + j * kCachelineSize, addr.highrow, addr.bank,
-              addr.channel, addr.lowrow, addr.column, addr.intrabus);
+              curr_row_addr, addr.highrow, addr.bank, addr.channel,
+              addr.lowrow, addr.column, addr.intrabus);
 #else
-      cprintf(fp, "%d %s 0x%08x 0 0\n", num_traces, op,
-              curr_row_addr + j * kCachelineSize);
+      cprintf(fp, num_traces, op, curr_row_addr);
 #endif
       ++num_traces;
     }
   }
-  printf("Total number of traces: %d\n", num_traces);
-  fclose(fp);
-  return kSuccess;
+  return num_traces;
+}
+
+template <typename Layout>
+static int64_t TraceRowLines(TraceWriter* fp, const TableLayout& layout,
+                             int64_t num_tuples, int tuple_size,
+                             uint64_t base_col_addr, const char* op) {
+  Layout policy(layout, base_col_addr, GetBankInterleave(), tuple_size,
+                num_tuples);
+  return TraceRowLines(fp, policy, num_tuples, TupleCells(tuple_size),
+                       RowLineCells(layout), op);
+}
+
+int GenRowLineTrace(const char* trace_file_name, int64_t num_tuples,
+                    int tuple_size, uint64_t base_row_addr,
+                    const TableLayout& layout, const char* op) {
+  if (!LayoutFits(layout, tuple_size)) {
+    fprintf(stderr, "Tuples of %d bytes do not fit layout %s\n", tuple_size,
+            TableLayoutName(layout).c_str());
+    return kFailure;
+  }
+  TraceWriter *fp = OpenTraceWriter(trace_file_name);
+  if (fp == NULL) return kFailure;
+
+  base_row_addr = GetCacheLineAddr(base_row_addr);
+  printf("Base row address: 0x%08llx\n", (unsigned long long)base_row_addr);
+  uint64_t base_col_addr = RowAddr2ColAddr(base_row_addr);
+
+  int64_t num_traces = 0;
+  switch (layout.kind) {
+    case kLayoutRowFirst:
+      num_traces = TraceRowLines<RowFirstLayout>(fp, layout, num_tuples,
+                                                 tuple_size, base_col_addr, op);
+      break;
+    case kLayoutColumnFirst:
+      num_traces = TraceRowLines<ColumnFirstLayout>(fp, layout, num_tuples,
+                                                    tuple_size, base_col_addr,
+                                                    op);
+      break;
+    case kLayoutPax:
+      num_traces = TraceRowLines<PaxLayout>(fp, layout, num_tuples,
+                                            tuple_size, base_col_addr, op);
+      break;
+    case kLayoutColumnGroup:
+      num_traces = TraceRowLines<ColumnGroupLayout>(fp, layout, num_tuples,
+                                                    tuple_size, base_col_addr,
+                                                    op);
+      break;
+    case kLayoutHybridTile:
+      num_traces = TraceRowLines<HybridTileLayout>(fp, layout, num_tuples,
+                                                   tuple_size, base_col_addr,
+                                                   op);
+      break;
+  }
+  printf("Total number of traces: %lld\n", (long long)num_traces);
+  return CloseTraceWriter(fp);
 }
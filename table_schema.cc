@@ -0,0 +1,186 @@
+/*
+ * table_schema.cc
+ */
+
+#include "table_schema.h"
+#include "gen_trace.h"
+#include "addr_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int AddSchemaField(TableSchema* schema, const char* name, int width) {
+  if (width <= 0 || width % kCellSize != 0) return kFailure;
+  if (FindSchemaField(*schema, name) != NULL) return kFailure;
+  SchemaField field;
+  field.name = name;
+  field.width = width;
+  field.offset = schema->tuple_size;
+  field.cell = field.offset / kCellSize;
+  field.num_cells = width / kCellSize;
+  field.first_line = field.offset / kCachelineSize;
+  field.num_lines = (field.offset + width - 1) / kCachelineSize
+                    - field.first_line + 1;
+  schema->fields.push_back(field);
+  schema->tuple_size += width;
+  schema->num_lines = (schema->tuple_size - 1) / kCachelineSize + 1;
+  return kSuccess;
+}
+
+const SchemaField* FindSchemaField(const TableSchema& schema,
+                                   const char* name) {
+  for (size_t i = 0; i < schema.fields.size(); i++) {
+    if (schema.fields[i].name == name) return &schema.fields[i];
+  }
+  return NULL;
+}
+
+// Cuts the comment off line and splits the rest into at most max_words words
+static int SplitWords(char* line, char** words, int max_words) {
+  char* comment = strchr(line, '#');
+  if (comment != NULL) *comment = '\0';
+  int num_words = 0;
+  char* save;
+  for (char* word = strtok_r(line, " \t\r\n", &save); word != NULL;
+       word = strtok_r(NULL, " \t\r\n", &save)) {
+    if (num_words == max_words) return max_words + 1;
+    words[num_words++] = word;
+  }
+  return num_words;
+}
+
+int LoadSchemas(const char* file_name, std::vector<TableSchema>* schemas) {
+  FILE* fp = fopen(file_name, "r");
+  if (fp == NULL) {
+    fprintf(stderr, "Cannot open schema file %s\n", file_name);
+    return kFailure;
+  }
+  char line[256];
+  int line_num = 0;
+  TableSchema* schema = NULL;
+  const char* error = NULL;
+  while (error == NULL && fgets(line, sizeof(line), fp) != NULL) {
+    ++line_num;
+    char* words[3];
+    int num_words = SplitWords(line, words, 3);
+    if (num_words == 0) continue;
+    if (strcmp(words[0], "table") == 0) {
+      if (schema != NULL) {
+        error = "table inside a table";
+      } else if (num_words != 2) {
+        error = "expected: table <name>";
+      } else {
+        schemas->push_back(TableSchema());
+        schema = &schemas->back();
+        schema->name = words[1];
+        schema->interleave = GetBankInterleave();
+        schema->layout = GetTableLayout();
+        schema->values = GetValueDistribution();
+      }
+    } else if (strcmp(words[0], "end") == 0) {
+      if (schema == NULL || schema->fields.empty()) {
+        error = "end without fields";
+      }
+      schema = NULL;
+    } else if (schema == NULL) {
+      error = "field outside a table";
+    } else if (strcmp(words[0], "interleave") == 0) {
+      if (num_words != 2
+          || ParseBankInterleave(words[1], &schema->interleave) != kSuccess) {
+        error = "expected: interleave none|rr|xor";
+      }
+    } else if (strcmp(words[0], "layout") == 0) {
+      if (num_words != 2
+          || ParseTableLayout(words[1], &schema->layout) != kSuccess) {
+        error = "expected: layout row|col|pax|group[cells]|tile[tuples]";
+      }
+    } else if (strcmp(words[0], "values") == 0) {
+      if (num_words != 2
+          || ParseValueDistribution(words[1], &schema->values) != kSuccess) {
+        error = "expected: values periodic|uniform|zipf[s]|sorted|"
+                "runs[tuples]|corr[fraction]";
+      }
+    } else if (num_words < 2 || num_words > 3) {
+      error = "expected: <field> <width> [count]";
+    } else {
+      int width = atoi(words[1]);
+      int count = num_words == 3 ? atoi(words[2]) : 0;
+      if (num_words == 3 && count <= 0) error = "bad field count";
+      for (int i = 1; error == NULL && i <= (count > 0 ? count : 1); i++) {
+        std::string name = words[0];
+        if (count > 0) name += std::to_string(i);
+        if (AddSchemaField(schema, name.c_str(), width) != kSuccess) {
+          error = "bad width or duplicate field";
+        }
+      }
+    }
+  }
+  if (error == NULL && schema != NULL) error = "missing end";
+  fclose(fp);
+  if (error != NULL) {
+    fprintf(stderr, "%s:%d: %s\n", file_name, line_num, error);
+    return kFailure;
+  }
+  return kSuccess;
+}
+
+void PrintSchema(const TableSchema& schema) {
+  printf("Schema %s: %zu fields, %d bytes, %d cache lines, interleave %s, "
+         "layout %s, values %s\n", schema.name.c_str(), schema.fields.size(),
+         schema.tuple_size, schema.num_lines,
+         BankInterleaveName(schema.interleave),
+         TableLayoutName(schema.layout).c_str(),
+         ValueDistributionName(schema.values).c_str());
+  for (size_t i = 0; i < schema.fields.size(); i++) {
+    const SchemaField& field = schema.fields[i];
+    printf("  %-8s offset %5d width %4d lines %d-%d\n", field.name.c_str(),
+           field.offset, field.width, field.first_line,
+           field.first_line + field.num_lines - 1);
+  }
+}
+
+#define SCHEMA_FIELD(schema, type, field) \
+  AddSchemaField(schema, #field, sizeof(((type*)0)->field))
+
+static TableSchema MakeIMDBRowSchema() {
+  TableSchema schema;
+  schema.name = "IMDBRow";
+  SCHEMA_FIELD(&schema, IMDBRow, f1);
+  SCHEMA_FIELD(&schema, IMDBRow, f2);
+  SCHEMA_FIELD(&schema, IMDBRow, f3);
+  SCHEMA_FIELD(&schema, IMDBRow, f4);
+  SCHEMA_FIELD(&schema, IMDBRow, f5);
+  SCHEMA_FIELD(&schema, IMDBRow, f6);
+  SCHEMA_FIELD(&schema, IMDBRow, f7);
+  SCHEMA_FIELD(&schema, IMDBRow, f8);
+  SCHEMA_FIELD(&schema, IMDBRow, f9);
+  SCHEMA_FIELD(&schema, IMDBRow, f10);
+  SCHEMA_FIELD(&schema, IMDBRow, f11);
+  SCHEMA_FIELD(&schema, IMDBRow, f12);
+  SCHEMA_FIELD(&schema, IMDBRow, f13);
+  SCHEMA_FIELD(&schema, IMDBRow, f14);
+  SCHEMA_FIELD(&schema, IMDBRow, f15);
+  SCHEMA_FIELD(&schema, IMDBRow, f16);
+  return schema;
+}
+
+static TableSchema MakeIMDBOverCLRowSchema() {
+  TableSchema schema;
+  schema.name = "IMDBOverCLRow";
+  SCHEMA_FIELD(&schema, IMDBOverCLRow, f1);
+  SCHEMA_FIELD(&schema, IMDBOverCLRow, f2);
+  SCHEMA_FIELD(&schema, IMDBOverCLRow, f3);
+  SCHEMA_FIELD(&schema, IMDBOverCLRow, f4);
+  SCHEMA_FIELD(&schema, IMDBOverCLRow, f5);
+  return schema;
+}
+
+const TableSchema& IMDBRowSchema() {
+  static const TableSchema schema = MakeIMDBRowSchema();
+  return schema;
+}
+
+const TableSchema& IMDBOverCLRowSchema() {
+  static const TableSchema schema = MakeIMDBOverCLRowSchema();
+  return schema;
+}
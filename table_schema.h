@@ -0,0 +1,74 @@
+/*
+ * table_schema.h
+ *
+ * Runtime descriptors of the tuple format of a table. A schema lists the
+ * fields of a tuple in order with their widths, and keeps the cell offset and
+ * the cache lines every field spans, so that generators can look fields up by
+ * name instead of through offsetof on a compiled-in struct.
+ */
+
+#ifndef TABLE_SCHEMA_H_
+#define TABLE_SCHEMA_H_
+
+#include <string>
+#include <vector>
+#include "gen_trace.h"
+#include "column_values.h"
+
+struct SchemaField {
+  std::string name;
+  int width;       // bytes, a multiple of kCellSize
+  int offset;      // bytes from the start of the tuple
+  int cell;        // offset / kCellSize
+  int num_cells;
+  int first_line;  // first cache line of the tuple the field is in
+  int num_lines;   // cache lines the field stretches over
+};
+
+struct TableSchema {
+  TableSchema()
+      : tuple_size(0), num_lines(0), interleave(kInterleaveNone),
+        layout(kColumnFirstLayout), values(kPeriodicValues) {}
+
+  std::string name;
+  int tuple_size;  // bytes
+  int num_lines;   // cache lines of a tuple
+  std::vector<SchemaField> fields;
+  BankInterleave interleave;  // of the layout of the table
+  TableLayout layout;
+  ValueDistribution values;  // of all fields
+};
+
+// Appends a field of width bytes after the last field of schema and updates
+// the size of the tuple
+int AddSchemaField(TableSchema* schema, const char* name, int width);
+
+// Returns the field called name, or NULL if schema has none
+const SchemaField* FindSchemaField(const TableSchema& schema,
+                                   const char* name);
+
+// Loads the schemas of a text file, one block per table:
+//
+//   # comment
+//   table imdb-256
+//     interleave rr # optional: none, rr or xor, see BankInterleave
+//     layout pax    # optional: row, col, pax, group[cells] or tile[tuples]
+//     values zipf   # optional: see ParseValueDistribution
+//     key 8         # a field called key, 8 bytes wide
+//     f 8 31        # 31 fields f1 .. f31, 8 bytes wide each
+//   end
+//
+// Widths are in bytes and must be multiples of kCellSize. Tables without an
+// interleave, layout or values line get GetBankInterleave(), GetTableLayout()
+// or GetValueDistribution(). Appends the tables to schemas in
+// file order and returns kFailure on the first error.
+int LoadSchemas(const char* file_name, std::vector<TableSchema>* schemas);
+
+// Prints the fields of schema with their offsets and cache line spans
+void PrintSchema(const TableSchema& schema);
+
+// Schemas of the compiled-in IMDBRow and IMDBOverCLRow of gen_trace.h
+const TableSchema& IMDBRowSchema();
+const TableSchema& IMDBOverCLRowSchema();
+
+#endif /* TABLE_SCHEMA_H_ */
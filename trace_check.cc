@@ -0,0 +1,604 @@
+/*
+ * trace_check.cc
+ */
+
+#include "trace_check.h"
+#include "gen_trace.h"
+#include "addr_util.h"
+#include "cache_filter.h"
+#include "memory_timing.h"
+#include "query_plan.h"
+#include "trace_compress.h"
+#include "trace_writer.h"
+#include "tuple_layout.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <initializer_list>
+#include <unordered_map>
+#include <vector>
+
+static const char kCheckTextFile[] = "check-text.trace";
+static const char kCheckBinaryFile[] = "check-binary.trace.bin";
+static const char kCheckConvertedFile[] = "check-converted.trace";
+static const char kCheckCompressedFile[] = "check-compressed.trace.rcz";
+static const char kCheckDecompressedFile[] = "check-decompressed.trace";
+static const char kCheckGeometryFile[] = "check-geometry.cfg";
+
+// Device of the geometry check, whose Column field is wider than 32 bits.
+// Its column buffer spans the LowRow field, so that tables fill the device
+// in both formats.
+static const int kCheckHighRowBit = 2;
+static const int kCheckBankBit = 3;
+static const int kCheckChannelBit = 1;
+static const int kCheckLowRowBit = 12;
+static const int kCheckColumnBit = 33;
+static const int kCheckIntraBusBit = 3;
+static const int kCheckColumnBufferSize = 1 << kCheckLowRowBit;
+
+// Threads of the compressor and of DecompressTrace in the checks
+static const int kCheckCompressThreads = 2;
+
+// The access counter jumps every so many accesses, as it does in generators
+// that skip tuples
+static const int kCheckJumpAccesses = 1000;
+
+static inline uint64_t CheckHash(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ull;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+// Appends num_accesses accesses with everything an encoding has to keep:
+// all four ops, several threads and op widths, jumps of the access counter
+// and, at kAddr64, addresses above 32 bits
+static void AppendCheckAccesses(TraceWriter* fp, int num_accesses,
+                                AddrWidth width) {
+  static const char kOps[] = "RWrw";
+  int addr_bits = width == kAddr64 ? 40 : 32;
+  // Whole cache lines, whose last cell stays below 1 << addr_bits
+  uint64_t addr_mask = (1ull << addr_bits) - kCachelineSize;
+  int64_t n = 0;
+  for (int i = 0; i < num_accesses; i++) {
+    uint64_t h = CheckHash(i);
+    if (i % kCheckJumpAccesses == kCheckJumpAccesses - 1) n += h % 64 + 2;
+    fp->Append(n++, kOps[h & 3], (h >> 16) & addr_mask, (h >> 2) & 3,
+               (int)((h >> 4) & 3) * kCellSize);
+  }
+}
+
+// Writes the check accesses to file_name in format and width, compressed on
+// compress_threads threads unless it is 0
+static int WriteCheckTrace(const char* file_name, TraceFormat format,
+                           AddrWidth width, int num_accesses,
+                           int compress_threads = 0) {
+  TraceWriter writer;
+  writer.set_addr_width(width);
+  if (writer.Open(file_name, format, compress_threads) != kSuccess) {
+    fprintf(stderr, "Cannot open %s\n", file_name);
+    return kFailure;
+  }
+  AppendCheckAccesses(&writer, num_accesses, width);
+  return writer.Close();
+}
+
+// Size of file_name, or -1 if it cannot be read
+static int64_t FileSize(const char* file_name) {
+  FILE* fp = fopen(file_name, "rb");
+  if (fp == NULL) return -1;
+  int64_t size = fseeko(fp, 0, SEEK_END) == 0 ? (int64_t)ftello(fp) : -1;
+  fclose(fp);
+  return size;
+}
+
+// Whether file_a holds the bytes begin <= offset < end of file_b; end may be
+// past the end of file_b
+static bool SameBytes(const char* file_a, const char* file_b, uint64_t begin,
+                      uint64_t end) {
+  FILE* a = fopen(file_a, "rb");
+  FILE* b = fopen(file_b, "rb");
+  bool same = a != NULL && b != NULL && fseeko(b, begin, SEEK_SET) == 0;
+  uint64_t left = end - begin;
+  char block_a[1 << 16];
+  char block_b[1 << 16];
+  while (same) {
+    size_t size_a = fread(block_a, 1, sizeof(block_a), a);
+    size_t size_b = fread(block_b, 1,
+                          (size_t)std::min<uint64_t>(sizeof(block_b), left), b);
+    left -= size_b;
+    same = size_a == size_b && memcmp(block_a, block_b, size_a) == 0;
+    if (size_a < sizeof(block_a)) break;
+  }
+  if (a != NULL) fclose(a);
+  if (b != NULL) fclose(b);
+  return same;
+}
+
+int CheckBinaryTraces(int num_accesses) {
+  static const AddrWidth kWidths[] = {kAddr32, kAddr64};
+  for (size_t w = 0; w < sizeof(kWidths) / sizeof(kWidths[0]); w++) {
+    AddrWidth width = kWidths[w];
+    int version = width == kAddr64 ? kBinaryTraceVersion64
+                                   : kBinaryTraceVersion;
+    if (WriteCheckTrace(kCheckTextFile, kTraceText, width, num_accesses)
+            != kSuccess
+        || WriteCheckTrace(kCheckBinaryFile, kTraceBinary, width,
+                           num_accesses) != kSuccess
+        || ConvertBinaryTrace(kCheckBinaryFile, kCheckConvertedFile)
+            != kSuccess) {
+      fprintf(stderr, "Binary trace version %d check failed to write\n",
+              version);
+      return kFailure;
+    }
+    if (!SameBytes(kCheckConvertedFile, kCheckTextFile, 0, UINT64_MAX)) {
+      fprintf(stderr, "Binary trace version %d converts to other text than "
+              "%s; see %s\n", version, kCheckTextFile, kCheckConvertedFile);
+      return kFailure;
+    }
+    printf("Binary trace version %d: %d accesses convert back to the same "
+           "text\n", version, num_accesses);
+  }
+  unlink(kCheckTextFile);
+  unlink(kCheckBinaryFile);
+  unlink(kCheckConvertedFile);
+  return kSuccess;
+}
+
+int CheckCompressedTraces(int num_accesses) {
+  static const TraceFormat kFormats[] = {kTraceText, kTraceBinary};
+  for (size_t f = 0; f < sizeof(kFormats) / sizeof(kFormats[0]); f++) {
+    TraceFormat format = kFormats[f];
+    const char* name = format == kTraceBinary ? "binary" : "text";
+    const char* plain = format == kTraceBinary ? kCheckBinaryFile
+                                               : kCheckTextFile;
+    if (WriteCheckTrace(plain, format, kAddr64, num_accesses) != kSuccess
+        || WriteCheckTrace(kCheckCompressedFile, format, kAddr64,
+                           num_accesses, kCheckCompressThreads)
+            != kSuccess) {
+      fprintf(stderr, "Compressed %s trace check failed to write\n", name);
+      return kFailure;
+    }
+    int64_t file_size = FileSize(plain);
+    if (file_size < 0) return kFailure;
+    uint64_t size = file_size;
+    // The whole trace, its middle third, which starts and ends inside blocks
+    // of the text trace and spans some, and an empty range
+    uint64_t ranges[][2] = {
+      {0, UINT64_MAX},
+      {size / 3 + 1, size - size / 3 + 3},
+      {size / 2, size / 2},
+    };
+    for (size_t r = 0; r < sizeof(ranges) / sizeof(ranges[0]); r++) {
+      uint64_t begin = ranges[r][0];
+      uint64_t end = ranges[r][1];
+      if (DecompressTrace(kCheckCompressedFile, kCheckDecompressedFile, begin,
+                          end, kCheckCompressThreads) != kSuccess) {
+        fprintf(stderr, "Compressed %s trace check failed to decompress\n",
+                name);
+        return kFailure;
+      }
+      if (!SameBytes(kCheckDecompressedFile, plain, begin, end)) {
+        fprintf(stderr, "Bytes %llu to %llu of the compressed %s trace differ "
+                "from %s; see %s\n", (unsigned long long)begin,
+                (unsigned long long)std::min(end, size), name, plain,
+                kCheckDecompressedFile);
+        return kFailure;
+      }
+    }
+    printf("Compressed %s trace: %llu bytes decompress to the same bytes, "
+           "whole and in ranges\n", name, (unsigned long long)size);
+  }
+  unlink(kCheckTextFile);
+  unlink(kCheckBinaryFile);
+  unlink(kCheckCompressedFile);
+  unlink(kCheckDecompressedFile);
+  return kSuccess;
+}
+
+int CheckDryRun(int num_accesses) {
+  static const TraceFormat kFormats[] = {kTraceText, kTraceBinary};
+  static const AddrWidth kWidths[] = {kAddr32, kAddr64};
+  for (size_t f = 0; f < sizeof(kFormats) / sizeof(kFormats[0]); f++) {
+    for (size_t w = 0; w < sizeof(kWidths) / sizeof(kWidths[0]); w++) {
+      TraceFormat format = kFormats[f];
+      AddrWidth width = kWidths[w];
+      const char* file_name = format == kTraceBinary ? kCheckBinaryFile
+                                                     : kCheckTextFile;
+      const char* name = format == kTraceBinary ? "binary" : "text";
+      int bits = width == kAddr64 ? 64 : 32;
+      TraceWriter counter;
+      counter.set_addr_width(width);
+      counter.OpenCounting(file_name, format);
+      AppendCheckAccesses(&counter, num_accesses, width);
+      TraceStats stats = counter.stats();
+      counter.Close();
+      if (WriteCheckTrace(file_name, format, width, num_accesses)
+          != kSuccess) {
+        fprintf(stderr, "Dry run check of the %d-bit %s trace failed to "
+                "write\n", bits, name);
+        return kFailure;
+      }
+      int64_t size = FileSize(file_name);
+      if (size != (int64_t)stats.num_bytes) {
+        fprintf(stderr, "Dry run of the %d-bit %s trace counts %llu bytes, "
+                "but %s has %lld\n", bits, name,
+                (unsigned long long)stats.num_bytes, file_name,
+                (long long)size);
+        return kFailure;
+      }
+      printf("Dry run of the %d-bit %s trace: %llu bytes as written\n",
+             bits, name, (unsigned long long)stats.num_bytes);
+    }
+  }
+  unlink(kCheckTextFile);
+  unlink(kCheckBinaryFile);
+  return kSuccess;
+}
+
+// Moves the LowRow and Column fields of addr from the shifts of one format to
+// those of the other, with the widths of the check device
+static uint64_t MoveCheckFields(uint64_t addr, int low_row_from,
+                                int column_from, int low_row_to,
+                                int column_to) {
+  uint64_t low_row_mask = (1ull << kCheckLowRowBit) - 1;
+  uint64_t column_mask = (1ull << kCheckColumnBit) - 1;
+  uint64_t low_row = (addr >> low_row_from) & low_row_mask;
+  uint64_t column = (addr >> column_from) & column_mask;
+  addr &= ~((low_row_mask << low_row_from) | (column_mask << column_from));
+  return addr | (low_row << low_row_to) | (column << column_to);
+}
+
+int CheckWideGeometry(int num_addrs) {
+  FILE* fp = fopen(kCheckGeometryFile, "w");
+  if (fp == NULL) {
+    fprintf(stderr, "Cannot open %s\n", kCheckGeometryFile);
+    return kFailure;
+  }
+  fprintf(fp, "# Written by the geometry check of mode t\n"
+          "high_row_bits %d\nbank_bits %d\nchannel_bits %d\n"
+          "low_row_bits %d\ncolumn_bits %d\nintra_bus_bits %d\n"
+          "column_buffer_size %d\n",
+          kCheckHighRowBit, kCheckBankBit, kCheckChannelBit, kCheckLowRowBit,
+          kCheckColumnBit, kCheckIntraBusBit, kCheckColumnBufferSize);
+  if (fclose(fp) != 0) return kFailure;
+
+  DeviceGeometry saved = GetDeviceGeometry();
+  DeviceGeometry geometry;
+  if (LoadDeviceGeometry(kCheckGeometryFile, &geometry) != kSuccess
+      || SetDeviceGeometry(geometry) != kSuccess) {
+    fprintf(stderr, "Geometry check cannot select %s\n", kCheckGeometryFile);
+    return kFailure;
+  }
+  SelectAddrConverter();
+  int addr_bits = kCheckHighRowBit + kCheckBankBit + kCheckChannelBit
+                  + kCheckLowRowBit + kCheckColumnBit + kCheckIntraBusBit;
+  // Column addresses hold LowRow right above IntraBus, row addresses Column
+  int col_low_row_shift = kCheckIntraBusBit;
+  int col_column_shift = col_low_row_shift + kCheckLowRowBit;
+  int row_column_shift = kCheckIntraBusBit;
+  int row_low_row_shift = row_column_shift + kCheckColumnBit;
+  int status = kSuccess;
+  for (int i = 0; i < num_addrs && status == kSuccess; i++) {
+    // Every other address has the top Column bit set
+    uint64_t col_addr = CheckHash(i) & ((1ull << addr_bits) - 1);
+    if (i % 2 == 1) {
+      col_addr |= 1ull << (col_column_shift + kCheckColumnBit - 1);
+    }
+    uint64_t row_addr = MoveCheckFields(col_addr, col_low_row_shift,
+                                        col_column_shift, row_low_row_shift,
+                                        row_column_shift);
+    if (ColAddr2RowAddr(col_addr) != row_addr
+        || RowAddr2ColAddr(row_addr) != col_addr) {
+      fprintf(stderr, "Geometry check converts column address 0x%llx to "
+              "0x%llx and back to 0x%llx, not to 0x%llx\n",
+              (unsigned long long)col_addr,
+              (unsigned long long)ColAddr2RowAddr(col_addr),
+              (unsigned long long)RowAddr2ColAddr(row_addr),
+              (unsigned long long)row_addr);
+      status = kFailure;
+    }
+  }
+  // The largest table of 128-byte tuples ends on the last byte of the device
+  int64_t max_tuples = 1ll << (addr_bits - 7);
+  if (status == kSuccess
+      && (!TableFitsAddrSpace(max_tuples, 128, 0, kInterleaveNone)
+          || TableFitsAddrSpace(max_tuples + 1, 128, 0, kInterleaveNone))) {
+    fprintf(stderr, "Geometry check finds the device does not hold exactly "
+            "%lld tuples of 128 bytes\n", (long long)max_tuples);
+    status = kFailure;
+  }
+  if (status == kSuccess) {
+    printf("Geometry with a %d-bit Column: %d addresses of %d bits convert "
+           "both ways, %lld tuples of 128 bytes fit\n", kCheckColumnBit,
+           num_addrs, addr_bits, (long long)max_tuples);
+    unlink(kCheckGeometryFile);
+  }
+  SetDeviceGeometry(saved);
+  SelectAddrConverter();
+  return status;
+}
+
+// Join of the join checks: tuple t of table-b has a match when t % 10 >= it
+static const int kCheckJoinThreshold = 3;
+
+// An access of a traced plan
+struct CheckAccess {
+  char op;
+  uint64_t addr;
+};
+
+// Accesses of the trace of plan on memory, in order, through a memory writer
+static int TracePlan(const QueryPlan& plan, MemoryType memory,
+                     std::vector<CheckAccess>* accesses) {
+  TraceWriter writer;
+  writer.set_addr_width(kAddr64);
+  if (writer.OpenMemory(kTraceBinary) != kSuccess) return kFailure;
+  ExecutePlan(&writer, plan, memory, 0);
+  std::vector<char> records;
+  writer.TakeMemory(&records);
+  if (writer.Close() != kSuccess) return kFailure;
+  const char* end = records.data() + records.size();
+  CheckAccess access;
+  int op_width;
+  for (const char* p = records.data();
+       (p = ReadBinaryAccess(p, end, &access.op, &access.addr, &op_width,
+                             NULL, 0)) != NULL;) {
+    accesses->push_back(access);
+  }
+  return kSuccess;
+}
+
+// Row reads of every line in the trace of plan on memory
+static int CountRowReads(const QueryPlan& plan, MemoryType memory,
+                         std::unordered_map<uint64_t, int>* reads) {
+  std::vector<CheckAccess> accesses;
+  if (TracePlan(plan, memory, &accesses) != kSuccess) return kFailure;
+  for (size_t i = 0; i < accesses.size(); i++) {
+    if (accesses[i].op == 'R') ++(*reads)[accesses[i].addr];
+  }
+  return kSuccess;
+}
+
+// Plan of table-a joined with table-b of num_tuples IMDBRows on f9, which
+// fetches f4 of table-b for every match, laid out column-first without
+// interleaving whatever the options select
+static QueryPlan CheckJoinPlan(int64_t num_tuples) {
+  QueryPlan plan(num_tuples, sizeof(IMDBRow), kOLXPTableAAddr);
+  plan.tables[0].interleave = kInterleaveNone;
+  AddPlanTable(&plan, kOLXPTableBAddr, kInterleaveNone);
+  plan.layout = kColumnFirstLayout;
+  plan.values = kPeriodicValues;
+  plan.threads = kSingleTraceThread;
+  PlanScan(&plan, 0, {PLAN_FIELD(IMDBRow, f9)});
+  PlanScan(&plan, 1, {PLAN_FIELD(IMDBRow, f9)});
+  return plan;
+}
+
+// Whether every tuple of table-b of plan with a match has the row line of f4
+// read exactly once, and the others not at all; name is the join
+static bool FetchesMatchesOnce(const QueryPlan& plan, const char* name) {
+  std::unordered_map<uint64_t, int> reads;
+  if (CountRowReads(plan, kRCNVM, &reads) != kSuccess) {
+    fprintf(stderr, "%s check failed to trace its plan\n", name);
+    return false;
+  }
+  ColumnFirstLayout table_b(plan.layout, kOLXPTableBAddr, kInterleaveNone,
+                            plan.tuple_size, plan.num_tuples);
+  int f4 = PLAN_FIELD(IMDBRow, f4).cell;
+  for (int64_t t = 0; t < plan.num_tuples; t++) {
+    uint64_t line = GetCacheLineAddr(ColAddr2RowAddr(table_b.CellAddr(t, f4)));
+    int expected = t % 10 >= kCheckJoinThreshold ? 1 : 0;
+    if (reads[line] != expected) {
+      fprintf(stderr, "%s fetches tuple %lld of table-b %d times, not %d\n",
+              name, (long long)t, reads[line], expected);
+      return false;
+    }
+  }
+  return true;
+}
+
+// Runs of the merge join check and runs it merges at once, so that both
+// tables take a merge pass before the join
+static const int kCheckRunTuples = 256;
+static const int kCheckFanIn = 4;
+
+int CheckHashJoin(int num_tuples) {
+  QueryPlan plan = CheckJoinPlan(num_tuples);
+  PlanHashJoin(&plan, kCheckJoinThreshold, {PLAN_FIELD(IMDBRow, f9)},
+               kOLXPJoinAddr);
+  PlanFetch(&plan, 1, {PLAN_FIELD(IMDBRow, f4)});
+  if (!FetchesMatchesOnce(plan, "Hash join")) return kFailure;
+  printf("Hash join: every probe tuple of %d with a match fetches once, the "
+         "others never\n", num_tuples);
+  return kSuccess;
+}
+
+int CheckMergeJoin(int num_tuples) {
+  QueryPlan plan = CheckJoinPlan(num_tuples);
+  PlanMergeJoin(&plan, kCheckJoinThreshold, {PLAN_FIELD(IMDBRow, f9)},
+                kOLXPJoinAddr, kCheckRunTuples, kCheckFanIn);
+  PlanFetch(&plan, 0, {PLAN_FIELD(IMDBRow, f3)});
+  PlanFetch(&plan, 1, {PLAN_FIELD(IMDBRow, f4)});
+  if (!FetchesMatchesOnce(plan, "Merge join")) return kFailure;
+  // Every match fetches its tuple of table-a too, the same one again if
+  // two probe tuples have its key
+  std::unordered_map<uint64_t, int> reads;
+  if (CountRowReads(plan, kRCNVM, &reads) != kSuccess) return kFailure;
+  ColumnFirstLayout table_a(plan.layout, kOLXPTableAAddr, kInterleaveNone,
+                            plan.tuple_size, plan.num_tuples);
+  int f3 = PLAN_FIELD(IMDBRow, f3).cell;
+  int64_t matches = 0;
+  int64_t expected = 0;
+  for (int64_t t = 0; t < num_tuples; t++) {
+    uint64_t addr = ColAddr2RowAddr(table_a.CellAddr(t, f3));
+    matches += reads[GetCacheLineAddr(addr)];
+    if (t % 10 >= kCheckJoinThreshold) ++expected;
+  }
+  if (matches != expected) {
+    fprintf(stderr, "Merge join fetches %lld tuples of table-a, not %lld\n",
+            (long long)matches, (long long)expected);
+    return kFailure;
+  }
+  printf("Merge join: %lld matches of %d tuples in runs of %d, fetched once "
+         "each\n", (long long)matches, num_tuples, kCheckRunTuples);
+  return kSuccess;
+}
+
+int CheckGroupBy(int num_tuples, int num_groups) {
+  QueryPlan plan(num_tuples, sizeof(IMDBRow), kOLXPTableAAddr);
+  plan.tables[0].interleave = kInterleaveNone;
+  plan.layout = kColumnFirstLayout;
+  plan.values = kPeriodicValues;
+  plan.threads = kSingleTraceThread;
+  GroupBy group_by = {num_groups, {kValuesUniform, 0}};
+  PlanScan(&plan, 0, {PLAN_FIELD(IMDBRow, f1), PLAN_FIELD(IMDBRow, f9)});
+  PlanGroupBy(&plan, 0, PLAN_FIELD(IMDBRow, f1), {PLAN_FIELD(IMDBRow, f9)},
+              group_by, kOLXPGroupAddr);
+  std::vector<CheckAccess> accesses;
+  if (TracePlan(plan, kRCNVM, &accesses) != kSuccess) {
+    fprintf(stderr, "GROUP BY check failed to trace its plan\n");
+    return kFailure;
+  }
+  // The hash table is the only thing past table-a. A probe reads the lines
+  // from the home slot of its group on, one after the other and wrapping to
+  // the first, and writes the last one.
+  uint64_t base = ColAddr2RowAddr(kOLXPGroupAddr);
+  int64_t num_probes = 0;
+  int64_t num_reads = 0;
+  uint64_t last_read = 0;
+  bool probing = false;
+  std::unordered_map<uint64_t, int> written;
+  for (size_t i = 0; i < accesses.size(); i++) {
+    const CheckAccess& access = accesses[i];
+    if (access.addr < base) continue;
+    const char* error = NULL;
+    if (access.op == 'R') {
+      if (probing && access.addr != last_read + kCachelineSize
+          && access.addr != base) {
+        error = "does not read the next line";
+      }
+      probing = true;
+      last_read = access.addr;
+      ++num_reads;
+    } else if (access.op != 'W') {
+      error = "has an access other than R and W";
+    } else if (!probing || access.addr != last_read) {
+      error = "writes another line than it read last";
+    } else {
+      probing = false;
+      ++num_probes;
+      ++written[access.addr];
+    }
+    if (error != NULL) {
+      fprintf(stderr, "GROUP BY probe %lld %s at 0x%llx\n",
+              (long long)num_probes, error, (unsigned long long)access.addr);
+      return kFailure;
+    }
+  }
+  if (num_probes != num_tuples || probing
+      || written.size() > (size_t)num_groups) {
+    fprintf(stderr, "GROUP BY of %d tuples into %d groups probes %lld times "
+            "and writes %zu lines\n", num_tuples, num_groups,
+            (long long)num_probes, written.size());
+    return kFailure;
+  }
+  printf("GROUP BY: %d tuples probe %.2f lines each for %d groups in %zu "
+         "lines\n", num_tuples, (double)num_reads / num_probes, num_groups,
+         written.size());
+  return kSuccess;
+}
+
+int CheckCacheFilter() {
+  // A single set of two ways, which the lines below all map to
+  static const CacheConfig kConfig = {
+    1, {{2 * kCachelineSize, 2, kReplaceLRU}},
+  };
+  static const uint64_t kA = 0;
+  static const uint64_t kB = kCachelineSize;
+  static const uint64_t kC = 2 * kCachelineSize;
+  static const uint64_t kD = 3 * kCachelineSize;
+  struct {
+    char op;
+    uint64_t addr;
+    int fills;
+    int writebacks;  // of kA
+  } steps[] = {
+    {'R', kA, 1, 0},  // miss
+    {'R', kA, 0, 0},  // hit
+    {'W', kA, 0, 0},  // hit, kA dirty
+    {'R', kB, 1, 0},  // miss into the free way
+    {'R', kC, 1, 1},  // evicts kA, dirty
+    {'R', kD, 1, 0},  // evicts kB, clean
+    {'R', kC, 0, 0},  // hit
+  };
+  CacheHierarchy caches(kConfig);
+  CacheMiss out[kMaxCacheMisses];
+  for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+    int num_out = caches.Access(steps[i].op, steps[i].addr, 0, 0, out);
+    int fills = 0;
+    int writebacks = 0;
+    for (int m = 0; m < num_out; m++) {
+      if (out[m].op == 'R' && out[m].addr == steps[i].addr) {
+        ++fills;
+      } else if (out[m].op == 'W' && out[m].addr == kA) {
+        ++writebacks;
+      }
+    }
+    if (num_out != fills + writebacks || fills != steps[i].fills
+        || writebacks != steps[i].writebacks) {
+      fprintf(stderr, "Cache filter step %zu, %c 0x%llx, emits %d accesses "
+              "instead of %d fills and %d write-backs\n", i + 1, steps[i].op,
+              (unsigned long long)steps[i].addr, num_out, steps[i].fills,
+              steps[i].writebacks);
+      return kFailure;
+    }
+  }
+  printf("Cache filter: hits emit nothing, a dirty eviction one W and a clean "
+         "one none\n");
+  return kSuccess;
+}
+
+// Memory cycles of the row reads of addrs, which all arrive at once, and
+// their buffer hits
+static int64_t TimeRowReads(std::initializer_list<uint64_t> addrs,
+                            uint64_t* hits) {
+  MemoryTimer timer(kRCNVMTiming);
+  for (uint64_t addr : addrs) timer.Access('R', addr, 0);
+  timer.Finish();
+  *hits = 0;
+  for (size_t u = 0; u < timer.banks().size(); u++) {
+    *hits += timer.banks()[u].hits;
+  }
+  return timer.cycles();
+}
+
+int CheckMemoryTiming() {
+  // The next line of the row buffer of kA, and the same line of the next
+  // LowRow, which another row buffer of the bank holds
+  static const uint64_t kA = 0;
+  uint64_t next_line = kA + kCachelineSize;
+  uint64_t next_row = kA + (1ull << g_addr_codec.row_shift[kFieldLowRow]);
+  uint64_t hit_hits, conflict_hits, reorder_hits;
+  int64_t hit = TimeRowReads({kA, next_line}, &hit_hits);
+  int64_t conflict = TimeRowReads({kA, next_row}, &conflict_hits);
+  // FR-FCFS serves the hit before the older conflict
+  int64_t reorder = TimeRowReads({kA, next_row, next_line}, &reorder_hits);
+  if (hit_hits != 1 || conflict_hits != 0 || hit >= conflict) {
+    fprintf(stderr, "Memory timing takes %lld cycles with %llu hits for a "
+            "buffer hit and %lld with %llu for a conflict\n", (long long)hit,
+            (unsigned long long)hit_hits, (long long)conflict,
+            (unsigned long long)conflict_hits);
+    return kFailure;
+  }
+  if (reorder_hits != 1) {
+    fprintf(stderr, "Memory timing has %llu hits instead of 1 when a hit "
+            "waits behind a conflict\n", (unsigned long long)reorder_hits);
+    return kFailure;
+  }
+  printf("Memory timing: a buffer hit after a read takes %lld cycles in all, "
+         "a conflict %lld, and FR-FCFS serves a hit before a conflict (%lld)"
+         "\n", (long long)hit, (long long)conflict, (long long)reorder);
+  return kSuccess;
+}
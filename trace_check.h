@@ -0,0 +1,71 @@
+/*
+ * trace_check.h
+ *
+ * Self-checks of the trace encodings and of the generators, run by mode t.
+ * An encoding check writes the same accesses in two ways that must agree and
+ * compares the results. They work on scratch files "check-*" in the current
+ * directory, which they remove when they pass. A generator check traces a
+ * small case into memory and checks what its accesses must be.
+ */
+
+#ifndef TRACE_CHECK_H_
+#define TRACE_CHECK_H_
+
+// Accesses every check of mode t writes
+const int kCheckAccesses = 1 << 16;
+// Tuples of the tables of the generator checks
+const int kCheckTuples = 1 << 12;
+// Groups of the GROUP BY check
+const int kCheckGroups = 256;
+
+// Writes num_accesses accesses as a text trace and as a binary trace, for
+// both binary versions, converts the binary traces to text with
+// ConvertBinaryTrace and compares them with the text traces. Returns
+// kFailure on the first difference.
+int CheckBinaryTraces(int num_accesses);
+
+// Writes num_accesses accesses as a text and a binary trace, and again
+// through the block compressor, and compares what DecompressTrace gives for
+// the whole trace, its middle third and an empty range with the bytes
+// of the plain trace. Returns kFailure on the first difference.
+int CheckCompressedTraces(int num_accesses);
+
+// Counts num_accesses accesses with a dry run writer and writes them, as
+// text and binary traces of both address widths, and compares the bytes the
+// dry run reports with the size of the file. Returns kFailure if they differ.
+int CheckDryRun(int num_accesses);
+
+// Selects a device geometry with a Column field wider than 32 bits from a
+// geometry file, converts num_addrs addresses of it between the row and
+// column formats both ways and checks the table size limit of the device.
+// The geometry selected before is restored. Returns kFailure on the first
+// wrong address.
+int CheckWideGeometry(int num_addrs);
+
+// Traces a hash join of two tables of num_tuples tuples and checks that
+// every probe tuple with a match fetches its fields once, and the others
+// never. Returns kFailure if one does not.
+int CheckHashJoin(int num_tuples);
+
+// Traces a sort-merge join of the same tables, whose runs take a merge pass,
+// and checks that it finds a match for every probe tuple that has one and
+// fetches both of its tuples once. Returns kFailure otherwise.
+int CheckMergeJoin(int num_tuples);
+
+// Traces a GROUP BY of num_tuples tuples into num_groups groups and checks
+// that every tuple probes its hash table line by line from the home slot of
+// its group on and writes the line it stops at. Returns kFailure otherwise.
+int CheckGroupBy(int num_tuples, int num_groups);
+
+// Runs a few accesses through a cache of one set and checks what reaches
+// memory: nothing for a hit, a fill for a miss and a W for the eviction of a
+// dirty line only. Returns kFailure otherwise.
+int CheckCacheFilter();
+
+// Times two reads of one bank with the RC-NVM timing and checks that a
+// second read of the open row buffer finishes before one of another row, and
+// that a read of the open buffer goes before an older one of another row.
+// Returns kFailure otherwise.
+int CheckMemoryTiming();
+
+#endif /* TRACE_CHECK_H_ */
@@ -0,0 +1,295 @@
+/*
+ * trace_compress.cc
+ */
+
+#include "trace_compress.h"
+#include "gen_trace.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <algorithm>
+
+static int g_compress_threads = 0;
+
+void SetCompressThreads(int num_threads) {
+  g_compress_threads = num_threads < 0 ? 0 : num_threads;
+}
+
+int GetCompressThreads() {
+  return g_compress_threads;
+}
+
+static inline void StoreLE(unsigned char* p, uint64_t v, int size) {
+  for (int i = 0; i < size; i++) p[i] = (v >> (8 * i)) & 0xff;
+}
+
+static inline uint64_t LoadLE(const unsigned char* p, int size) {
+  uint64_t v = 0;
+  for (int i = size - 1; i >= 0; i--) v = (v << 8) | p[i];
+  return v;
+}
+
+BlockCompressor::BlockCompressor()
+    : fp_(NULL), block_size_(0), status_(kSuccess), offset_(0), next_seq_(0),
+      next_write_seq_(0), in_flight_(0), max_in_flight_(0), stop_(false) {
+}
+
+BlockCompressor::~BlockCompressor() {
+  if (!threads_.empty()) Finish();
+  for (size_t i = 0; i < free_buffers_.size(); i++) free(free_buffers_[i]);
+}
+
+int BlockCompressor::Start(FILE* fp, int block_size, int num_threads) {
+  if (num_threads < 1) num_threads = 1;
+  fp_ = fp;
+  block_size_ = block_size;
+  // Enough blocks in flight to keep every worker busy while the generator
+  // fills the next one, and no more
+  max_in_flight_ = 2 * num_threads;
+
+  unsigned char header[kCompressedTraceHeaderSize];
+  memset(header, 0, sizeof(header));
+  memcpy(header, kCompressedTraceMagic, sizeof(kCompressedTraceMagic));
+  StoreLE(header + 4, kCompressedTraceVersion, 2);
+  StoreLE(header + 6, kCodecZlib, 2);
+  StoreLE(header + 8, block_size, 4);
+  if (fwrite(header, 1, sizeof(header), fp_) != sizeof(header)) {
+    return kFailure;
+  }
+  offset_ = sizeof(header);
+
+  for (int i = 0; i < num_threads; i++) {
+    threads_.push_back(std::thread(&BlockCompressor::Worker, this));
+  }
+  return kSuccess;
+}
+
+char* BlockCompressor::Submit(char* block, size_t size) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  space_cond_.wait(lock, [this] { return in_flight_ < max_in_flight_; });
+  Block* b = new Block;
+  b->seq = next_seq_++;
+  b->raw = block;
+  b->raw_size = size;
+  pending_.push_back(b);
+  ++in_flight_;
+  work_cond_.notify_one();
+
+  if (!free_buffers_.empty()) {
+    char* buffer = free_buffers_.back();
+    free_buffers_.pop_back();
+    return buffer;
+  }
+  lock.unlock();
+  return (char*)malloc(block_size_);
+}
+
+void BlockCompressor::Worker() {
+  for (;;) {
+    Block* b;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_cond_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+      if (pending_.empty()) return;
+      b = pending_.front();
+      pending_.pop_front();
+    }
+
+    uLongf size = compressBound(b->raw_size);
+    b->data.resize(size);
+    int ret = compress2(b->data.data(), &size, (const Bytef*)b->raw,
+                        b->raw_size, kTraceCompressLevel);
+    b->data.resize(size);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (ret != Z_OK) status_ = kFailure;
+    free_buffers_.push_back(b->raw);
+    b->raw = NULL;
+    done_[b->seq] = b;
+    WriteReadyBlocks();
+  }
+}
+
+// Writes the compressed blocks that are next in file order; mutex_ is held
+void BlockCompressor::WriteReadyBlocks() {
+  std::map<uint64_t, Block*>::iterator it;
+  while ((it = done_.find(next_write_seq_)) != done_.end()) {
+    Block* b = it->second;
+    if (fwrite(b->data.data(), 1, b->data.size(), fp_) != b->data.size()) {
+      status_ = kFailure;
+    }
+    unsigned char entry[kCompressedTraceIndexEntrySize];
+    StoreLE(entry, offset_, 8);
+    StoreLE(entry + 8, b->data.size(), 4);
+    StoreLE(entry + 12, b->raw_size, 4);
+    index_.insert(index_.end(), entry, entry + sizeof(entry));
+    offset_ += b->data.size();
+
+    done_.erase(it);
+    delete b;
+    ++next_write_seq_;
+    --in_flight_;
+  }
+  space_cond_.notify_all();
+}
+
+int BlockCompressor::Finish() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_cond_.notify_all();
+  for (size_t i = 0; i < threads_.size(); i++) threads_[i].join();
+  threads_.clear();
+
+  unsigned char trailer[kCompressedTraceTrailerSize];
+  StoreLE(trailer, offset_, 8);
+  StoreLE(trailer + 8, index_.size() / kCompressedTraceIndexEntrySize, 4);
+  memcpy(trailer + 12, kCompressedTraceMagic, sizeof(kCompressedTraceMagic));
+  if (fwrite(index_.data(), 1, index_.size(), fp_) != index_.size()
+      || fwrite(trailer, 1, sizeof(trailer), fp_) != sizeof(trailer)) {
+    status_ = kFailure;
+  }
+  return status_;
+}
+
+struct IndexEntry {
+  uint64_t offset;
+  uint32_t compressed_size;
+  uint32_t raw_size;
+  uint64_t raw_offset;
+};
+
+static int ReadBlockIndex(FILE* in, const char* file_name,
+                          std::vector<IndexEntry>* index,
+                          uint32_t* block_size) {
+  unsigned char header[kCompressedTraceHeaderSize];
+  unsigned char trailer[kCompressedTraceTrailerSize];
+  if (fread(header, sizeof(header), 1, in) != 1
+      || memcmp(header, kCompressedTraceMagic,
+                sizeof(kCompressedTraceMagic)) != 0
+      || fseeko(in, -kCompressedTraceTrailerSize, SEEK_END) != 0
+      || fread(trailer, sizeof(trailer), 1, in) != 1
+      || memcmp(trailer + 12, kCompressedTraceMagic,
+                sizeof(kCompressedTraceMagic)) != 0) {
+    fprintf(stderr, "%s is not a compressed trace\n", file_name);
+    return kFailure;
+  }
+  int version = (int)LoadLE(header + 4, 2);
+  int codec = (int)LoadLE(header + 6, 2);
+  if (version != kCompressedTraceVersion || codec != kCodecZlib) {
+    fprintf(stderr, "Unsupported compressed trace version %d (codec %d)\n",
+            version, codec);
+    return kFailure;
+  }
+  *block_size = (uint32_t)LoadLE(header + 8, 4);
+
+  uint64_t index_offset = LoadLE(trailer, 8);
+  uint32_t num_blocks = (uint32_t)LoadLE(trailer + 8, 4);
+  std::vector<unsigned char> data(
+      (size_t)num_blocks * kCompressedTraceIndexEntrySize);
+  if (fseeko(in, index_offset, SEEK_SET) != 0
+      || fread(data.data(), 1, data.size(), in) != data.size()) {
+    fprintf(stderr, "%s: truncated block index\n", file_name);
+    return kFailure;
+  }
+  uint64_t raw_offset = 0;
+  index->resize(num_blocks);
+  for (uint32_t k = 0; k < num_blocks; k++) {
+    const unsigned char* p = data.data() + k * kCompressedTraceIndexEntrySize;
+    IndexEntry& entry = (*index)[k];
+    entry.offset = LoadLE(p, 8);
+    entry.compressed_size = (uint32_t)LoadLE(p + 8, 4);
+    entry.raw_size = (uint32_t)LoadLE(p + 12, 4);
+    entry.raw_offset = raw_offset;
+    raw_offset += entry.raw_size;
+  }
+  return kSuccess;
+}
+
+static void InflateBlock(int fd, const IndexEntry* entry,
+                         std::vector<unsigned char>* raw, int* status) {
+  std::vector<unsigned char> data(entry->compressed_size);
+  if (pread(fd, data.data(), data.size(), entry->offset)
+      != (ssize_t)data.size()) {
+    *status = kFailure;
+    return;
+  }
+  raw->resize(entry->raw_size);
+  uLongf size = entry->raw_size;
+  if (uncompress(raw->data(), &size, data.data(), data.size()) != Z_OK
+      || size != entry->raw_size) {
+    *status = kFailure;
+  }
+}
+
+int DecompressTrace(const char* compressed_file_name,
+                    const char* output_file_name, uint64_t begin,
+                    uint64_t end, int num_threads) {
+  FILE* in = fopen(compressed_file_name, "rb");
+  if (in == NULL) return kFailure;
+  std::vector<IndexEntry> index;
+  uint32_t block_size;
+  if (ReadBlockIndex(in, compressed_file_name, &index, &block_size)
+      != kSuccess) {
+    fclose(in);
+    return kFailure;
+  }
+  FILE* out = fopen(output_file_name, "wb");
+  if (out == NULL) {
+    fclose(in);
+    return kFailure;
+  }
+  if (num_threads < 1) num_threads = 1;
+
+  // Blocks overlapping [begin, end)
+  size_t first = 0;
+  while (first < index.size()
+         && index[first].raw_offset + index[first].raw_size <= begin) {
+    ++first;
+  }
+  size_t last = first;
+  while (last < index.size() && index[last].raw_offset < end) ++last;
+
+  int status = kSuccess;
+  uint64_t num_bytes = 0;
+  int fd = fileno(in);
+  std::vector<std::vector<unsigned char> > raw(num_threads);
+  std::vector<int> block_status(num_threads);
+  for (size_t k = first; k < last && status == kSuccess; k += num_threads) {
+    size_t num_blocks = std::min(last - k, (size_t)num_threads);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < num_blocks; i++) {
+      block_status[i] = kSuccess;
+      threads.push_back(std::thread(InflateBlock, fd, &index[k + i], &raw[i],
+                                    &block_status[i]));
+    }
+    for (size_t i = 0; i < num_blocks; i++) {
+      threads[i].join();
+      if (block_status[i] != kSuccess) {
+        fprintf(stderr, "%s: corrupt block %zu\n", compressed_file_name,
+                k + i);
+        status = kFailure;
+      }
+    }
+    for (size_t i = 0; i < num_blocks && status == kSuccess; i++) {
+      const IndexEntry& entry = index[k + i];
+      uint64_t from = begin > entry.raw_offset ? begin - entry.raw_offset : 0;
+      uint64_t to = std::min((uint64_t)entry.raw_size, end - entry.raw_offset);
+      to = std::max(from, to);  // nothing of an empty range
+      if (fwrite(raw[i].data() + from, 1, to - from, out) != to - from) {
+        status = kFailure;
+      }
+      num_bytes += to - from;
+    }
+  }
+  fclose(in);
+  if (fclose(out) != 0) status = kFailure;
+  if (status == kSuccess) {
+    printf("Decompressed %llu bytes (%zu of %zu blocks of %u bytes) "
+           "from %s to %s\n", (unsigned long long)num_bytes, last - first,
+           index.size(), block_size, compressed_file_name, output_file_name);
+  }
+  return status;
+}
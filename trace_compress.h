@@ -0,0 +1,114 @@
+/*
+ * trace_compress.h
+ *
+ * Block-compressed trace files. The output of a TraceWriter is cut into
+ * independent blocks that are deflated on worker threads while the generator
+ * keeps producing, and a block index at the end of the file lets a reader
+ * decompress any byte range of the trace in parallel.
+ */
+
+#ifndef TRACE_COMPRESS_H_
+#define TRACE_COMPRESS_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Compressed trace file, version 1. All fields are little endian.
+//
+// File header (16 bytes):
+// +----------+------------+----------+--------------+-------------+
+// | Magic(4) | Version(2) | Codec(2) | BlockSize(4) | Reserved(4) |
+// +----------+------------+----------+--------------+-------------+
+//
+// The header is followed by the blocks, each a zlib stream that inflates to
+// at most BlockSize bytes of the trace (text or binary, exactly as the
+// uncompressed writer would store it), and then by the block index and the
+// trailer:
+//
+// Index entry (16 bytes), one per block in file order:
+// +-----------+--------------------+-------------+
+// | Offset(8) | CompressedSize(4)  | RawSize(4)  |
+// +-----------+--------------------+-------------+
+//
+// Trailer (16 bytes):
+// +----------------+--------------+----------+
+// | IndexOffset(8) | NumBlocks(4) | Magic(4) |
+// +----------------+--------------+----------+
+const char kCompressedTraceMagic[4] = {'R', 'C', 'T', 'Z'};
+const int kCompressedTraceVersion = 1;
+const int kCompressedTraceHeaderSize = 16;
+const int kCompressedTraceIndexEntrySize = 16;
+const int kCompressedTraceTrailerSize = 16;
+const int kCodecZlib = 1;
+// zlib level of the blocks; the traces are repetitive enough that the
+// fastest level already compresses them well
+const int kTraceCompressLevel = 1;
+
+// Suffix OpenTraceWriter appends to the name of a compressed trace
+const char kCompressedTraceSuffix[] = ".rcz";
+
+// Number of worker threads compressing each trace file, 0 for uncompressed
+// output; selected once from main
+void SetCompressThreads(int num_threads);
+int GetCompressThreads();
+
+class BlockCompressor {
+ public:
+  BlockCompressor();
+  ~BlockCompressor();
+
+  // Writes the file header to fp and starts the worker threads
+  int Start(FILE* fp, int block_size, int num_threads);
+
+  // Queues the block_size byte buffer block, of which size bytes are used, for
+  // compression and takes ownership of it. Returns an empty buffer for the
+  // next block. Blocks while too many blocks are in flight.
+  char* Submit(char* block, size_t size);
+
+  // Waits for the queued blocks and writes the block index and trailer
+  int Finish();
+
+ private:
+  struct Block {
+    uint64_t seq;
+    char* raw;
+    size_t raw_size;
+    std::vector<unsigned char> data;
+  };
+
+  void Worker();
+  void WriteReadyBlocks();
+
+  FILE* fp_;
+  int block_size_;
+  int status_;
+  uint64_t offset_;
+  uint64_t next_seq_;
+  uint64_t next_write_seq_;
+  int in_flight_;
+  int max_in_flight_;
+  bool stop_;
+  std::mutex mutex_;
+  std::condition_variable work_cond_;
+  std::condition_variable space_cond_;
+  std::deque<Block*> pending_;
+  std::map<uint64_t, Block*> done_;
+  std::vector<char*> free_buffers_;
+  std::vector<unsigned char> index_;
+  std::vector<std::thread> threads_;
+};
+
+// Decompresses the bytes begin <= offset < end of the trace stored in
+// compressed_file_name into output_file_name, inflating the blocks of the
+// range on num_threads threads. end may be past the end of the trace.
+int DecompressTrace(const char* compressed_file_name,
+                    const char* output_file_name, uint64_t begin,
+                    uint64_t end, int num_threads);
+
+#endif /* TRACE_COMPRESS_H_ */
@@ -0,0 +1,95 @@
+/*
+ * trace_job.cc
+ */
+
+#include "trace_job.h"
+#include "gen_trace.h"
+#include <stdio.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+static int g_job_threads = 0;
+
+void SetJobThreads(int num_threads) {
+  g_job_threads = num_threads < 1 ? 1 : num_threads;
+}
+
+int GetJobThreads() {
+  if (g_job_threads > 0) return g_job_threads;
+  int num_threads = (int)std::thread::hardware_concurrency();
+  return num_threads > 0 ? num_threads : 1;
+}
+
+static const char* JobStatusName(TraceJob::Status status) {
+  switch (status) {
+    case TraceJob::kJobPending: return "pending";
+    case TraceJob::kJobDone: return "done";
+    case TraceJob::kJobFailed: return "FAILED";
+  }
+  return "?";
+}
+
+struct JobQueue {
+  std::vector<TraceJob>* jobs;
+  std::atomic<int> next;
+  int num_finished;
+  std::mutex report_mutex;
+};
+
+static void RunJobWorker(JobQueue* queue) {
+  std::vector<TraceJob>& jobs = *queue->jobs;
+  int total = (int)jobs.size();
+  for (int k = queue->next++; k < total; k = queue->next++) {
+    TraceJob& job = jobs[k];
+    uint64_t start = gettimestamp_ns();
+    int ret = job.run();
+    job.elapsed_ns = gettimestamp_ns() - start;
+    job.status = ret == kSuccess ? TraceJob::kJobDone : TraceJob::kJobFailed;
+
+    std::lock_guard<std::mutex> lock(queue->report_mutex);
+    ++queue->num_finished;
+    printf("[%d/%d] %s %s %s (%.3f s)\n", queue->num_finished, total,
+           JobStatusName(job.status), job.generator, job.trace_file_name,
+           job.elapsed_ns / 1e9);
+    fflush(stdout);
+  }
+}
+
+int RunTraceJobs(std::vector<TraceJob>& jobs) {
+  int num_threads = GetJobThreads();
+  if (num_threads > (int)jobs.size()) num_threads = (int)jobs.size();
+  printf("Running %zu trace jobs on %d threads\n", jobs.size(), num_threads);
+
+  JobQueue queue;
+  queue.jobs = &jobs;
+  queue.next = 0;
+  queue.num_finished = 0;
+
+  uint64_t start = gettimestamp_ns();
+  if (num_threads <= 1) {
+    RunJobWorker(&queue);
+  } else {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; i++) {
+      threads.push_back(std::thread(RunJobWorker, &queue));
+    }
+    for (int i = 0; i < num_threads; i++) threads[i].join();
+  }
+  uint64_t wall_ns = gettimestamp_ns() - start;
+
+  int num_failed = 0;
+  uint64_t busy_ns = 0;
+  printf("%-16s %-40s %-8s %10s\n", "Generator", "Trace file", "Status",
+         "Time (s)");
+  for (size_t k = 0; k < jobs.size(); k++) {
+    const TraceJob& job = jobs[k];
+    printf("%-16s %-40s %-8s %10.3f\n", job.generator, job.trace_file_name,
+           JobStatusName(job.status), job.elapsed_ns / 1e9);
+    if (job.status != TraceJob::kJobDone) ++num_failed;
+    busy_ns += job.elapsed_ns;
+  }
+  printf("%zu jobs, %d failed, wall-clock %.3f s, sum of job times %.3f s\n",
+         jobs.size(), num_failed, wall_ns / 1e9, busy_ns / 1e9);
+  return num_failed == 0 ? kSuccess : kFailure;
+}
@@ -0,0 +1,47 @@
+/*
+ * trace_job.h
+ *
+ * Runs independent trace generators concurrently on a bounded thread pool.
+ */
+
+#ifndef TRACE_JOB_H_
+#define TRACE_JOB_H_
+
+#include <stdint.h>
+#include <functional>
+#include <vector>
+
+struct TraceJob {
+  TraceJob(const char* generator, const char* trace_file_name,
+           const std::function<int()>& run)
+      : generator(generator), trace_file_name(trace_file_name), run(run),
+        status(kJobPending), elapsed_ns(0) {}
+
+  enum Status {
+    kJobPending,
+    kJobDone,
+    kJobFailed,
+  };
+
+  const char* generator;
+  const char* trace_file_name;
+  std::function<int()> run;  // returns kSuccess or kFailure
+  Status status;
+  uint64_t elapsed_ns;
+};
+
+// Adds a job that calls gen(file, args...), e.g.
+//   TRACE_JOB(jobs, GenHybTrace_1, "hybrid-qurey1-layout2.trace", num_tuples,
+//             sizeof(IMDBRow), 0x0u);
+#define TRACE_JOB(jobs, gen, file, ...) \
+  (jobs).push_back(TraceJob(#gen, file, std::bind(gen, file, __VA_ARGS__)))
+
+// Number of jobs run at the same time, selected once from main
+void SetJobThreads(int num_threads);
+int GetJobThreads();
+
+// Runs all jobs, reporting each job as it finishes and a summary with the
+// total wall-clock time at the end. Returns kFailure if any job failed.
+int RunTraceJobs(std::vector<TraceJob>& jobs);
+
+#endif /* TRACE_JOB_H_ */
@@ -0,0 +1,211 @@
+/*
+ * trace_shard.cc
+ */
+
+#include "trace_shard.h"
+#include "gen_trace.h"
+#include <stdio.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+static int g_shard_threads = 1;
+
+void SetShardThreads(int num_threads) {
+  g_shard_threads = num_threads < 1 ? 1 : num_threads;
+}
+
+int GetShardThreads() {
+  return g_shard_threads;
+}
+
+struct Shard {
+  int64_t begin;
+  int64_t end;
+  int64_t num_traces;        // counter advance of the shard
+  int64_t next_n;            // shard-relative counter after the last record
+  bool has_records;
+  bool wide;                 // an access needs 64-bit output
+  int64_t base;              // global counter of the shard's first access
+  int64_t expected_n;        // counter the output expects before the shard
+  std::vector<char> records; // kAddr64 binary records, shard-relative counters
+  std::vector<char> output;  // records encoded in the output format
+  size_t output_size;        // size of the output, mapped writers only
+  char* slot;                // where a mapped writer takes the output
+  int status;                // kFailure if the shard could not be generated
+};
+
+static void GenerateShard(Shard* shard, const ShardBody* body) {
+  TraceWriter writer;
+  writer.set_addr_width(kAddr64);
+  writer.set_keep_compute(true);
+  if (writer.OpenMemory(kTraceBinary) != kSuccess) {
+    shard->status = kFailure;
+    return;
+  }
+  shard->num_traces = (*body)(&writer, shard->begin, shard->end, 0);
+  shard->next_n = writer.next_n();
+  shard->wide = writer.wide();
+  writer.TakeMemory(&shard->records);
+  shard->has_records = !shard->records.empty();
+  writer.Close();
+}
+
+static void FormatShard(Shard* shard, TraceFormat format, AddrWidth width) {
+  TraceWriter writer;
+  writer.set_addr_width(width);
+  if (writer.OpenMemory(format) != kSuccess) {
+    shard->status = kFailure;
+    return;
+  }
+  writer.set_next_n(shard->expected_n);
+  AppendBinaryRecords(shard->records.data(), shard->records.size(),
+                      shard->base, &writer);
+  std::vector<char>().swap(shard->records);
+  writer.TakeMemory(&shard->output);
+  writer.Close();
+}
+
+static void SizeShard(Shard* shard, TraceFormat format, AddrWidth width) {
+  shard->output_size = FormatRecordsSize(shard->records.data(),
+                                         shard->records.size(), shard->base,
+                                         shard->expected_n, format, width);
+}
+
+static void FormatShardInto(Shard* shard, TraceFormat format,
+                            AddrWidth width) {
+  int64_t next_n = shard->expected_n;
+  FormatRecords(shard->records.data(), shard->records.size(), shard->base,
+                &next_n, format, width, shard->slot);
+  std::vector<char>().swap(shard->records);
+}
+
+// Formats the shards of a round straight into their slots of the mapped file:
+// a counting pass gives the size of every shard, and a prefix sum over the
+// sizes gives its offset. Returns kFailure if the file cannot grow, which
+// also fails the writer.
+static int MapShards(TraceWriter* fp, std::vector<Shard>& shards) {
+  int num_threads = (int)shards.size();
+  std::vector<std::thread> threads;
+  for (int k = 0; k < num_threads; k++) {
+    threads.push_back(std::thread(SizeShard, &shards[k], fp->format(),
+                                  fp->addr_width()));
+  }
+  for (size_t k = 0; k < threads.size(); k++) threads[k].join();
+
+  size_t total = 0;
+  for (int k = 0; k < num_threads; k++) total += shards[k].output_size;
+  char* slot = fp->Reserve(total);
+  if (slot == NULL) {
+    fprintf(stderr, "Failed to map %zu bytes of trace output\n", total);
+    return kFailure;
+  }
+  for (int k = 0; k < num_threads; k++) {
+    shards[k].slot = slot;
+    slot += shards[k].output_size;
+  }
+
+  threads.clear();
+  for (int k = 0; k < num_threads; k++) {
+    threads.push_back(std::thread(FormatShardInto, &shards[k], fp->format(),
+                                  fp->addr_width()));
+  }
+  for (size_t k = 0; k < threads.size(); k++) threads[k].join();
+  return kSuccess;
+}
+
+// Whether every shard of a round made it through its last step; fails fp
+// if not, since the round would leave a hole in the output
+static bool ShardsGenerated(TraceWriter* fp, const std::vector<Shard>& shards) {
+  for (size_t k = 0; k < shards.size(); k++) {
+    if (shards[k].status != kSuccess) {
+      fprintf(stderr, "Failed to generate the shards of %s\n",
+              fp->name().c_str());
+      fp->Fail();
+      return false;
+    }
+  }
+  return true;
+}
+
+int64_t ShardTuples(TraceWriter* fp, int64_t num_tuples, int step,
+                    int64_t num_traces, const ShardBody& body) {
+  int num_threads = GetShardThreads();
+  int64_t num_iters = num_tuples > 0 ? (num_tuples - 1) / step + 1 : 0;
+  if (num_threads <= 1 || num_iters < 2) {
+    return body(fp, 0, num_tuples, num_traces);
+  }
+
+  int64_t shard_iters = (num_iters - 1) / num_threads + 1;
+  shard_iters = std::min(shard_iters,
+                         (int64_t)std::max(1, kShardTuples / step));
+  std::vector<Shard> shards(num_threads);
+  int64_t expected_n = fp->next_n();
+
+  for (int64_t first_iter = 0; first_iter < num_iters;
+       first_iter += shard_iters * num_threads) {
+    std::vector<std::thread> threads;
+    for (int k = 0; k < num_threads; k++) {
+      Shard& shard = shards[k];
+      int64_t iter_begin = std::min(first_iter + k * shard_iters, num_iters);
+      int64_t iter_end = std::min(iter_begin + shard_iters, num_iters);
+      shard.begin = iter_begin * step;
+      shard.end = std::min(iter_end * step, num_tuples);
+      shard.num_traces = 0;
+      shard.next_n = 0;
+      shard.has_records = false;
+      shard.wide = false;
+      shard.status = kSuccess;
+      threads.push_back(std::thread(GenerateShard, &shard, &body));
+    }
+    for (size_t k = 0; k < threads.size(); k++) threads[k].join();
+    if (!ShardsGenerated(fp, shards)) break;
+
+    // Prefix sum over the shard counters
+    for (int k = 0; k < num_threads; k++) {
+      Shard& shard = shards[k];
+      shard.base = num_traces;
+      shard.expected_n = expected_n;
+      num_traces += shard.num_traces;
+      if (shard.has_records) expected_n = shard.base + shard.next_n;
+      if (shard.wide) fp->set_wide();
+    }
+
+    if (fp->counting() || fp->filtered() || fp->timed()) {
+      // Nothing to format; the writer only counts the records, or runs them
+      // through its caches or its timing model one after the other
+      for (int k = 0; k < num_threads; k++) {
+        AppendBinaryRecords(shards[k].records.data(),
+                            shards[k].records.size(), shards[k].base, fp);
+        std::vector<char>().swap(shards[k].records);
+      }
+      continue;
+    }
+    // The issue cycles run through the shards in order
+    for (int k = 0; k < num_threads; k++) {
+      fp->ClockRecords(shards[k].records.data(), shards[k].records.size(),
+                       shards[k].base);
+    }
+    if (fp->mapped()) {
+      // The rounds after a failed one have nowhere to go; Close reports it
+      if (MapShards(fp, shards) != kSuccess) break;
+      continue;
+    }
+
+    threads.clear();
+    for (int k = 0; k < num_threads; k++) {
+      threads.push_back(std::thread(FormatShard, &shards[k], fp->format(),
+                                    fp->addr_width()));
+    }
+    for (size_t k = 0; k < threads.size(); k++) threads[k].join();
+    if (!ShardsGenerated(fp, shards)) break;
+
+    for (int k = 0; k < num_threads; k++) {
+      fp->Write(shards[k].output.data(), shards[k].output.size());
+      std::vector<char>().swap(shards[k].output);
+    }
+  }
+  // The caches number their output themselves
+  if (!fp->filtered()) fp->set_next_n(expected_n);
+  return num_traces;
+}
@@ -0,0 +1,39 @@
+/*
+ * trace_shard.h
+ *
+ * Generates the tuple loop of a trace generator in shards on several threads.
+ */
+
+#ifndef TRACE_SHARD_H_
+#define TRACE_SHARD_H_
+
+#include <functional>
+#include "trace_writer.h"
+
+// Upper bound of the tuples one shard generates before its output is written,
+// which keeps the memory held by the shards of a round bounded
+const int kShardTuples = 1 << 18;
+
+// Number of threads a sharded generator runs on, selected once from main
+void SetShardThreads(int num_threads);
+int GetShardThreads();
+
+// body(fp, begin, end, num_traces) runs the iterations begin <= i < end of a
+// generator loop against fp, starting its access counter at num_traces, and
+// returns the counter after its last access.
+typedef std::function<int64_t(TraceWriter* fp, int64_t begin, int64_t end,
+                              int64_t num_traces)> ShardBody;
+
+// Runs the loop
+//   for (int64_t i = 0; i < num_tuples; i += step) { ... }
+// as shards of whole iterations. Every shard is generated on its own thread
+// into memory with its counter starting at 0; a prefix sum over the shard
+// counters then gives each shard its global base, and the shards are
+// formatted in parallel and written to fp in order; a mapped writer has them
+// formatted straight into their place in the file. The output is identical to
+// body(fp, 0, num_tuples, num_traces). Returns the counter after the loop.
+// A shard that cannot be generated fails fp, see TraceWriter::Fail.
+int64_t ShardTuples(TraceWriter* fp, int64_t num_tuples, int step,
+                    int64_t num_traces, const ShardBody& body);
+
+#endif /* TRACE_SHARD_H_ */
@@ -0,0 +1,234 @@
+/*
+ * trace_sweep.cc
+ */
+
+#include "trace_sweep.h"
+#include "addr_util.h"
+#include "trace_writer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Longest line of a spec file
+static const int kMaxSweepLine = 1024;
+
+// Parses every word of words as one value of a dimension into values;
+// false if one of them does not parse
+template <typename T>
+static bool ParseWords(const std::vector<char*>& words, std::vector<T>* values,
+                       bool (*parse)(const char*, T*)) {
+  values->clear();
+  for (size_t i = 1; i < words.size(); i++) {
+    T value;
+    if (!parse(words[i], &value)) return false;
+    values->push_back(value);
+  }
+  return !values->empty();
+}
+
+static bool ParseMemory(const char* word, MemoryType* memory) {
+  if (strcmp(word, "hybrid") == 0) {
+    *memory = kRCNVM;
+  } else if (strcmp(word, "dram") == 0) {
+    *memory = kDRAM;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+static bool ParseQuery(const char* word, int* query) {
+  char* end;
+  long value = strtol(word, &end, 10);
+  *query = (int)value;
+  return end != word && *end == '\0' && value >= 1 && value <= kNumOLXPQueries;
+}
+
+static bool ParseTuples(const char* word, int64_t* tuples) {
+  char* end;
+  long long value = strtoll(word, &end, 10);
+  *tuples = value;
+  return end != word && *end == '\0' && value > 0;
+}
+
+static bool ParseLayout(const char* word, TableLayout* layout) {
+  return ParseTableLayout(word, layout) == kSuccess;
+}
+
+static bool ParseValues(const char* word, ValueDistribution* values) {
+  return ParseValueDistribution(word, values) == kSuccess;
+}
+
+static bool ParsePrefetch(const char* word, int* prefetch_size) {
+  char* end;
+  long value = strtol(word, &end, 10);
+  *prefetch_size = (int)value;
+  return end != word && *end == '\0' && value >= 1 && value <= 1 << 16;
+}
+
+static bool ParseSelectivity(const char* word, int* selectivity) {
+  char* end;
+  long value = strtol(word, &end, 10);
+  *selectivity = (int)value;
+  return end != word && *end == '\0' && value >= 0 && value <= 10;
+}
+
+int LoadSweepSpec(const char* file_name, int64_t num_tuples,
+                  SweepSpec* spec) {
+  FILE* fp = fopen(file_name, "r");
+  if (fp == NULL) {
+    fprintf(stderr, "Cannot open sweep file %s\n", file_name);
+    return kFailure;
+  }
+  spec->memories = {kRCNVM, kDRAM};
+  spec->queries.clear();
+  for (int q = 1; q <= kNumOLXPQueries; q++) spec->queries.push_back(q);
+  spec->tuples = {num_tuples};
+  spec->layouts.clear();
+  spec->values.clear();
+  spec->prefetch_sizes = {1};
+  spec->selectivities.clear();
+  spec->schema_file.clear();
+  spec->base_col_addrs[0] = kOLXPTableAAddr;
+  spec->base_col_addrs[1] = kOLXPTableBAddr;
+  spec->output = ".";
+  spec->manifest.clear();
+
+  char line[kMaxSweepLine];
+  int line_num = 0;
+  const char* error = NULL;
+  while (error == NULL && fgets(line, sizeof(line), fp) != NULL) {
+    ++line_num;
+    char* comment = strchr(line, '#');
+    if (comment != NULL) *comment = '\0';
+    std::vector<char*> words;
+    char* save;
+    for (char* word = strtok_r(line, " \t\r\n", &save); word != NULL;
+         word = strtok_r(NULL, " \t\r\n", &save)) {
+      words.push_back(word);
+    }
+    if (words.empty()) continue;
+    const char* key = words[0];
+    if (strcmp(key, "memory") == 0) {
+      if (!ParseWords(words, &spec->memories, ParseMemory)) {
+        error = "expected: memory hybrid|dram ...";
+      }
+    } else if (strcmp(key, "query") == 0) {
+      if (!ParseWords(words, &spec->queries, ParseQuery)) {
+        error = "expected: query <1-16> ...";
+      }
+    } else if (strcmp(key, "tuples") == 0) {
+      if (!ParseWords(words, &spec->tuples, ParseTuples)) {
+        error = "expected: tuples <tuples> ...";
+      }
+    } else if (strcmp(key, "layout") == 0) {
+      if (!ParseWords(words, &spec->layouts, ParseLayout)) {
+        error = "expected: layout row|col|pax|group[cells]|tile[tuples] ...";
+      }
+    } else if (strcmp(key, "values") == 0) {
+      if (!ParseWords(words, &spec->values, ParseValues)) {
+        error = "expected: values periodic|uniform|zipf[s]|sorted|"
+                "runs[tuples]|corr[fraction] ...";
+      }
+    } else if (strcmp(key, "prefetch") == 0) {
+      if (!ParseWords(words, &spec->prefetch_sizes, ParsePrefetch)) {
+        error = "expected: prefetch <cache lines> ...";
+      }
+    } else if (strcmp(key, "selectivity") == 0) {
+      if (!ParseWords(words, &spec->selectivities, ParseSelectivity)) {
+        error = "expected: selectivity <0-10> ...";
+      }
+    } else if (strcmp(key, "schema") == 0) {
+      if (words.size() != 2) {
+        error = "expected: schema <schema file>";
+      } else {
+        spec->schema_file = words[1];
+      }
+    } else if (strcmp(key, "base") == 0) {
+      char* end_a = NULL;
+      char* end_b = NULL;
+      if (words.size() == 3) {
+        spec->base_col_addrs[0] = strtoull(words[1], &end_a, 0);
+        spec->base_col_addrs[1] = strtoull(words[2], &end_b, 0);
+      }
+      if (end_a == NULL || *end_a != '\0' || *end_b != '\0') {
+        error = "expected: base <table-a address> <table-b address>";
+      } else if (!FitsAddrSpace(spec->base_col_addrs[0])
+                 || !FitsAddrSpace(spec->base_col_addrs[1])) {
+        error = "base addresses outside the device (see -g)";
+      }
+    } else if (strcmp(key, "output") == 0) {
+      if (words.size() != 2) {
+        error = "expected: output <directory>";
+      } else {
+        spec->output = words[1];
+      }
+    } else if (strcmp(key, "manifest") == 0) {
+      if (words.size() != 2) {
+        error = "expected: manifest <file>";
+      } else {
+        spec->manifest = words[1];
+      }
+    } else {
+      error = "unknown key";
+    }
+  }
+  fclose(fp);
+  if (error != NULL) {
+    fprintf(stderr, "%s:%d: %s\n", file_name, line_num, error);
+    return kFailure;
+  }
+  if (spec->manifest.empty()) spec->manifest = spec->output + "/manifest.tsv";
+  return kSuccess;
+}
+
+bool SetPlanSelectivity(QueryPlan* plan, int selectivity) {
+  bool found = false;
+  for (size_t n = 0; n < plan->nodes.size(); n++) {
+    PlanNode& node = plan->nodes[n];
+    if (node.op == kPlanFilter || node.op == kPlanJoin
+        || node.op == kPlanHashJoin || node.op == kPlanMergeJoin) {
+      node.threshold = 10 - selectivity;
+      found = true;
+    }
+  }
+  return found;
+}
+
+static const char* JobStatusName(TraceJob::Status status) {
+  switch (status) {
+    case TraceJob::kJobPending: return "pending";
+    case TraceJob::kJobDone: return "done";
+    case TraceJob::kJobFailed: return "failed";
+  }
+  return "unknown";
+}
+
+int WriteSweepManifest(const char* file_name,
+                       const std::vector<SweepPoint>& points,
+                       const std::vector<TraceJob>& jobs) {
+  FILE* fp = fopen(file_name, "w");
+  if (fp == NULL) {
+    fprintf(stderr, "Cannot write manifest %s\n", file_name);
+    return kFailure;
+  }
+  fprintf(fp, "# file\tmemory\ttable\tquery\ttuples\tlayout\tvalues\t"
+          "prefetch\tselectivity\tstatus\n");
+  for (size_t i = 0; i < points.size(); i++) {
+    const SweepPoint& point = points[i];
+    std::string selectivity = point.selectivity == kSweepQuerySelectivity
+        ? "-" : std::to_string(point.selectivity);
+    fprintf(fp, "%s\t%s\t%s\t%d\t%lld\t%s\t%s\t%d\t%s\t%s\n",
+            TraceFileName(point.trace_file_name.c_str()).c_str(),
+            point.memory == kRCNVM ? "hybrid" : "dram", point.table.c_str(),
+            point.query, (long long)point.num_tuples,
+            TableLayoutName(point.layout).c_str(),
+            ValueDistributionName(point.values).c_str(), point.prefetch_size,
+            selectivity.c_str(), JobStatusName(jobs[i].status));
+  }
+  if (fclose(fp) != 0) {
+    fprintf(stderr, "Failed to write manifest %s\n", file_name);
+    return kFailure;
+  }
+  return kSuccess;
+}
@@ -0,0 +1,87 @@
+/*
+ * trace_sweep.h
+ *
+ * Sweeps of the OLXP query traces read at runtime, so that a new set of
+ * points needs a new spec file instead of a new main(). A spec file gives the
+ * values of each dimension of the sweep on a line of its own, and every
+ * combination of them becomes a trace:
+ *
+ *   # comment
+ *   memory      hybrid dram      # RC-NVM and DRAM traces (default: both)
+ *   query       1 4 14 15        # OLXP queries of README.md (default: all)
+ *   tuples      100000 500000    # tuples of every table (default: -t)
+ *   layout      col pax          # see ParseTableLayout (default: -l)
+ *   values      uniform zipf1.1  # see ParseValueDistribution (default: -v)
+ *   prefetch    1 32 128         # cache line blocks of a column scan
+ *                                # (default: 1)
+ *   selectivity 2 8              # tenths of the tuples every filter and
+ *                                # join keeps (default: those of the query)
+ *   schema      tables.schema    # tables of a schema file (default: the
+ *                                # compiled-in IMDB rows)
+ *   base        0x0 0x8000000    # column addresses of table-a and table-b
+ *   output      sweep1           # directory of the traces (default: .)
+ *   manifest    sweep1.tsv       # default: <output>/manifest.tsv
+ *
+ * The tables of a schema file keep their own layout and values unless the
+ * spec file has layout or values lines. Queries without filters or joins get
+ * a single point for all selectivities. The options of the command line
+ * (-J, -G, -T, -C, -L, -M, ...) hold for every point.
+ */
+
+#ifndef TRACE_SWEEP_H_
+#define TRACE_SWEEP_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "column_values.h"
+#include "gen_trace.h"
+#include "query_plan.h"
+#include "trace_job.h"
+
+struct SweepSpec {
+  std::vector<MemoryType> memories;
+  std::vector<int> queries;
+  std::vector<int64_t> tuples;
+  std::vector<TableLayout> layouts;       // empty: the tables' own
+  std::vector<ValueDistribution> values;  // empty: the tables' own
+  std::vector<int> prefetch_sizes;
+  std::vector<int> selectivities;         // empty: the queries' own
+  std::string schema_file;                // empty: IMDBRow and IMDBOverCLRow
+  uint64_t base_col_addrs[2];             // of table-a and table-b
+  std::string output;
+  std::string manifest;
+};
+
+// Selectivity of a point that keeps the thresholds of its query
+const int kSweepQuerySelectivity = -1;
+
+// A trace of a sweep and the values it has of every dimension
+struct SweepPoint {
+  std::string trace_file_name;  // as the job gets it, see TraceFileName
+  MemoryType memory;
+  std::string table;
+  int query;
+  int64_t num_tuples;
+  TableLayout layout;
+  ValueDistribution values;
+  int prefetch_size;
+  int selectivity;
+};
+
+// Loads the spec file, with the lines it leaves out as in the comment above
+// and num_tuples for the tuples. Returns kFailure on the first error.
+int LoadSweepSpec(const char* file_name, int64_t num_tuples,
+                  SweepSpec* spec);
+
+// Gives every filter and join of plan the threshold that keeps selectivity
+// tenths of the tuples; returns false if plan has none
+bool SetPlanSelectivity(QueryPlan* plan, int selectivity);
+
+// Writes a tab-separated line per point to file_name, with the file its trace
+// went to, its values and the status of jobs[i] for points[i]
+int WriteSweepManifest(const char* file_name,
+                       const std::vector<SweepPoint>& points,
+                       const std::vector<TraceJob>& jobs);
+
+#endif /* TRACE_SWEEP_H_ */
@@ -0,0 +1,222 @@
+/*
+ * trace_threads.cc
+ */
+
+#include "trace_threads.h"
+#include "gen_trace.h"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+static TraceThreads g_trace_threads = kSingleTraceThread;
+
+void SetTraceThreads(const TraceThreads& threads) {
+  g_trace_threads = threads;
+}
+
+const TraceThreads& GetTraceThreads() {
+  return g_trace_threads;
+}
+
+// Tuples of a morsel unless the name says
+static const int64_t kDefaultMorselTuples = 16384;
+
+int ParseTraceThreads(const char* name, TraceThreads* threads) {
+  char* end;
+  long num_threads = strtol(name, &end, 10);
+  if (end == name || num_threads < 1 || num_threads > kMaxTraceThreads) {
+    return kFailure;
+  }
+  TraceThreads result = kSingleTraceThread;
+  result.num_threads = (int)num_threads;
+  const char* p = end;
+  while (*p == ':') {
+    p++;
+    if (strncmp(p, "static", 6) == 0) {
+      result.schedule = kScheduleStatic;
+      p += 6;
+    } else if (strncmp(p, "morsel", 6) == 0) {
+      result.schedule = kScheduleMorsel;
+      result.morsel_tuples = kDefaultMorselTuples;
+      p += 6;
+      if (*p >= '0' && *p <= '9') {
+        result.morsel_tuples = strtoll(p, &end, 10);
+        p = end;
+        if (result.morsel_tuples < 1) return kFailure;
+      }
+    } else if (strncmp(p, "rr", 2) == 0) {
+      result.interleave = kThreadsRoundRobin;
+      p += 2;
+    } else if (strncmp(p, "prop", 4) == 0) {
+      result.interleave = kThreadsProportional;
+      p += 4;
+    } else {
+      return kFailure;
+    }
+  }
+  if (*p != '\0') return kFailure;
+  *threads = result;
+  return kSuccess;
+}
+
+std::string TraceThreadsName(const TraceThreads& threads) {
+  std::string name = "t" + std::to_string(threads.num_threads) + "-";
+  if (threads.schedule == kScheduleStatic) {
+    name += "static";
+  } else {
+    name += "morsel" + std::to_string(threads.morsel_tuples);
+  }
+  return name + (threads.interleave == kThreadsRoundRobin ? "-rr"
+                                                             : "-prop");
+}
+
+// A chunk or morsel of the loop and the accesses generated for it
+struct ThreadUnit {
+  int64_t begin;
+  int64_t end;
+  std::vector<char> records;  // kAddr64 binary records
+  int64_t num_accesses;
+  int status;
+};
+
+static void GenerateUnits(std::vector<ThreadUnit>* units,
+                          std::atomic<size_t>* next, const ShardBody* body) {
+  for (size_t k = (*next)++; k < units->size(); k = (*next)++) {
+    ThreadUnit& unit = (*units)[k];
+    TraceWriter writer;
+    writer.set_addr_width(kAddr64);
+    writer.set_keep_compute(true);
+    if (writer.OpenMemory(kTraceBinary) != kSuccess) {
+      unit.status = kFailure;
+      continue;
+    }
+    (*body)(&writer, unit.begin, unit.end, 0);
+    writer.TakeMemory(&unit.records);
+    writer.Close();
+    const char* end = unit.records.data() + unit.records.size();
+    char op;
+    uint64_t addr;
+    int op_width;
+    unit.num_accesses = 0;
+    for (const char* p = unit.records.data();
+         (p = ReadBinaryAccess(p, end, &op, &addr, &op_width, NULL, 0))
+             != NULL;) {
+      ++unit.num_accesses;
+    }
+  }
+}
+
+// The accesses of a thread, the units it ran one after the other
+struct ThreadStream {
+  ThreadStream() : unit(0), pos(NULL), done(0), total(0) {}
+
+  std::vector<ThreadUnit*> units;
+  size_t unit;
+  const char* pos;     // next record of units[unit]
+  int64_t done;        // accesses taken
+  int64_t total;       // accesses of all units
+
+  // Takes the next access of thread; false when there is none left. The
+  // work before it goes to fp.
+  bool Next(TraceWriter* fp, int thread, char* op, uint64_t* addr,
+            int* op_width) {
+    for (; unit < units.size(); unit++) {
+      const std::vector<char>& records = units[unit]->records;
+      if (pos == NULL) pos = records.data();
+      pos = ReadBinaryAccess(pos, records.data() + records.size(), op, addr,
+                             op_width, fp, thread);
+      if (pos != NULL) {
+        ++done;
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+int InterleaveThreads(TraceWriter* fp, const TraceThreads& threads,
+                      int64_t num_tuples, int step, int64_t* num_traces,
+                      const ShardBody& body) {
+  int num_threads = threads.num_threads;
+  int64_t num_iters = num_tuples > 0 ? (num_tuples - 1) / step + 1 : 0;
+  int64_t unit_iters = threads.schedule == kScheduleStatic
+      ? (num_iters + num_threads - 1) / num_threads
+      : std::max((int64_t)1, threads.morsel_tuples / step);
+  std::vector<ThreadUnit> units;
+  for (int64_t i = 0; i < num_iters; i += unit_iters) {
+    ThreadUnit unit;
+    unit.begin = i * step;
+    unit.end = std::min((i + unit_iters) * step, num_tuples);
+    unit.num_accesses = 0;
+    unit.status = kSuccess;
+    units.push_back(unit);
+  }
+
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> workers;
+  int num_workers = std::min(GetShardThreads(), (int)units.size());
+  for (int k = 0; k < num_workers; k++) {
+    workers.push_back(std::thread(GenerateUnits, &units, &next, &body));
+  }
+  for (size_t k = 0; k < workers.size(); k++) workers[k].join();
+  // A unit that could not be generated would leave a hole in its thread
+  for (size_t k = 0; k < units.size(); k++) {
+    if (units[k].status != kSuccess) return kFailure;
+  }
+
+  std::vector<ThreadStream> streams(num_threads);
+  for (size_t k = 0; k < units.size(); k++) {
+    int thread = (int)k;
+    if (threads.schedule == kScheduleMorsel) {
+      // The thread that has done the least takes the next morsel
+      thread = 0;
+      for (int t = 1; t < num_threads; t++) {
+        if (streams[t].total < streams[thread].total) thread = t;
+      }
+    }
+    streams[thread].units.push_back(&units[k]);
+    streams[thread].total += units[k].num_accesses;
+  }
+
+  char op;
+  uint64_t addr;
+  int op_width;
+  if (threads.interleave == kThreadsRoundRobin) {
+    for (bool any = true; any;) {
+      any = false;
+      for (int t = 0; t < num_threads; t++) {
+        if (!streams[t].Next(fp, t, &op, &addr, &op_width)) continue;
+        fp->Append((*num_traces)++, op, addr, t, op_width);
+        any = true;
+      }
+    }
+    return kSuccess;
+  }
+  // The next access of every thread is due at the fraction (done + 1) /
+  // total of its work; the earliest one goes first, ties in thread order
+  auto later = [&streams](int a, int b) {
+    double due_a = (double)(streams[a].done + 1) / streams[a].total;
+    double due_b = (double)(streams[b].done + 1) / streams[b].total;
+    return due_a != due_b ? due_a > due_b : a > b;
+  };
+  std::vector<int> heap;
+  for (int t = 0; t < num_threads; t++) {
+    if (streams[t].total > 0) heap.push_back(t);
+  }
+  std::make_heap(heap.begin(), heap.end(), later);
+  while (!heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end(), later);
+    int t = heap.back();
+    streams[t].Next(fp, t, &op, &addr, &op_width);
+    fp->Append((*num_traces)++, op, addr, t, op_width);
+    if (streams[t].done < streams[t].total) {
+      std::push_heap(heap.begin(), heap.end(), later);
+    } else {
+      heap.pop_back();
+    }
+  }
+  return kSuccess;
+}
@@ -0,0 +1,73 @@
+/*
+ * trace_threads.h
+ *
+ * Traces of a tuple loop run by several logical threads of the traced
+ * database, as a morsel-parallel scan runs on many cores. The tuples are
+ * split over the threads, the accesses of every thread are generated on
+ * their own and then interleaved into one trace, each access tagged with the
+ * ThreadID of its thread.
+ *
+ * Unlike the shards of trace_shard.h, which only speed up the generation of
+ * the single-threaded trace, the threads change the trace: concurrent
+ * scanners compete for the banks and row buffers the way the interleaving
+ * puts them.
+ */
+
+#ifndef TRACE_THREADS_H_
+#define TRACE_THREADS_H_
+
+#include <stdint.h>
+#include <string>
+#include "trace_shard.h"
+#include "trace_writer.h"
+
+// How the tuples are split over the threads
+enum ThreadSchedule {
+  kScheduleStatic,  // thread k takes the k-th of equal chunks of the tuples
+  kScheduleMorsel,  // morsels of the tuples go, in order, to the thread that
+                    // has the fewest accesses so far
+};
+
+// How the accesses of the threads are interleaved into one trace
+enum ThreadInterleave {
+  kThreadsRoundRobin,    // an access of every thread in turn
+  kThreadsProportional,  // every thread at the rate of its accesses, so
+                         // that all of them finish together
+};
+
+struct TraceThreads {
+  int num_threads;
+  ThreadSchedule schedule;
+  int64_t morsel_tuples;  // kScheduleMorsel
+  ThreadInterleave interleave;
+};
+
+const TraceThreads kSingleTraceThread = {1, kScheduleStatic, 0,
+                                         kThreadsRoundRobin};
+
+// ThreadID is a byte in binary traces
+const int kMaxTraceThreads = 256;
+
+// Threads of the query traces, selected once from main
+void SetTraceThreads(const TraceThreads& threads);
+const TraceThreads& GetTraceThreads();
+// "<threads>[:static|:morsel[tuples]][:rr|:prop]", static and rr by default;
+// returns kFailure for anything else
+int ParseTraceThreads(const char* name, TraceThreads* threads);
+// "t<threads>-<static|morsel<tuples>>-<rr|prop>", as used in trace file names
+std::string TraceThreadsName(const TraceThreads& threads);
+
+// Runs the loop
+//   for (int64_t i = 0; i < num_tuples; i += step) { ... }
+// of body, see ShardBody, on threads.num_threads logical threads. Every chunk
+// or morsel of whole iterations is generated into memory, on as many real
+// threads as GetShardThreads() allows, and the accesses of the threads are
+// then appended to fp as threads.interleave has them, numbered on from
+// *num_traces, which is left at the counter after the loop. Jumps of the
+// access counter within body are dropped. Returns kFailure, with nothing
+// appended, if a chunk or morsel could not be generated.
+int InterleaveThreads(TraceWriter* fp, const TraceThreads& threads,
+                      int64_t num_tuples, int step, int64_t* num_traces,
+                      const ShardBody& body);
+
+#endif /* TRACE_THREADS_H_ */
@@ -0,0 +1,889 @@
+/*
+ * trace_writer.cc
+ */
+
+#include "trace_writer.h"
+#include "gen_trace.h"
+#include "cache_filter.h"
+#include "memory_timing.h"
+#include "cpu_model.h"
+#include "trace_compress.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <mutex>
+
+static TraceFormat g_trace_format = kTraceText;
+
+void SetTraceFormat(TraceFormat format) {
+  g_trace_format = format;
+}
+
+TraceFormat GetTraceFormat() {
+  return g_trace_format;
+}
+
+static AddrWidth g_addr_width = kAddr32;
+
+void SetAddrWidth(AddrWidth width) {
+  g_addr_width = width;
+}
+
+AddrWidth GetAddrWidth() {
+  return g_addr_width;
+}
+
+// "00" .. "ff", two characters per byte value
+static const char kHexPairs[] =
+    "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+    "202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+    "404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+    "606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+    "808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+    "a0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+    "c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+    "e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+// "00" .. "99", two characters per value
+static const char kDecPairs[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Writes the digits of v, returns the end of the written digits
+template <typename Unsigned>
+static inline char* FormatDigits(char* p, Unsigned v) {
+  char digits[20];
+  char* end = digits + sizeof(digits);
+  char* d = end;
+  while (v >= 100) {
+    const char* pair = kDecPairs + (v % 100) * 2;
+    v /= 100;
+    *--d = pair[1];
+    *--d = pair[0];
+  }
+  if (v >= 10) {
+    *--d = kDecPairs[v * 2 + 1];
+    *--d = kDecPairs[v * 2];
+  } else {
+    *--d = (char)('0' + v);
+  }
+  while (d < end) *p++ = *d++;
+  return p;
+}
+
+// Same output as printf("%lld"), returns the end of the written digits
+static inline char* FormatDecimal(char* p, int64_t value) {
+  uint64_t v = (uint64_t)value;
+  if (value < 0) {
+    *p++ = '-';
+    v = 0u - v;
+  }
+  // 32-bit division is cheaper, and nearly every counter fits
+  if (v <= 0xffffffffu) return FormatDigits(p, (uint32_t)v);
+  return FormatDigits(p, v);
+}
+
+// Same output as printf("0x%08x")
+static inline char* FormatHex32(char* p, uint32_t v) {
+  p[0] = '0';
+  p[1] = 'x';
+  memcpy(p + 2, kHexPairs + ((v >> 24) & 0xff) * 2, 2);
+  memcpy(p + 4, kHexPairs + ((v >> 16) & 0xff) * 2, 2);
+  memcpy(p + 6, kHexPairs + ((v >> 8) & 0xff) * 2, 2);
+  memcpy(p + 8, kHexPairs + (v & 0xff) * 2, 2);
+  return p + 10;
+}
+
+// Same output as printf("0x%016llx")
+static inline char* FormatHex64(char* p, uint64_t v) {
+  p[0] = '0';
+  p[1] = 'x';
+  for (int i = 0; i < 8; i++) {
+    memcpy(p + 2 + 2 * i, kHexPairs + ((v >> (56 - 8 * i)) & 0xff) * 2, 2);
+  }
+  return p + 18;
+}
+
+// True if addr or n does not fit a 32-bit trace
+static inline bool IsWide(int64_t n, uint64_t addr) {
+  return (addr >> 32) != 0 || (uint64_t)n > 0xffffffffu;
+}
+
+TraceWriter::TraceWriter()
+    : fp_(NULL), compressor_(NULL), clock_(NULL), cache_(NULL), cache_n_(0),
+      timer_(NULL), cycles_fp_(NULL),
+      keep_compute_(false), in_memory_(false), fd_(-1), map_(NULL),
+      map_size_(0), offset_(0), counting_(false), format_(kTraceText),
+      addr_width_(GetAddrWidth()), wide_(false), next_n_(0), buffer_(NULL),
+      used_(0), status_(kSuccess) {
+}
+
+TraceWriter::~TraceWriter() {
+  Close();
+}
+
+int TraceWriter::Open(const char* trace_file_name, TraceFormat format,
+                      int compress_threads) {
+  fp_ = fopen(trace_file_name,
+              format == kTraceBinary || compress_threads > 0 ? "wb" : "w");
+  if (fp_ == NULL) return kFailure;
+  // The writer does its own buffering
+  setvbuf(fp_, NULL, _IONBF, 0);
+  if (AllocBuffer() != kSuccess) {
+    fclose(fp_);
+    fp_ = NULL;
+    return kFailure;
+  }
+  if (compress_threads > 0) {
+    compressor_ = new BlockCompressor();
+    if (compressor_->Start(fp_, kTraceBufferSize, compress_threads)
+        != kSuccess) {
+      Close();
+      return kFailure;
+    }
+  }
+  name_ = trace_file_name;
+  format_ = format;
+  next_n_ = 0;
+  status_ = kSuccess;
+  PutFileHeader();
+  return kSuccess;
+}
+
+int TraceWriter::OpenMapped(const char* trace_file_name, TraceFormat format) {
+  fd_ = open(trace_file_name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd_ < 0) return kFailure;
+  offset_ = 0;
+  used_ = 0;
+  status_ = kSuccess;
+  if (Reserve(0) == NULL) {
+    close(fd_);
+    fd_ = -1;
+    return kFailure;
+  }
+  name_ = trace_file_name;
+  format_ = format;
+  next_n_ = 0;
+  PutFileHeader();
+  return kSuccess;
+}
+
+int TraceWriter::OpenCounting(const char* trace_file_name,
+                              TraceFormat format) {
+  counting_ = true;
+  status_ = kSuccess;
+  name_ = trace_file_name;
+  memset(&stats_, 0, sizeof(stats_));
+  format_ = format;
+  next_n_ = 0;
+  if (format_ == kTraceBinary) stats_.num_bytes = kBinaryTraceHeaderSize;
+  return kSuccess;
+}
+
+int TraceWriter::RecordSize() const {
+  return addr_width_ == kAddr64 ? kBinaryTraceRecordSize64
+                                : kBinaryTraceRecordSize;
+}
+
+void TraceWriter::PutFileHeader() {
+  if (format_ != kTraceBinary) return;
+  int version = addr_width_ == kAddr64 ? kBinaryTraceVersion64
+                                       : kBinaryTraceVersion;
+  int record_size = RecordSize();
+  uint8_t* header = (uint8_t*)buffer_;
+  memset(header, 0, kBinaryTraceHeaderSize);
+  memcpy(header, kBinaryTraceMagic, sizeof(kBinaryTraceMagic));
+  header[4] = version & 0xff;
+  header[5] = (version >> 8) & 0xff;
+  header[6] = record_size & 0xff;
+  header[7] = (record_size >> 8) & 0xff;
+  used_ = kBinaryTraceHeaderSize;
+}
+
+char* TraceWriter::Reserve(size_t size) {
+  if (status_ != kSuccess) return NULL;
+  size_t offset = offset_ + used_;
+  // Keep a whole buffer of room behind the slot for the following Appends
+  size_t need = offset + size + kTraceBufferSize;
+  if (need > map_size_) {
+    // On failure the old mapping and the formatted bytes in it stay as they
+    // are, for Close to cut the file back to
+    size_t new_size = std::max(need, 2 * map_size_);
+    void* map = MAP_FAILED;
+    if (ftruncate(fd_, new_size) == 0) {
+      map = map_ == NULL
+          ? mmap(NULL, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0)
+          : mremap(map_, map_size_, new_size, MREMAP_MAYMOVE);
+    }
+    if (map == MAP_FAILED) {
+      status_ = kFailure;
+      return NULL;
+    }
+    map_ = (char*)map;
+    map_size_ = new_size;
+  }
+  offset_ = offset + size;
+  used_ = 0;
+  buffer_ = map_ + offset_;
+  return map_ + offset;
+}
+
+int TraceWriter::OpenMemory(TraceFormat format) {
+  if (AllocBuffer() != kSuccess) return kFailure;
+  in_memory_ = true;
+  status_ = kSuccess;
+  memory_.clear();
+  format_ = format;
+  next_n_ = 0;
+  return kSuccess;
+}
+
+int TraceWriter::OpenCycles(const char* cycles_file_name,
+                            const CpuModel& model) {
+  if (cycles_file_name != NULL) {
+    cycles_fp_ = fopen(cycles_file_name, "w");
+    if (cycles_fp_ == NULL) return kFailure;
+  }
+  clock_ = new CycleClock(model);
+  return kSuccess;
+}
+
+int TraceWriter::OpenCache(const CacheConfig& config) {
+  cache_ = new CacheHierarchy(config);
+  cache_n_ = 0;
+  return kSuccess;
+}
+
+int TraceWriter::OpenTiming(const TimingModel& model) {
+  timer_ = new MemoryTimer(model);
+  return kSuccess;
+}
+
+int TraceWriter::AllocBuffer() {
+  buffer_ = (char*)malloc(kTraceBufferSize);
+  used_ = 0;
+  return buffer_ == NULL ? kFailure : kSuccess;
+}
+
+int TraceWriter::Flush() {
+  if (status_ != kSuccess) return kFailure;
+  if (used_ == 0) return kSuccess;
+  int ret = kSuccess;
+  if (map_ != NULL) {
+    // The buffer is the mapping itself; move it past the formatted bytes
+    return Reserve(0) == NULL ? kFailure : kSuccess;
+  } else if (in_memory_) {
+    memory_.insert(memory_.end(), buffer_, buffer_ + used_);
+  } else if (compressor_ != NULL) {
+    // The buffer becomes one compressed block
+    buffer_ = compressor_->Submit(buffer_, used_);
+    if (buffer_ == NULL) ret = kFailure;
+  } else if (fwrite(buffer_, 1, used_, fp_) != used_) {
+    ret = kFailure;
+  }
+  used_ = 0;
+  // A failed write fails everything after it, up to Close
+  if (ret != kSuccess) status_ = kFailure;
+  return ret;
+}
+
+void TraceWriter::Fail() {
+  status_ = kFailure;
+}
+
+void TraceWriter::TakeMemory(std::vector<char>* out) {
+  Flush();
+  out->swap(memory_);
+  memory_.clear();
+}
+
+void TraceWriter::DrainCache() {
+  if (cache_ == NULL || (buffer_ == NULL && !counting_)) return;
+  std::vector<CacheMiss> writebacks;
+  cache_->Drain(&writebacks);
+  for (size_t i = 0; i < writebacks.size(); i++) {
+    Put(cache_n_++, writebacks[i].op, writebacks[i].addr,
+        writebacks[i].thread_id, writebacks[i].op_width);
+  }
+}
+
+int TraceWriter::Close() {
+  DrainCache();
+  int cycles_ret = kSuccess;
+  if (cycles_fp_ != NULL) {
+    bool failed = ferror(cycles_fp_) != 0;
+    if (fclose(cycles_fp_) != 0 || failed) cycles_ret = kFailure;
+    cycles_fp_ = NULL;
+  }
+  delete clock_;
+  clock_ = NULL;
+  if (cycles_ret != kSuccess) {
+    fprintf(stderr, "Failed to write the cycles of %s\n", name_.c_str());
+  }
+  delete cache_;
+  cache_ = NULL;
+  delete timer_;
+  timer_ = NULL;
+  if (wide_ && addr_width_ == kAddr32 && !in_memory_) {
+    fprintf(stderr, "Warning: %s has addresses or indices above 32 bits, "
+            "which are truncated; use 64-bit addresses (-a 64)\n",
+            name_.c_str());
+    wide_ = false;
+  }
+  if (counting_) {
+    counting_ = false;
+    return cycles_ret;
+  }
+  if (cycles_ret != kSuccess) status_ = kFailure;
+  if (map_ != NULL || fd_ >= 0) {
+    // Cut the file back to the formatted bytes
+    int ret = status_;
+    offset_ += used_;
+    used_ = 0;
+    if (map_ != NULL && munmap(map_, map_size_) != 0) ret = kFailure;
+    if (ftruncate(fd_, offset_) != 0 || close(fd_) != 0) ret = kFailure;
+    map_ = NULL;
+    map_size_ = 0;
+    fd_ = -1;
+    buffer_ = NULL;
+    return ret;
+  }
+  if (buffer_ == NULL && compressor_ == NULL) return kSuccess;
+  int ret = buffer_ == NULL ? kFailure : Flush();
+  if (status_ != kSuccess) ret = kFailure;
+  if (compressor_ != NULL) {
+    if (compressor_->Finish() != kSuccess) ret = kFailure;
+    delete compressor_;
+    compressor_ = NULL;
+  }
+  if (fp_ != NULL && fclose(fp_) != 0) ret = kFailure;
+  fp_ = NULL;
+  in_memory_ = false;
+  free(buffer_);
+  buffer_ = NULL;
+  return ret;
+}
+
+int TraceWriter::Write(const char* data, size_t size) {
+  if (counting_) {
+    stats_.num_bytes += size;
+    const char* end = data + size;
+    for (const char* p = data; p < end; p++) {
+      if (*p == '\n') ++stats_.num_lines;
+    }
+    return kSuccess;
+  }
+  if (status_ != kSuccess) return kFailure;
+  if (map_ != NULL) {
+    char* slot = Reserve(size);
+    if (slot == NULL) return kFailure;
+    memcpy(slot, data, size);
+    return kSuccess;
+  }
+  if (size < (size_t)kTraceBufferSize - used_) {
+    memcpy(buffer_ + used_, data, size);
+    used_ += size;
+    return kSuccess;
+  }
+  if (compressor_ != NULL) {
+    // Cut large writes into full blocks
+    while (size > 0) {
+      size_t chunk = std::min(size, (size_t)kTraceBufferSize - used_);
+      memcpy(buffer_ + used_, data, chunk);
+      used_ += chunk;
+      data += chunk;
+      size -= chunk;
+      if (used_ == (size_t)kTraceBufferSize && Flush() != kSuccess) {
+        return kFailure;
+      }
+    }
+    return kSuccess;
+  }
+  if (Flush() != kSuccess) return kFailure;
+  if (in_memory_) {
+    memory_.insert(memory_.end(), data, data + size);
+    return kSuccess;
+  }
+  if (fwrite(data, 1, size, fp_) != size) status_ = kFailure;
+  return status_;
+}
+
+// Encodes one binary record at p, returns the end of the record
+static inline char* EncodeRecord(char* p, uint8_t op, uint64_t addr,
+                                 int thread_id, int op_width,
+                                 AddrWidth width) {
+  uint8_t* record = (uint8_t*)p;
+  int addr_size = width == kAddr64 ? 8 : 4;
+  for (int i = 0; i < addr_size; i++) {
+    record[i] = (addr >> (8 * i)) & 0xff;
+  }
+  record += addr_size;
+  record[0] = op;
+  record[1] = (uint8_t)thread_id;
+  record[2] = (uint8_t)op_width;
+  record[3] = 0;
+  return (char*)record + 4;
+}
+
+// Formats the kLinesPerAccess NVMain lines of one access at p, returns the
+// end of the text
+static inline char* FormatAccess(char* p, int64_t n, char op, uint64_t addr,
+                                 int thread_id, int op_width,
+                                 AddrWidth width) {
+  // " <thread_id> <op_width>\n" is the same for all lines of the access
+  char tail[32];
+  char* t = tail;
+  *t++ = ' ';
+  t = FormatDecimal(t, thread_id);
+  *t++ = ' ';
+  t = FormatDecimal(t, op_width);
+  *t++ = '\n';
+  size_t tail_size = t - tail;
+
+  for (int i = 0; i < kLinesPerAccess; i++) {
+    p = FormatDecimal(p, n * kLinesPerAccess + i);
+    p[0] = ' ';
+    p[1] = op;
+    p[2] = ' ';
+    p = width == kAddr64 ? FormatHex64(p + 3, addr + kCellSize * i)
+                         : FormatHex32(p + 3, (uint32_t)(addr + kCellSize * i));
+    memcpy(p, tail, tail_size);
+    p += tail_size;
+  }
+  return p;
+}
+
+// Length of printf("%lld", value)
+static inline size_t DecimalSize(int64_t value) {
+  uint64_t v = (uint64_t)value;
+  size_t size = 1;
+  if (value < 0) {
+    ++size;
+    v = 0u - v;
+  }
+  for (; v >= 10; v /= 10) ++size;
+  return size;
+}
+
+// Bytes FormatAccess writes
+static inline size_t AccessSize(int64_t n, int thread_id, int op_width,
+                                AddrWidth width) {
+  // "<index> <op> 0x%08x <thread_id> <op_width>\n" without the index
+  size_t size = kLinesPerAccess
+      * (1 + 1 + 1 + (width == kAddr64 ? 18 : 10) + 1
+         + DecimalSize(thread_id) + 1
+         + DecimalSize(op_width) + 1);
+  for (int i = 0; i < kLinesPerAccess; i++) {
+    size += DecimalSize(n * kLinesPerAccess + i);
+  }
+  return size;
+}
+
+void TraceWriter::Count(int64_t n, char op, int thread_id, int op_width) {
+  ++stats_.num_accesses;
+  switch (op) {
+    case 'R': ++stats_.num_row_reads; break;
+    case 'W': ++stats_.num_row_writes; break;
+    case 'r': ++stats_.num_col_reads; break;
+    case 'w': ++stats_.num_col_writes; break;
+  }
+  if (format_ == kTraceBinary) {
+    stats_.num_bytes += (n != next_n_ ? 2 : 1) * RecordSize();
+    next_n_ = n + 1;
+  } else {
+    stats_.num_lines += kLinesPerAccess;
+    stats_.num_bytes += AccessSize(n, thread_id, op_width, addr_width_);
+  }
+}
+
+void TraceWriter::Append(int64_t n, char op, uint64_t addr, int thread_id,
+                         int op_width) {
+  if (cache_ != NULL) {
+    CacheMiss misses[kMaxCacheMisses];
+    int num_misses = cache_->Access(op, addr, thread_id, op_width, misses);
+    for (int i = 0; i < num_misses; i++) {
+      Put(cache_n_++, misses[i].op, misses[i].addr, misses[i].thread_id,
+          misses[i].op_width);
+    }
+    return;
+  }
+  Put(n, op, addr, thread_id, op_width);
+}
+
+void TraceWriter::Put(int64_t n, char op, uint64_t addr, int thread_id,
+                      int op_width) {
+  assert(n >= 0);
+  if (IsWide(n, addr)) wide_ = true;
+  if (counting_) {
+    Count(n, op, thread_id, op_width);
+  } else if (status_ == kSuccess
+             && (used_ + kMaxAppendSize <= (size_t)kTraceBufferSize
+                 || Flush() == kSuccess)) {
+    // Nothing is formatted after a failed write
+    char* p = buffer_ + used_;
+    if (format_ == kTraceBinary) {
+      if (n != next_n_) {
+        p = EncodeRecord(p, kBinaryOpSetIndex, n, 0, 0, addr_width_);
+      }
+      p = EncodeRecord(p, (uint8_t)op, addr, thread_id, op_width,
+                       addr_width_);
+      next_n_ = n + 1;
+    } else {
+      p = FormatAccess(p, n, op, addr, thread_id, op_width, addr_width_);
+    }
+    used_ = p - buffer_;
+  }
+  int64_t issue = clock_ != NULL ? ClockAccess(n, thread_id) : 0;
+  if (timer_ != NULL) timer_->Access(op, addr, issue);
+}
+
+int64_t TraceWriter::ClockAccess(int64_t n, int thread_id) {
+  int64_t issue = clock_->Issue(thread_id);
+  if (cycles_fp_ == NULL) return issue;
+  char line[48];
+  char* p = FormatDecimal(line, n);
+  *p++ = ' ';
+  p = FormatDecimal(p, issue);
+  *p++ = '\n';
+  fwrite(line, 1, p - line, cycles_fp_);
+  return issue;
+}
+
+void TraceWriter::Compute(int64_t cycles, bool wait, int thread_id) {
+  if (clock_ != NULL) {
+    clock_->Compute(thread_id, cycles, wait);
+  } else if (keep_compute_ && status_ == kSuccess) {
+    if (used_ + kMaxAppendSize > (size_t)kTraceBufferSize
+        && Flush() != kSuccess) {
+      return;
+    }
+    char* p = EncodeRecord(buffer_ + used_, kBinaryOpCompute, cycles,
+                           thread_id, 0, kAddr64);
+    p[-1] = wait;
+    used_ = p - buffer_;
+  }
+}
+
+void TraceWriter::Print(const char* line) {
+  Write(line, strlen(line));
+}
+
+// Address and the fields behind it of a record of width
+static inline uint64_t LoadRecordAddr(const uint8_t* record, AddrWidth width) {
+  int addr_size = width == kAddr64 ? 8 : 4;
+  uint64_t addr = 0;
+  for (int i = addr_size - 1; i >= 0; i--) addr = (addr << 8) | record[i];
+  return addr;
+}
+
+static const AddrWidth kRecordWidth = kAddr64;
+static const int kRecordOp = 8;  // offset of Op in the records
+
+void AppendBinaryRecords(const char* data, size_t size, int64_t base,
+                         TraceWriter* out) {
+  const uint8_t* record = (const uint8_t*)data;
+  const uint8_t* end = record + size;
+  int64_t n = base;
+  for (; record + kBinaryTraceRecordSize64 <= end;
+       record += kBinaryTraceRecordSize64) {
+    uint64_t addr = LoadRecordAddr(record, kRecordWidth);
+    const uint8_t* fields = record + kRecordOp;
+    if (fields[0] == kBinaryOpSetIndex) {
+      n = base + (int64_t)addr;
+      continue;
+    }
+    if (fields[0] == kBinaryOpCompute) {
+      out->Compute((int64_t)addr, fields[3] & 1, fields[1]);
+      continue;
+    }
+    out->Append(n++, (char)fields[0], addr, fields[1], fields[2]);
+  }
+}
+
+void TraceWriter::ClockRecords(const char* data, size_t size, int64_t base) {
+  if (clock_ == NULL) return;
+  const uint8_t* record = (const uint8_t*)data;
+  const uint8_t* end = record + size;
+  int64_t n = base;
+  for (; record + kBinaryTraceRecordSize64 <= end;
+       record += kBinaryTraceRecordSize64) {
+    uint64_t addr = LoadRecordAddr(record, kRecordWidth);
+    const uint8_t* fields = record + kRecordOp;
+    if (fields[0] == kBinaryOpSetIndex) {
+      n = base + (int64_t)addr;
+    } else if (fields[0] == kBinaryOpCompute) {
+      clock_->Compute(fields[1], (int64_t)addr, fields[3] & 1);
+    } else {
+      ClockAccess(n++, fields[1]);
+    }
+  }
+}
+
+const char* ReadBinaryAccess(const char* data, const char* end, char* op,
+                             uint64_t* addr, int* op_width,
+                             TraceWriter* compute_out, int thread_id) {
+  for (; data + kBinaryTraceRecordSize64 <= end;
+       data += kBinaryTraceRecordSize64) {
+    const uint8_t* fields = (const uint8_t*)data + kRecordOp;
+    if (fields[0] == kBinaryOpSetIndex) continue;
+    if (fields[0] == kBinaryOpCompute) {
+      if (compute_out != NULL) {
+        compute_out->Compute((int64_t)LoadRecordAddr((const uint8_t*)data,
+                                                     kRecordWidth),
+                             fields[3] & 1, thread_id);
+      }
+      continue;
+    }
+    *op = (char)fields[0];
+    *addr = LoadRecordAddr((const uint8_t*)data, kRecordWidth);
+    *op_width = fields[2];
+    return data + kBinaryTraceRecordSize64;
+  }
+  return NULL;
+}
+
+size_t FormatRecordsSize(const char* data, size_t size, int64_t base,
+                         int64_t next_n, TraceFormat format,
+                         AddrWidth width) {
+  const uint8_t* record = (const uint8_t*)data;
+  const uint8_t* end = record + size;
+  size_t record_size = width == kAddr64 ? kBinaryTraceRecordSize64
+                                        : kBinaryTraceRecordSize;
+  size_t out_size = 0;
+  int64_t n = base;
+  for (; record + kBinaryTraceRecordSize64 <= end;
+       record += kBinaryTraceRecordSize64) {
+    const uint8_t* fields = record + kRecordOp;
+    if (fields[0] == kBinaryOpSetIndex) {
+      n = base + (int64_t)LoadRecordAddr(record, kRecordWidth);
+      continue;
+    }
+    if (fields[0] == kBinaryOpCompute) continue;
+    if (format == kTraceBinary) {
+      out_size += (n != next_n ? 2 : 1) * record_size;
+      next_n = n + 1;
+    } else {
+      out_size += AccessSize(n, fields[1], fields[2], width);
+    }
+    ++n;
+  }
+  return out_size;
+}
+
+char* FormatRecords(const char* data, size_t size, int64_t base,
+                    int64_t* next_n, TraceFormat format, AddrWidth width,
+                    char* out) {
+  const uint8_t* record = (const uint8_t*)data;
+  const uint8_t* end = record + size;
+  int64_t n = base;
+  for (; record + kBinaryTraceRecordSize64 <= end;
+       record += kBinaryTraceRecordSize64) {
+    uint64_t addr = LoadRecordAddr(record, kRecordWidth);
+    const uint8_t* fields = record + kRecordOp;
+    if (fields[0] == kBinaryOpSetIndex) {
+      n = base + (int64_t)addr;
+      continue;
+    }
+    if (fields[0] == kBinaryOpCompute) continue;
+    if (format == kTraceBinary) {
+      if (n != *next_n) {
+        out = EncodeRecord(out, kBinaryOpSetIndex, n, 0, 0, width);
+      }
+      out = EncodeRecord(out, fields[0], addr, fields[1], fields[2], width);
+      *next_n = n + 1;
+    } else {
+      out = FormatAccess(out, n, (char)fields[0], addr, fields[1], fields[2],
+                         width);
+    }
+    ++n;
+  }
+  return out;
+}
+
+static bool g_dry_run = false;
+static std::mutex g_dry_run_mutex;
+static TraceStats g_dry_run_totals;
+static int g_dry_run_traces = 0;
+
+void SetDryRun(bool dry_run) {
+  g_dry_run = dry_run;
+}
+
+bool GetDryRun() {
+  return g_dry_run;
+}
+
+static void PrintTraceStats(const char* name, const TraceStats& stats) {
+  printf("%-44s %10llu accesses (R %llu, W %llu, r %llu, w %llu), "
+         "%llu lines, %llu bytes (%.1f MB)\n", name,
+         (unsigned long long)stats.num_accesses,
+         (unsigned long long)stats.num_row_reads,
+         (unsigned long long)stats.num_row_writes,
+         (unsigned long long)stats.num_col_reads,
+         (unsigned long long)stats.num_col_writes,
+         (unsigned long long)stats.num_lines,
+         (unsigned long long)stats.num_bytes, stats.num_bytes / 1048576.0);
+}
+
+void PrintDryRunTotals() {
+  std::lock_guard<std::mutex> lock(g_dry_run_mutex);
+  char name[64];
+  snprintf(name, sizeof(name), "Total of %d traces", g_dry_run_traces);
+  PrintTraceStats(name, g_dry_run_totals);
+}
+
+static bool g_mapped_output = false;
+
+void SetMappedOutput(bool mapped) {
+  g_mapped_output = mapped;
+}
+
+bool GetMappedOutput() {
+  return g_mapped_output;
+}
+
+std::string TraceFileName(const char* trace_file_name) {
+  return std::string(trace_file_name)
+         + (GetTraceFormat() == kTraceBinary ? ".bin" : "")
+         + (GetCompressThreads() > 0 ? kCompressedTraceSuffix : "");
+}
+
+TraceWriter* OpenTraceWriter(const char* trace_file_name) {
+  TraceFormat format = GetTraceFormat();
+  int compress_threads = GetCompressThreads();
+  char file_name[1024];
+  snprintf(file_name, sizeof(file_name), "%s",
+           TraceFileName(trace_file_name).c_str());
+
+  TraceWriter* writer = new TraceWriter();
+  const CacheConfig* cache = GetCacheConfig();
+  const CpuModel* model = GetCpuModel();
+  const TimingModel* timing = GetTimingModel();
+  if (GetDryRun()) {
+    writer->OpenCounting(file_name, format);
+    if (cache != NULL) writer->OpenCache(*cache);
+    // The timing model still gets the issue cycles, without a file
+    if (timing != NULL) {
+      if (model != NULL) writer->OpenCycles(NULL, *model);
+      writer->OpenTiming(*timing);
+    }
+    return writer;
+  }
+  // Compressed output goes through the block compressor and is never mapped
+  int ret = GetMappedOutput() && compress_threads == 0
+      ? writer->OpenMapped(file_name, format)
+      : writer->Open(file_name, format, compress_threads);
+  if (ret != kSuccess) {
+    delete writer;
+    return NULL;
+  }
+  if (cache != NULL && writer->OpenCache(*cache) != kSuccess) {
+    CloseTraceWriter(writer);
+    return NULL;
+  }
+  if (timing != NULL) writer->OpenTiming(*timing);
+  if (model != NULL) {
+    snprintf(file_name, sizeof(file_name), "%s%s", trace_file_name,
+             kCyclesSuffix);
+    if (writer->OpenCycles(file_name, *model) != kSuccess) {
+      CloseTraceWriter(writer);
+      return NULL;
+    }
+  }
+  return writer;
+}
+
+int CloseTraceWriter(TraceWriter* writer) {
+  if (writer == NULL) return kSuccess;
+  if (writer->filtered()) {
+    writer->DrainCache();
+    const CacheStats& stats = writer->cache()->stats();
+    printf("%s: %llu accesses, %llu fills and %llu write-backs through the "
+           "caches\n", writer->name().c_str(),
+           (unsigned long long)stats.num_accesses,
+           (unsigned long long)stats.num_fills,
+           (unsigned long long)stats.num_writebacks);
+  }
+  if (writer->timed()) {
+    writer->timer()->Finish();
+    fputs(writer->timer()->Report(writer->name().c_str()).c_str(), stdout);
+  }
+  if (writer->counting()) {
+    const TraceStats& stats = writer->stats();
+    std::lock_guard<std::mutex> lock(g_dry_run_mutex);
+    PrintTraceStats(writer->name().c_str(), stats);
+    g_dry_run_totals.num_accesses += stats.num_accesses;
+    g_dry_run_totals.num_row_reads += stats.num_row_reads;
+    g_dry_run_totals.num_row_writes += stats.num_row_writes;
+    g_dry_run_totals.num_col_reads += stats.num_col_reads;
+    g_dry_run_totals.num_col_writes += stats.num_col_writes;
+    g_dry_run_totals.num_lines += stats.num_lines;
+    g_dry_run_totals.num_bytes += stats.num_bytes;
+    ++g_dry_run_traces;
+  }
+  int ret = writer->Close();
+  if (ret != kSuccess) {
+    fprintf(stderr, "Failed to write %s\n", writer->name().c_str());
+  }
+  delete writer;
+  return ret;
+}
+
+int ConvertBinaryTrace(const char* binary_file_name,
+                       const char* text_file_name) {
+  FILE* in = fopen(binary_file_name, "rb");
+  if (in == NULL) return kFailure;
+
+  uint8_t header[kBinaryTraceHeaderSize];
+  if (fread(header, sizeof(header), 1, in) != 1
+      || memcmp(header, kBinaryTraceMagic, sizeof(kBinaryTraceMagic)) != 0) {
+    fprintf(stderr, "%s is not a binary trace\n", binary_file_name);
+    fclose(in);
+    return kFailure;
+  }
+  int version = header[4] | (header[5] << 8);
+  int record_size = header[6] | (header[7] << 8);
+  AddrWidth width = version == kBinaryTraceVersion64 ? kAddr64 : kAddr32;
+  if (!(version == kBinaryTraceVersion
+        && record_size == kBinaryTraceRecordSize)
+      && !(version == kBinaryTraceVersion64
+           && record_size == kBinaryTraceRecordSize64)) {
+    fprintf(stderr, "Unsupported binary trace version %d (record size %d)\n",
+            version, record_size);
+    fclose(in);
+    return kFailure;
+  }
+
+  TraceWriter out;
+  out.set_addr_width(width);
+  if (out.Open(text_file_name, kTraceText) != kSuccess) {
+    fclose(in);
+    return kFailure;
+  }
+
+  int64_t n = 0;
+  int64_t num_traces = 0;
+  uint8_t record[kBinaryTraceRecordSize64];
+  while (fread(record, record_size, 1, in) == 1) {
+    uint64_t addr = LoadRecordAddr(record, width);
+    const uint8_t* fields = record + record_size - 4;
+    if (fields[0] == kBinaryOpSetIndex) {
+      n = (int64_t)addr;
+      continue;
+    }
+    out.Append(n++, (char)fields[0], addr, fields[1], fields[2]);
+    ++num_traces;
+  }
+  printf("Converted %lld cache line accesses from %s to %s\n",
+         (long long)num_traces, binary_file_name, text_file_name);
+  fclose(in);
+  return out.Close();
+}
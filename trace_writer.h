@@ -0,0 +1,275 @@
+/*
+ * trace_writer.h
+ *
+ * Output side of the trace generators. Every generator hands its cache line
+ * accesses to a TraceWriter, which encodes them either as NVMain text or as
+ * compact binary records.
+ */
+
+#ifndef TRACE_WRITER_H_
+#define TRACE_WRITER_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+class BlockCompressor;
+class CacheHierarchy;
+class CycleClock;
+class MemoryTimer;
+struct CacheConfig;
+struct CpuModel;
+struct TimingModel;
+
+enum TraceFormat {
+  kTraceText = 0,    // NVMain text: "Index Op Addr ThreadID Op_Width"
+  kTraceBinary = 1,  // Binary records, see below
+};
+
+// Width of the addresses a trace is written with. 32-bit traces are what
+// older simulator builds read; an address or SetIndex counter above 32 bits is
+// truncated in them, which the writer warns about on Close.
+enum AddrWidth {
+  kAddr32 = 0,  // text "0x%08x", binary version 1
+  kAddr64 = 1,  // text "0x%016llx", binary version 2
+};
+
+// Binary trace file, version 1 with 32-bit and version 2 with 64-bit
+// addresses. All fields are little endian.
+//
+// File header (16 bytes):
+// +----------+------------+---------------+-------------+
+// | Magic(4) | Version(2) | RecordSize(2) | Reserved(8) |
+// +----------+------------+---------------+-------------+
+//
+// Record (8 bytes in version 1, 12 in version 2), one per cache line access:
+// +-----------+-------+-------------+-------------+----------+
+// | Addr(4/8) | Op(1) | ThreadID(1) | Op_Width(1) | Flags(1) |
+// +-----------+-------+-------------+-------------+----------+
+//
+// Op is the NVMain op character ('R', 'W', 'r' or 'w'). The index is
+// implicit: the k-th access expands to the 8 NVMain lines k*8 .. k*8+7 with
+// addresses Addr, Addr+8, ..., Addr+56, exactly as cprintf prints them. A
+// generator whose access counter jumps is recorded with an extra record of
+// Op kBinaryOpSetIndex whose Addr field holds the new counter value.
+const char kBinaryTraceMagic[4] = {'R', 'C', 'T', 'B'};
+const int kBinaryTraceVersion = 1;
+const int kBinaryTraceVersion64 = 2;
+const int kBinaryTraceHeaderSize = 16;
+const int kBinaryTraceRecordSize = 8;
+const int kBinaryTraceRecordSize64 = 12;
+const uint8_t kBinaryOpSetIndex = 0;
+// Work of the core before the next access, in the records of memory writers
+// that keep it (see set_keep_compute) and never in trace files: Addr holds
+// the cycles, ThreadID the thread, and bit 0 of Flags whether the work waits
+// for the data of the last access, see CycleClock::Compute.
+const uint8_t kBinaryOpCompute = 1;
+
+// Number of NVMain lines (8-byte cells) emitted for one cache line access
+const int kLinesPerAccess = 8;
+
+// Output is formatted into an owned buffer and flushed in blocks of this size
+const int kTraceBufferSize = 4 << 20;
+// Upper bound of the bytes a single Append adds to the buffer
+const int kMaxAppendSize = 512;
+
+// What a trace consists of, as counted by a dry run
+struct TraceStats {
+  uint64_t num_accesses;    // cache line accesses
+  uint64_t num_row_reads;   // 'R'
+  uint64_t num_row_writes;  // 'W'
+  uint64_t num_col_reads;   // 'r'
+  uint64_t num_col_writes;  // 'w'
+  uint64_t num_lines;       // NVMain lines
+  uint64_t num_bytes;       // size of the trace file
+};
+
+class TraceWriter {
+ public:
+  TraceWriter();
+  ~TraceWriter();
+
+  // With compress_threads > 0 the file is block-compressed on that many
+  // worker threads, see trace_compress.h
+  int Open(const char* trace_file_name, TraceFormat format,
+           int compress_threads = 0);
+  // Opens a writer that formats straight into a shared mapping of the file,
+  // which grows ahead of the output and is cut to size on Close
+  int OpenMapped(const char* trace_file_name, TraceFormat format);
+  // Opens a writer that only counts what it would write to trace_file_name,
+  // without formatting or I/O
+  int OpenCounting(const char* trace_file_name, TraceFormat format);
+  // Opens a writer that keeps its output in memory, without a file header
+  int OpenMemory(TraceFormat format);
+  // Writes the issue cycle of every access from now on to cycles_file_name,
+  // as model has them; see cpu_model.h. Without a file name the cycles only
+  // go to the timing model.
+  int OpenCycles(const char* cycles_file_name, const CpuModel& model);
+  // Runs every access from now on through the caches of config, see
+  // cache_filter.h. Only their misses and write-backs reach the output,
+  // numbered on from 0 whatever the access counters of Append are.
+  int OpenCache(const CacheConfig& config);
+  // Appends the write-backs of the dirty lines the caches hold; Close does
+  // too
+  void DrainCache();
+  // Times every access that reaches the output from now on with model, see
+  // memory_timing.h
+  int OpenTiming(const TimingModel& model);
+  int Close();
+
+  // Moves the output of a memory writer into *out
+  void TakeMemory(std::vector<char>* out);
+
+  // Appends one cache line access with access counter n. In text format this
+  // prints the kLinesPerAccess NVMain lines of the cache line.
+  void Append(int64_t n, char op, uint64_t addr, int thread_id, int op_width);
+
+  // Work of the core of thread before its next access, for the issue cycles.
+  // Writers without cycles drop it, unless they keep it in their records.
+  void Compute(int64_t cycles, bool wait, int thread_id);
+
+  // Writes the issue cycles of kAddr64 binary records, whose access counters
+  // are offset by base, as AppendBinaryRecords would have them. For records
+  // that are formatted elsewhere and added with Write or Reserve.
+  void ClockRecords(const char* data, size_t size, int64_t base);
+
+  // Appends a preformatted text line; used by the DEBUG annotated output.
+  void Print(const char* line);
+
+  // Appends bytes that are already encoded in this writer's format
+  int Write(const char* data, size_t size);
+
+  // Mapped writers only: returns a slot of size bytes at the current end of
+  // the output for the caller to fill in. The slot stays valid until the
+  // next Append, Write or Reserve. Returns NULL, and fails the writer, if
+  // the file cannot grow.
+  char* Reserve(size_t size);
+
+  TraceFormat format() const { return format_; }
+  // Width of the output, GetAddrWidth() unless set before opening
+  AddrWidth addr_width() const { return addr_width_; }
+  void set_addr_width(AddrWidth width) { addr_width_ = width; }
+  // Whether an access so far needs 64-bit output
+  bool wide() const { return wide_; }
+  void set_wide() { wide_ = true; }
+  // Fails the writer for output lost before it got there, as a failed write
+  // does
+  void Fail();
+  bool mapped() const { return map_ != NULL; }
+  bool counting() const { return counting_; }
+  // Whether the writer writes issue cycles
+  bool clocked() const { return clock_ != NULL; }
+  // Whether the accesses go through caches, which need them in order
+  bool filtered() const { return cache_ != NULL; }
+  const CacheHierarchy* cache() const { return cache_; }
+  // Whether the accesses are timed, which needs them in order too
+  bool timed() const { return timer_ != NULL; }
+  MemoryTimer* timer() { return timer_; }
+  // Memory writers only: whether Compute goes into the records
+  void set_keep_compute(bool keep) { keep_compute_ = keep; }
+  const std::string& name() const { return name_; }
+  const TraceStats& stats() const { return stats_; }
+  // Access counter the next binary record is expected to carry
+  int64_t next_n() const { return next_n_; }
+  void set_next_n(int64_t n) { next_n_ = n; }
+
+ private:
+  void PutFileHeader();
+  void Count(int64_t n, char op, int thread_id, int op_width);
+  void Put(int64_t n, char op, uint64_t addr, int thread_id, int op_width);
+  int64_t ClockAccess(int64_t n, int thread_id);
+  int RecordSize() const;
+  int Flush();
+
+  int AllocBuffer();
+
+  FILE* fp_;
+  BlockCompressor* compressor_;
+  CycleClock* clock_;
+  CacheHierarchy* cache_;
+  int64_t cache_n_;  // access counter of the output of cache_
+  MemoryTimer* timer_;
+  FILE* cycles_fp_;
+  bool keep_compute_;
+  bool in_memory_;
+  std::vector<char> memory_;
+  int fd_;
+  char* map_;
+  size_t map_size_;
+  size_t offset_;  // mapped bytes before buffer_
+  bool counting_;
+  std::string name_;
+  TraceStats stats_;
+  TraceFormat format_;
+  AddrWidth addr_width_;
+  bool wide_;
+  int64_t next_n_;
+  char* buffer_;
+  size_t used_;
+  int status_;  // kFailure after a failed write, returned by Close
+};
+
+// Format used by OpenTraceWriter, selected once from main
+void SetTraceFormat(TraceFormat format);
+TraceFormat GetTraceFormat();
+
+// Address width of the writers, selected once from main; kAddr32 by default
+void SetAddrWidth(AddrWidth width);
+AddrWidth GetAddrWidth();
+
+// Whether OpenTraceWriter opens counting writers instead of files, selected
+// once from main. CloseTraceWriter then reports the counts of every trace.
+void SetDryRun(bool dry_run);
+bool GetDryRun();
+// Prints the counts summed over all traces of the dry run
+void PrintDryRunTotals();
+
+// Whether OpenTraceWriter maps the files it opens, selected once from main
+void SetMappedOutput(bool mapped);
+bool GetMappedOutput();
+
+// Opens trace_file_name in the selected format. Binary traces get a ".bin"
+// suffix so they are never mistaken for NVMain text, and compressed traces an
+// additional ".rcz" suffix. Returns NULL on failure.
+TraceWriter* OpenTraceWriter(const char* trace_file_name);
+// Name of the file OpenTraceWriter writes trace_file_name to
+std::string TraceFileName(const char* trace_file_name);
+// Closes and deletes writer; returns kFailure if any of its output could not
+// be written
+int CloseTraceWriter(TraceWriter* writer);
+
+// The functions below take the records of a kAddr64 memory writer, which
+// loses nothing whatever the width of the output is.
+
+// Appends binary records (without file header) to out, offsetting their
+// access counters by base
+void AppendBinaryRecords(const char* data, size_t size, int64_t base,
+                         TraceWriter* out);
+
+// Reads the access of the first record in [data, end) that is not a counter
+// or compute record into *op, *addr and *op_width; the compute records before
+// it go to compute_out as the work of thread_id unless it is NULL. Returns
+// the record after it, or NULL when there is none.
+const char* ReadBinaryAccess(const char* data, const char* end, char* op,
+                             uint64_t* addr, int* op_width,
+                             TraceWriter* compute_out, int thread_id);
+
+// Exact number of bytes FormatRecords writes for the same arguments
+size_t FormatRecordsSize(const char* data, size_t size, int64_t base,
+                         int64_t next_n, TraceFormat format, AddrWidth width);
+
+// Encodes binary records (without file header) in format and width at out,
+// offsetting their access counters by base; *next_n is the counter the output
+// expects and is advanced past the last record. Returns the end of the
+// output.
+char* FormatRecords(const char* data, size_t size, int64_t base,
+                    int64_t* next_n, TraceFormat format, AddrWidth width,
+                    char* out);
+
+// Expands a binary trace back into the NVMain text format, with the address
+// width of its version
+int ConvertBinaryTrace(const char* binary_file_name,
+                       const char* text_file_name);
+
+#endif /* TRACE_WRITER_H_ */
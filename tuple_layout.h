@@ -0,0 +1,194 @@
+/*
+ * tuple_layout.h
+ *
+ * Layout policies: where cell `cell` (kCellSize bytes) of tuple t of a table
+ * lives. Every policy has the same interface, so that the query plan engine
+ * and the generators are templates over it and the address computation
+ * inlines into their loops:
+ *
+ *   Policy(const TableLayout& layout, uint64_t base_col_addr,
+ *          BankInterleave interleave, int tuple_size, int64_t num_tuples);
+ *   uint64_t CellAddr(int64_t t, int cell) const;  // column address
+ *   static const int kScanStep;  // tuples from one column line to the next
+ *
+ * A column scan reads the column cache line of every kScanStep-th tuple. A
+ * policy that does not stack consecutive tuples down columns has kScanStep
+ * 1, and the scan reads a line when it meets the tuple at the top of it.
+ *
+ * The tables start at base_col_addr, and their stripes are spread over the
+ * banks and channels by interleave as in CalTupleRowAddr/CalTupleColAddr.
+ */
+
+#ifndef TUPLE_LAYOUT_H_
+#define TUPLE_LAYOUT_H_
+
+#include <stdint.h>
+#include "gen_trace.h"
+#include "addr_util.h"
+
+inline int TupleCells(int tuple_size) {
+  return (tuple_size - 1) / kCellSize + 1;
+}
+
+// Cells of the Column field, a row of a row stripe or of the column stripes
+inline int RowStripeCells() {
+  return 1 << g_addr_codec.geometry.column_bit;
+}
+
+// Cells of a tuple that share a row cache line: a PAX tuple has its cells
+// in separate minipages
+inline int RowLineCells(const TableLayout& layout) {
+  return layout.kind == kLayoutPax ? 1 : kCachelineSize / kCellSize;
+}
+
+// Whether tuples of tuple_size bytes fit layout on the current device
+inline bool LayoutFits(const TableLayout& layout, int tuple_size) {
+  int tuple_cells = TupleCells(tuple_size);
+  switch (layout.kind) {
+    case kLayoutRowFirst:
+    case kLayoutColumnFirst:
+      return true;
+    case kLayoutPax:
+      return tuple_cells <= RowStripeCells();
+    case kLayoutColumnGroup:
+      return layout.param > 0 && layout.param <= RowStripeCells();
+    case kLayoutHybridTile:
+      return layout.param > 0
+          && (int64_t)layout.param * tuple_cells <= RowStripeCells();
+  }
+  return false;
+}
+
+// Layout 1: tuples one after another along the rows
+struct RowFirstLayout {
+  static const int kScanStep = 1;
+
+  RowFirstLayout(const TableLayout& layout, uint64_t base_col_addr,
+                 BankInterleave interleave, int tuple_size, int64_t num_tuples)
+      : base_row_addr(ColAddr2RowAddr(base_col_addr)), interleave(interleave),
+        tuple_size(tuple_size) {}
+
+  uint64_t CellAddr(int64_t t, int cell) const {
+    return RowAddr2ColAddr(CalTupleRowAddr(t, tuple_size, base_row_addr,
+                                           interleave)
+                           + (uint64_t)cell * kCellSize);
+  }
+
+  uint64_t base_row_addr;
+  BankInterleave interleave;
+  int tuple_size;
+};
+
+// Layout 2: tuples stacked down stripes of a tuple's width, a column buffer
+// of tuples each
+struct ColumnFirstLayout {
+  static const int kScanStep = kCachelineSize / kCellSize;
+
+  ColumnFirstLayout(const TableLayout& layout, uint64_t base_col_addr,
+                    BankInterleave interleave, int tuple_size,
+                    int64_t num_tuples)
+      : base_col_addr(base_col_addr), interleave(interleave),
+        tuple_size(tuple_size) {}
+
+  uint64_t CellAddr(int64_t t, int cell) const {
+    return CalTupleColAddr(t, tuple_size, base_col_addr, interleave)
+        + ((uint64_t)cell << g_addr_codec.col_shift[kFieldColumn]);
+  }
+
+  uint64_t base_col_addr;
+  BankInterleave interleave;
+  int tuple_size;
+};
+
+// PAX: a row stripe is a page of as many tuples as fit, split into one
+// minipage per cell that holds the cell of every tuple of the page
+//
+//+=========+=========+=====+=========+=========+=====+
+//| t1.c1   | t2.c1   | ... | t1.c2   | t2.c2   | ... |
+//+---------+---------+-----+---------+---------+-----+
+struct PaxLayout {
+  static const int kScanStep = 1;
+
+  PaxLayout(const TableLayout& layout, uint64_t base_col_addr,
+            BankInterleave interleave, int tuple_size, int64_t num_tuples)
+      : base_row_addr(ColAddr2RowAddr(base_col_addr)), interleave(interleave),
+        page_tuples(RowStripeCells() / TupleCells(tuple_size)) {
+    assert(page_tuples > 0);
+  }
+
+  uint64_t CellAddr(int64_t t, int cell) const {
+    int64_t page = t / page_tuples;
+    uint64_t slot = (uint64_t)(t % page_tuples);
+    uint64_t offset = ((uint64_t)cell * page_tuples + slot) * kCellSize;
+    return RowAddr2ColAddr(RowStripeAddr(base_row_addr, page, offset,
+                                         interleave));
+  }
+
+  uint64_t base_row_addr;
+  BankInterleave interleave;
+  int64_t page_tuples;
+};
+
+// Column-group tiles: the cells of a tuple are cut into groups of
+// layout.param cells, and every group is a column-first table of its own,
+// one after the other
+struct ColumnGroupLayout {
+  static const int kScanStep = kCachelineSize / kCellSize;
+
+  ColumnGroupLayout(const TableLayout& layout, uint64_t base_col_addr,
+                    BankInterleave interleave, int tuple_size,
+                    int64_t num_tuples)
+      : base_col_addr(base_col_addr), interleave(interleave),
+        group_cells(layout.param),
+        group_stripes((num_tuples - 1)
+                      / g_addr_codec.geometry.column_buffer_size + 1) {}
+
+  uint64_t CellAddr(int64_t t, int cell) const {
+    int64_t column_buffer_size = g_addr_codec.geometry.column_buffer_size;
+    int group = cell / group_cells;
+    return ColStripeAddr(base_col_addr,
+                         group * group_stripes + t / column_buffer_size,
+                         group_cells, t % column_buffer_size,
+                         cell % group_cells, interleave);
+  }
+
+  uint64_t base_col_addr;
+  BankInterleave interleave;
+  int group_cells;
+  int64_t group_stripes;  // of a group
+};
+
+// Row/column hybrid tiles: a stripe holds layout.param tuples side by side
+// in each of its rows, and a column buffer of such rows
+//
+//+=========+=========+=========+=========+
+//| Tuple 1 | Tuple 2 | Tuple 3 | Tuple 4 |
+//+---------+---------+---------+---------+
+//| Tuple 5 | Tuple 6 | Tuple 7 | Tuple 8 |
+//+---------+---------+---------+---------+
+struct HybridTileLayout {
+  static const int kScanStep = 1;
+
+  HybridTileLayout(const TableLayout& layout, uint64_t base_col_addr,
+                   BankInterleave interleave, int tuple_size,
+                   int64_t num_tuples)
+      : base_col_addr(base_col_addr), interleave(interleave),
+        tile_tuples(layout.param), tuple_cells(TupleCells(tuple_size)) {}
+
+  uint64_t CellAddr(int64_t t, int cell) const {
+    int64_t stripe_tuples = tile_tuples
+        * (int64_t)g_addr_codec.geometry.column_buffer_size;
+    int64_t n = t % stripe_tuples;
+    return ColStripeAddr(base_col_addr, t / stripe_tuples,
+                         (uint64_t)tile_tuples * tuple_cells, n / tile_tuples,
+                         (uint64_t)(n % tile_tuples) * tuple_cells + cell,
+                         interleave);
+  }
+
+  uint64_t base_col_addr;
+  BankInterleave interleave;
+  int64_t tile_tuples;
+  int tuple_cells;
+};
+
+#endif /* TUPLE_LAYOUT_H_ */